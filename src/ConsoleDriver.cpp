@@ -1,6 +1,7 @@
 #include <cstdio>
 #include <chrono>
 #include <cmath>
+#include <cstdlib>
 #include <assert.h>
 #include "ConsoleDriver.h"
 #include "controller/PretimedController.h"
@@ -11,39 +12,40 @@ using namespace std;
 /**
  * Initializes a new ConsoleDriver.
  * @param iterationsPerSecond the number of iterations to be executed in the simulator per second
- * @param file the file to load the city
+ * @param file the file (text or binary) to load the city
  * @param controllerType 0 if PretimedController, 1 for BasicController
  */
 ConsoleDriver::ConsoleDriver(double iterationsPerSecond, string file, int controllerType) {
     assert(iterationsPerSecond > 0.0 && "iterationsPerSecond must be a positive value");
     this->iterationsPerSecond = iterationsPerSecond;
     iterationLength = 1.0 / iterationsPerSecond;
-    freopen(file.c_str(), "r", stdin);
     G = new WeightedDigraph();
     if (controllerType == 0) controller = new PretimedController(G);
     else if (controllerType == 1) controller = new BasicController(G);
     sim = new Simulation(controller);
     int cntIntersections;
-    int cntRoadSegments;
     int cntCars;
-    scanf("%d %d %d %d", &cntIntersections, &cntRoadSegments, &cntCars, &carsPerSecond);
-    Intersection *intersections[cntIntersections];
-    for (int i = 0; i < cntIntersections; i++) {
-        double x;
-        double y;
-        scanf("%lf %lf", &x, &y);
-        intersections[i] = new Intersection(x, y);
-    }
-    for (int i = 0; i < cntRoadSegments; i++) {
-        int A;
-        int B;
-        double speedLimit;
-        int capacity;
-        scanf("%d %d %lf %d", &A, &B, &speedLimit, &capacity);
-        assert(G->addRoadSegment(new RoadSegment(intersections[A], intersections[B], speedLimit, capacity)));
-    }
-    for (int i = 0; i < cntIntersections; i++) {
-        intersections[i]->autoConnectAndLink();
+    vector<Intersection*> intersections;
+    if (CityFile::isCityFile(file)) { // the traffic lights were saved after they were connected and linked
+        CityFile city;
+        if (!city.open(file)) {
+            fprintf(stderr, "%s: %s\n", file.c_str(), city.getError().c_str());
+            exit(1);
+        }
+        city.load(G, intersections);
+        cntIntersections = city.countIntersections();
+        cntCars = city.countCars();
+        carsPerSecond = city.getCarsPerSecond();
+    } else {
+        string error;
+        if (!CityFile::readText(file, G, intersections, cntCars, carsPerSecond, error)) {
+            fprintf(stderr, "%s: %s\n", file.c_str(), error.c_str());
+            exit(1);
+        }
+        cntIntersections = intersections.size();
+        for (int i = 0; i < cntIntersections; i++) {
+            intersections[i]->autoConnectAndLink();
+        }
     }
     for (int i = 0; i < cntCars; i++) {
         Car *c = getRandomCar(G, 0.0);
@@ -79,10 +81,10 @@ void ConsoleDriver::run() {
         sim->nextIteration(iterationLength);
         chrono::duration<double> timeSinceLastCar = end - lastCarSpawn;
         if (timeSinceLastCar.count() >= 1.0 / ((double) carsPerSecond)) {
-            for (int i = 0; i < (int) floor(timeSinceLastCar.count() * ((double) carsPerSecond)); i++) {
-                Car *c = getRandomCar(G, sim->getCurrentTime());
-                c->setSpeed(c->getCurrentRoad()->getSpeedLimit());
-            }
+            wave.draw(G, (int) floor(timeSinceLastCar.count() * ((double) carsPerSecond)));
+            wave.route(G, sim->getThreadPool());
+            wave.insert(sim->getCurrentTime(), spawned);
+            for (Car *c : spawned) c->setSpeed(c->getCurrentRoad()->getSpeedLimit());
             lastCarSpawn = end;
         }
         clearConsole();
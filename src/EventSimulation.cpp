@@ -0,0 +1,260 @@
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <assert.h>
+#include "EventSimulation.h"
+
+using namespace std;
+
+/**
+ * Compares this event to event e by time, and then by the order they were scheduled in.
+ */
+bool Event::operator > (const Event &e) const {
+    return time > e.time || (time == e.time && sequence > e.sequence);
+}
+
+/**
+ * Initializes a new EventSimulation given a controller.
+ * @param controller the controller that will handle the traffic
+ * @param carsPerSecond the number of random cars spawned per second (0 to not spawn any cars)
+ */
+EventSimulation::EventSimulation(Controller *controller, double carsPerSecond) {
+    assert(carsPerSecond >= 0.0 && "carsPerSecond must be a non-negative value");
+    this->controller = controller;
+    this->carsPerSecond = carsPerSecond;
+    G = controller->getGraph();
+    currentTime = 0.0;
+    sequence = 0;
+    processed = 0;
+    controllerTime = numeric_limits<double>::infinity();
+    if (carsPerSecond > 0.0) schedule(1.0 / carsPerSecond, EVENT_SPAWN, nullptr, nullptr);
+}
+
+/**
+ * Deconstructs the EventSimulation.
+ */
+EventSimulation::~EventSimulation() {}
+
+/**
+ * Returns the current time in the simulation.
+ */
+double EventSimulation::getCurrentTime() const { return currentTime; }
+
+/**
+ * Returns the number of events that have been run.
+ */
+long long EventSimulation::getEventCount() const { return processed; }
+
+/**
+ * Adds an event to the calendar.
+ * @param time the time the event occurs
+ * @param type the type of the event
+ * @param road the road of the event, or nullptr if there is none
+ * @param car the car of the event, or nullptr if there is none
+ */
+void EventSimulation::schedule(double time, int type, RoadSegment *road, Car *car) {
+    CarHandle handle = car != nullptr ? car->getHandle() : CarHandle{-1, -1};
+    calendar.push({time, sequence++, type, road, handle});
+}
+
+/**
+ * Adds the next controller event to the calendar if it is sooner than the one already in the calendar.
+ */
+void EventSimulation::scheduleController() {
+    double time = max(currentTime, controller->getNextEventTime(currentTime));
+    if (time < controllerTime) {
+        controllerTime = time;
+        schedule(time, EVENT_CONTROLLER, nullptr, nullptr);
+    }
+}
+
+/**
+ * Schedules the waiting queue of a road to be checked, unless it is already going to be checked by that time.
+ * @param r the road
+ * @param time the time to check the waiting queue
+ */
+void EventSimulation::scheduleRelease(RoadSegment *r, double time) {
+    auto it = pendingRelease.find(r->getID());
+    if (it != pendingRelease.end() && it->second <= time) return;
+    pendingRelease[r->getID()] = time;
+    schedule(time, EVENT_RELEASE, r, nullptr);
+}
+
+/**
+ * Checks the waiting queues of the roads leading into a road, since there is now space for another car on it.
+ * @param r the road that a car has left
+ */
+void EventSimulation::wakeInbound(RoadSegment *r) {
+    if (r->getCapacity() - r->getFlow() != 1) return; // the road was not full before the car left
+    const GraphView &view = G->freeze();
+    const int *inRoads = view.getInRoads();
+    int v = r->getSource()->getIndex();
+    for (int e = view.inBegin(v); e < view.inEnd(v); e++) {
+        RoadSegment *in = view.getRoadSegment(inRoads[e]);
+        if (queuedRoads.count(in)) scheduleRelease(in, currentTime);
+    }
+}
+
+/**
+ * Adds a car to the waiting queue at the end of a road.
+ * @param r the road the car is on
+ * @param c the car
+ */
+void EventSimulation::stop(RoadSegment *r, Car *c) {
+    r->stop(c);
+    queuedRoads.insert(r);
+    scheduleRelease(r, currentTime);
+}
+
+/**
+ * Moves a car from the end of a road on to the next road on its path, or removes it if it has reached its destination.
+ * @param r the road the car is leaving
+ * @param c the car
+ */
+void EventSimulation::leave(RoadSegment *r, Car *c) {
+    Point2D dest = r->getDestination()->getLocation();
+    bool removed = r->removeCar(c);
+    assert(removed && "car not on road");
+    wakeInbound(r);
+    if (c->hasNextRoad()) {
+        RoadSegment *rp = c->getNextRoad();
+        bool added = rp->addCar(c);
+        assert(added && "car was already on road");
+        c->setLocation(dest);
+        addCar(c);
+    } else { // car has reached destination
+        c->updateEfficiency(currentTime);
+        Car::pool.release(c);
+    }
+}
+
+/**
+ * Schedules the time a car that is on a road reaches the end of the road, or its destination if it is on its final road.
+ * Cars that are added to the city from outside the simulation must be added with this method.
+ * @param c the car
+ */
+void EventSimulation::addCar(Car *c) {
+    RoadSegment *r = c->getCurrentRoad();
+    const CarStore &cars = r->getCars();
+    double target = r == c->getFinalRoad() ? cars.getDestination(c->getSlot()) : r->getLength();
+    double dist = max(0.0, target - cars.getOffset(c->getSlot()));
+    schedule(currentTime + dist / c->getCurrentSpeed(), EVENT_ARRIVAL, r, c);
+}
+
+/**
+ * Runs the controller and checks the waiting queues at the intersections that have just cycled. The controller also
+ * runs when it only needs to check the flows of some intersections, so the queues are only looked at if there was a
+ * cycle due.
+ */
+void EventSimulation::runController() {
+    if (currentTime != controllerTime) return; // a sooner run has replaced this one
+    controllerTime = numeric_limits<double>::infinity();
+    bool cycling = controller->checkNextEvent(currentTime);
+    controller->runEvents(currentTime);
+    if (!cycling) return;
+    vector<RoadSegment*> cycled;
+    for (RoadSegment *r : queuedRoads) {
+        if (r->getDestination()->getTimeOfLastCycle() == currentTime) cycled.push_back(r);
+    }
+    for (RoadSegment *r : cycled) {
+        scheduleRelease(r, currentTime);
+    }
+}
+
+/**
+ * Handles a car reaching the end of a road, or its destination. A car only has an arrival event while it is moving
+ * on a road, and it can only stop or leave the road in its arrival event, so the event is never out of date.
+ * @param r the road the car is on
+ * @param c the car
+ */
+void EventSimulation::runArrival(RoadSegment *r, Car *c) {
+    assert(c != nullptr && "car was released before its arrival");
+    assert(r->carOnRoad(c) && !r->isStopped(c) && "car has left the road before its arrival");
+    if (r == c->getFinalRoad()) { // car has reached its destination
+        Point2D dest = c->getDestination();
+        c->setLocation(dest);
+        bool removed = r->removeCar(c);
+        assert(removed && "car not on road");
+        wakeInbound(r);
+        c->updateEfficiency(currentTime);
+        Car::pool.release(c);
+        return;
+    }
+    Point2D dest = r->getDestination()->getLocation();
+    c->setLocation(dest);
+    if (r->countCarsInQueue() > 0 && (!c->hasNextRoad()
+            || c->peekNextLight()->getType() == LEFT)) {
+        stop(r, c); // if there are cars stopped ahead (that are turning left), then this car should also stop
+    } else if (!c->hasNextRoad() || (c->peekNextLight()->getState() == GREEN
+            && c->peekNextRoad()->getCapacity() - c->peekNextRoad()->getFlow() >= 1)) {
+        leave(r, c);
+    } else {
+        stop(r, c); // car is waiting to move off the road
+    }
+}
+
+/**
+ * Lets the next car in the waiting queue of a road leave, if the light is green and there is space on the next road.
+ * @param r the road
+ */
+void EventSimulation::runRelease(RoadSegment *r) {
+    auto it = pendingRelease.find(r->getID());
+    if (it == pendingRelease.end() || it->second != currentTime) return; // a sooner check has replaced this one
+    pendingRelease.erase(it);
+    if (r->countCarsInQueue() == 0) {
+        queuedRoads.erase(r);
+        return;
+    }
+    if (r->getLatestTime() + REACTION_TIME > currentTime) {
+        scheduleRelease(r, r->getLatestTime() + REACTION_TIME);
+        return;
+    }
+    Car *c = r->getNextCarFromQueue();
+    if (!c->hasNextRoad() || (c->peekNextLight()->getState() == GREEN
+            && c->peekNextRoad()->getCapacity() - c->peekNextRoad()->getFlow() >= 1)) {
+        r->removeNextCarFromQueue(currentTime);
+        leave(r, c);
+        if (r->countCarsInQueue() > 0) scheduleRelease(r, currentTime + REACTION_TIME);
+        else queuedRoads.erase(r);
+    } // otherwise the queue is checked again when the light cycles or a car leaves the next road
+}
+
+/**
+ * Spawns a random car and schedules the next spawn.
+ */
+void EventSimulation::runSpawn() {
+    G->getRouter()->refresh(currentTime);
+    Car *c = getRandomCar(G, currentTime);
+    c->setSpeed(c->getCurrentRoad()->getRandomSpeed());
+    addCar(c);
+    schedule(currentTime + 1.0 / carsPerSecond, EVENT_SPAWN, nullptr, nullptr);
+}
+
+/**
+ * Runs all the events up to and including the specified time, and then sets the current time to that time.
+ * @param time the time to advance to
+ */
+void EventSimulation::advanceTo(double time) {
+    Car::routes.refresh(G); // the lights of the routes are deleted when the roads they join are removed
+    scheduleController();
+    while (!calendar.empty() && calendar.top().time <= time) {
+        Event e = calendar.top();
+        calendar.pop();
+        currentTime = e.time;
+        processed++;
+        if (e.type == EVENT_CONTROLLER) runController();
+        else if (e.type == EVENT_ARRIVAL) runArrival(e.road, Car::pool.get(e.car));
+        else if (e.type == EVENT_RELEASE) runRelease(e.road);
+        else if (e.type == EVENT_SPAWN) runSpawn();
+        scheduleController();
+    }
+    currentTime = max(currentTime, time);
+}
+
+/**
+ * Advances the simulation by the specified amount of time, so the EventSimulation can be driven like a Simulation.
+ * @param timeElapsed the time elasped since the last call
+ */
+void EventSimulation::nextIteration(double timeElapsed) {
+    advanceTo(currentTime + timeElapsed);
+}
@@ -0,0 +1,71 @@
+#ifndef EVENTSIMULATION_H_
+#define EVENTSIMULATION_H_
+
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "controller/Controller.h"
+#include "framework/Framework.h"
+#include "Simulation.h"
+
+// types of events in the calendar
+#define EVENT_CONTROLLER 0
+#define EVENT_ARRIVAL 1
+#define EVENT_RELEASE 2
+#define EVENT_SPAWN 3
+
+/**
+ * A timestamped event in the calendar. Events at the same time are run in the order they were scheduled.
+ */
+struct Event {
+    double time; // the time the event occurs
+    long long sequence; // the order the event was scheduled in
+    int type; // the type of the event
+    RoadSegment *road; // the road of an arrival or release event
+    CarHandle car; // the car of an arrival event
+
+    bool operator > (const Event &e) const;
+};
+
+/**
+ * Simulates the traffic in the city by jumping from one event to the next instead of stepping through fixed
+ * iterations. Cars move at a constant speed on a road, so the time they reach the end of the road (or their
+ * destination) is known as soon as they enter it.
+ */
+struct EventSimulation {
+private:
+    Controller *controller; // the traffic controller
+    WeightedDigraph *G; // the city represented as a weighted directed graph
+    double currentTime; // the time elapsed in the simulation
+    double carsPerSecond; // the number of random cars spawned per second
+    long long sequence; // the number of events that have been scheduled
+    long long processed; // the number of events that have been run
+    double controllerTime; // the time of the earliest controller event in the calendar, infinity if there is none
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> calendar; // the events that have not been run yet
+    std::unordered_map<int, double> pendingRelease; // maps the ID of a road to the time of its next release event
+    std::unordered_set<RoadSegment*> queuedRoads; // the roads with cars in the waiting queue
+
+    void schedule(double time, int type, RoadSegment *road, Car *car);
+    void scheduleController();
+    void scheduleRelease(RoadSegment *r, double time);
+    void wakeInbound(RoadSegment *r);
+    void stop(RoadSegment *r, Car *c);
+    void leave(RoadSegment *r, Car *c);
+    void runController();
+    void runArrival(RoadSegment *r, Car *c);
+    void runRelease(RoadSegment *r);
+    void runSpawn();
+
+public:
+    EventSimulation(Controller *controller, double carsPerSecond);
+    ~EventSimulation();
+    double getCurrentTime() const;
+    long long getEventCount() const;
+    void addCar(Car *c);
+    void advanceTo(double time);
+    void nextIteration(double timeElapsed);
+};
+
+#endif
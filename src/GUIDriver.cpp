@@ -120,10 +120,10 @@ void GUIDriver::run() {
         sim->nextIteration(iterationLength);
         chrono::duration<double> timeSinceLastCar = end - lastCarSpawn;
         if (timeSinceLastCar.count() >= 1.0 / ((double) carsPerSecond)) {
-            for (int i = 0; i < (int) floor(timeSinceLastCar.count() * ((double) carsPerSecond)); i++) {
-                Car *c = getRandomCar(G, sim->getCurrentTime());
-                c->setSpeed(c->getCurrentRoad()->getRandomSpeed());
-            }
+            wave.draw(G, (int) floor(timeSinceLastCar.count() * ((double) carsPerSecond)));
+            wave.route(G, sim->getThreadPool());
+            wave.insert(sim->getCurrentTime(), spawned);
+            for (Car *c : spawned) c->setSpeed(c->getCurrentRoad()->getRandomSpeed());
             lastCarSpawn = end;
         }
         draw();
@@ -2,6 +2,7 @@
 #define GUIDRIVER_H_
 
 #include <string>
+#include <vector>
 #include <QApplication>
 #include <QEventLoop>
 #include "gui/gui.h"
@@ -23,6 +24,8 @@ private:
     Controller *controller; // the traffic controller
     Simulation *sim; // the simulation being run
     WeightedDigraph *G; // the city represented as a weighted directed graph
+    SpawnWave wave; // the cars being spawned after the current iteration
+    std::vector<Car*> spawned; // the cars added by the last wave
     double iterationsPerSecond; // the number of iterations per second the simulation should execute
     double iterationLength; // the length of one iteration
     int carsPerSecond; // the number of cars added per second
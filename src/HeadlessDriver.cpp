@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cstdio>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <assert.h>
+#include "HeadlessDriver.h"
+#include "controller/PretimedController.h"
+#include "controller/BasicController.h"
+
+const Point2D headlessTopLeft(50.0, 50.0);
+const Point2D headlessTopRight(1950.0, 50.0);
+const Point2D headlessBottomLeft(50.0, 1950.0);
+const Point2D headlessBottomRight(1950.0, 1950.0);
+
+using namespace std;
+
+/**
+ * Initializes a new HeadlessDriver.
+ * @param city the file (text, binary or OpenStreetMap XML) to load the city from, "grid" for a generated grid city, or "random" for a randomly generated city
+ * @param controllerType 0 if PretimedController, 1 for BasicController
+ * @param iterationsPerSecond the number of iterations per simulated second (not used by the event simulation)
+ * @param threadCount the number of threads used in each iteration (not used by the event simulation)
+ * @param eventDriven true to use the event simulation, false to use the fixed iteration simulation
+ * @param router the router that finds the paths of the cars, "dijkstra", "astar", "alt", "ch", or "cch"
+ * @param cached true to cache the paths between pairs of intersections in front of the router
+ * @param rerouting true to find new paths for cars whose paths become congested (only with the fixed iteration simulation)
+ */
+HeadlessDriver::HeadlessDriver(string city, int controllerType, double iterationsPerSecond, int threadCount, bool eventDriven, string router, bool cached, bool rerouting) {
+    assert(iterationsPerSecond > 0.0 && "iterationsPerSecond must be a positive value");
+    iterationLength = 1.0 / iterationsPerSecond;
+    cg = nullptr;
+    gcg = nullptr;
+    sim = nullptr;
+    eventSim = nullptr;
+    cache = nullptr;
+    rerouter = nullptr;
+    alt = nullptr;
+    int cntCars = 0;
+    linked = false;
+    // every random choice of the run comes from a seeded generator, so runs with the same arguments give the same results
+    Car::generator.seed(HEADLESS_SEED);
+    RoadSegment::generator.seed(HEADLESS_SEED);
+    if (city == "grid") {
+        gcg = new GridCityGenerator(headlessTopLeft, headlessTopRight, headlessBottomLeft, headlessBottomRight, HEADLESS_SEED);
+        G = gcg->getGraph();
+        carsPerSecond = HEADLESS_SPAWNS_PER_SECOND;
+    } else if (city == "random") {
+        cg = new CityGenerator(headlessTopLeft, headlessTopRight, headlessBottomLeft, headlessBottomRight, HEADLESS_SEED);
+        G = cg->getGraph();
+        carsPerSecond = HEADLESS_SPAWNS_PER_SECOND;
+    } else {
+        G = new WeightedDigraph();
+        cntCars = loadFile(city);
+    }
+    Router *r = nullptr;
+    if (router == "dijkstra") r = new DijkstraRouter(G);
+    else if (router == "astar") r = new AStarRouter(G);
+    else if (router == "alt") r = alt = new ALTRouter(G, LANDMARK_COUNT, LANDMARK_AVOID);
+    else if (router == "ch") r = new ContractionHierarchyRouter(G);
+    else if (router == "cch") r = new CustomizableHierarchyRouter(G, CUSTOMIZATION_INTERVAL);
+    assert(r != nullptr && "unknown router");
+    if (cached) r = cache = new CachedRouter(r, ROUTE_CACHE_CAPACITY);
+    G->setRouter(r);
+    assert(!(rerouting && eventDriven) && "cars cannot be rerouted in the event simulation");
+    if (rerouting) {
+        // new paths are found with the queues at each road, which only a router made for rerouting counts
+        CustomizableHierarchyRouter *congestion = new CustomizableHierarchyRouter(G, REROUTE_CUSTOMIZATION_INTERVAL);
+        congestion->setQueueDelay(REROUTE_QUEUE_DELAY);
+        rerouter = new RerouteService(G, congestion, REROUTE_CHECKS, REROUTE_SEARCHES);
+    }
+    if (controllerType == 0) controller = new PretimedController(G);
+    else controller = new BasicController(G);
+    if (eventDriven) eventSim = new EventSimulation(controller, carsPerSecond);
+    else sim = new Simulation(controller, threadCount);
+    for (pair<int, Intersection*> intxn : G->getIntersections()) {
+        if (!linked) intxn.second->autoConnectAndLink();
+        controller->addEvent(0.0, intxn.first);
+    }
+    for (int i = 0; i < cntCars; i++) {
+        Car *c = getRandomCar(G, 0.0);
+        c->setSpeed(c->getCurrentRoad()->getRandomSpeed());
+        if (eventDriven) eventSim->addCar(c);
+    }
+}
+
+/**
+ * Deconstructs the HeadlessDriver and the associated simulation.
+ */
+HeadlessDriver::~HeadlessDriver() {
+    delete rerouter;
+    delete sim;
+    delete eventSim;
+    delete controller;
+    if (cg != nullptr) delete cg;
+    else if (gcg != nullptr) delete gcg;
+    else delete G;
+}
+
+/**
+ * Loads the city from a binary city file, an OpenStreetMap XML file, or from a file in the same format as the console
+ * and gui drivers.
+ * @param fileName the file to load the city
+ * @return the number of cars to add at the start of the simulation
+ */
+int HeadlessDriver::loadFile(string fileName) {
+    int cntCars;
+    vector<Intersection*> intersections;
+    if (CityFile::isCityFile(fileName)) {
+        CityFile file;
+        if (!file.open(fileName)) {
+            fprintf(stderr, "%s: %s\n", fileName.c_str(), file.getError().c_str());
+            exit(1);
+        }
+        file.load(G, intersections);
+        cntCars = file.countCars();
+        carsPerSecond = file.getCarsPerSecond();
+        linked = true; // the traffic lights were saved after they were connected and linked
+    } else if (OSMImporter::isOSMFile(fileName)) {
+        OSMImporter importer;
+        importer.import(fileName, G, intersections);
+        printf("imported %d ways: %d intersections, %d road segments (%d joining nodes removed, %d unreachable roads dropped)\n",
+                importer.countWays(), G->countIntersections(), G->countRoadSegments(), importer.countCollapsed(), importer.countDropped());
+        cntCars = 0;
+        carsPerSecond = HEADLESS_SPAWNS_PER_SECOND;
+    } else {
+        string error;
+        if (!CityFile::readText(fileName, G, intersections, cntCars, carsPerSecond, error)) {
+            fprintf(stderr, "%s: %s\n", fileName.c_str(), error.c_str());
+            exit(1);
+        }
+    }
+    return cntCars;
+}
+
+/**
+ * Runs the simulation for the specified amount of simulated time as fast as possible, and prints the throughput
+ * and the final efficiency.
+ * @param seconds the number of seconds to simulate
+ */
+void HeadlessDriver::run(double seconds) {
+    int createdBefore = Car::countCreated();
+    int reachedBefore = Car::countReached();
+    long long iterations = 0;
+    long long carUpdates = 0; // the number of times a car was advanced in an iteration
+    double spawnDebt = 0.0; // the number of cars that are due to be spawned
+    vector<Car*> spawned; // the cars added by the last wave
+    auto start = chrono::high_resolution_clock::now();
+    if (eventSim != nullptr) {
+        eventSim->advanceTo(seconds);
+    } else {
+        while (sim->getCurrentTime() + iterationLength <= seconds + EPS) {
+            carUpdates += Car::countCreated() - Car::countReached();
+            sim->nextIteration(iterationLength);
+            iterations++;
+            if (rerouter != nullptr) rerouter->run(sim->getCurrentTime());
+            spawnDebt += iterationLength * carsPerSecond;
+            int due = (int) floor(spawnDebt);
+            spawnDebt -= due;
+            wave.draw(G, due);
+            wave.route(G, sim->getThreadPool());
+            wave.insert(sim->getCurrentTime(), spawned);
+            for (Car *c : spawned) c->setSpeed(c->getCurrentRoad()->getRandomSpeed());
+        }
+    }
+    chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+    double wall = max(elapsed.count(), 1e-9);
+    int created = Car::countCreated() - createdBefore;
+    int reached = Car::countReached() - reachedBefore;
+    printf("simulated time: %.2f s\n", seconds);
+    printf("wall time: %.3f s (%.1fx real time)\n", wall, seconds / wall);
+    if (eventSim != nullptr) {
+        printf("events: %lld (%.1f events/sec)\n", eventSim->getEventCount(), eventSim->getEventCount() / wall);
+    } else {
+        printf("iterations: %lld (%.1f ticks/sec, %d threads)\n", iterations, iterations / wall, sim->getThreadCount());
+        printf("car updates: %lld (%.1f cars/sec)\n", carUpdates, carUpdates / wall);
+    }
+    printf("cars spawned: %d, cars arrived: %d (%.1f arrivals/sec)\n", created, reached, reached / wall);
+    printf("car pool: %d in use, %d allocated\n", Car::pool.size(), Car::pool.capacity());
+    printf("routes: %d distinct, %lld roads stored\n", Car::routes.size(), Car::routes.countRoads());
+    printf("router: %s\n", G->getRouter()->getName());
+    if (cache != nullptr) {
+        printf("route cache: %lld hits, %lld misses (%.1f%% hit rate), %d of %d pairs\n", cache->countHits(),
+                cache->countMisses(), cache->getHitRate() * 100.0, cache->size(), cache->getCapacity());
+    }
+    if (alt != nullptr) {
+        int onRoad = 0;
+        double expected = 0.0;
+        double remaining = 0.0;
+        for (RoadSegment *r : G->freeze().getRoadSegments()) {
+            for (int i = 0; i < r->getCars().size(); i++) {
+                Car *c = r->getCars().getCar(i);
+                onRoad++;
+                expected += c->getExpectedTime();
+                remaining += alt->getRemainingTime(c);
+            }
+        }
+        if (onRoad > 0) {
+            printf("eta: %d cars on the road, %.1f s expected per journey, at least %.1f s left on average\n", onRoad,
+                    expected / onRoad, remaining / onRoad);
+        }
+    }
+    if (rerouter != nullptr) {
+        printf("rerouting: %lld cars checked, %lld paths searched, %lld paths replaced\n", rerouter->countChecked(),
+                rerouter->countSearched(), rerouter->countRerouted());
+    }
+    printf("efficiency: %.2f%%\n", Car::getEfficiency() * 100.0);
+}
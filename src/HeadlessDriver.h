@@ -0,0 +1,42 @@
+#ifndef HEADLESSDRIVER_H_
+#define HEADLESSDRIVER_H_
+
+#include <string>
+#include "CityGenerator.h"
+#include "GridCityGenerator.h"
+#include "controller/Controller.h"
+#include "Simulation.h"
+#include "EventSimulation.h"
+#include "framework/Framework.h"
+
+#define HEADLESS_SPAWNS_PER_SECOND 100
+#define HEADLESS_SEED 0x3f3f3f
+
+/**
+ * Runs a simulation as fast as possible without displaying it, and reports how quickly it ran.
+ */
+struct HeadlessDriver {
+private:
+    CityGenerator *cg; // the random city generator, nullptr if it is not used
+    GridCityGenerator *gcg; // the grid city generator, nullptr if it is not used
+    Controller *controller; // the traffic controller
+    Simulation *sim; // the fixed iteration simulation, nullptr if the event simulation is used
+    EventSimulation *eventSim; // the event simulation, nullptr if the fixed iteration simulation is used
+    WeightedDigraph *G; // the city represented as a weighted directed graph
+    SpawnWave wave; // the cars being spawned after the current iteration
+    CachedRouter *cache; // the route cache in front of the router, nullptr if the routes are not cached
+    ALTRouter *alt; // the landmark router, nullptr if it is not used
+    RerouteService *rerouter; // finds new paths for cars on congested paths, nullptr if cars are not rerouted
+    double iterationLength; // the length of one iteration
+    int carsPerSecond; // the number of cars added per second
+    bool linked; // whether the traffic lights were loaded already connected and linked
+
+    int loadFile(std::string fileName);
+
+public:
+    HeadlessDriver(std::string city, int controllerType, double iterationsPerSecond, int threadCount, bool eventDriven, std::string router, bool cached, bool rerouting);
+    ~HeadlessDriver();
+    void run(double seconds);
+};
+
+#endif
@@ -1,10 +1,9 @@
 #include <utility>
 #include <cmath>
-#include <unordered_set>
+#include <functional>
 #include <assert.h>
 #include "Simulation.h"
 #include "controller/PretimedController.h"
-#include "misc/pair_hash.h"
 
 using namespace std;
 
@@ -12,15 +11,27 @@ using namespace std;
  * Initializes a new Simulation given a controller.
  * @param controller the controller that will handle the traffic
  */
-Simulation::Simulation(Controller *controller) {
+Simulation::Simulation(Controller *controller) : Simulation(controller, 1) {}
+
+/**
+ * Initializes a new Simulation given a controller and the number of threads used to advance the cars.
+ * The results do not depend on the number of threads.
+ * @param controller the controller that will handle the traffic
+ * @param threadCount the number of threads used in each iteration (must be a positive value)
+ */
+Simulation::Simulation(Controller *controller, int threadCount) {
     this->controller = controller;
     currentTime = 0.0;
+    pool = new ThreadPool(threadCount);
+    view = nullptr;
 }
 
 /**
  * Deconstructs the Simulation.
  */
-Simulation::~Simulation() {}
+Simulation::~Simulation() {
+    delete pool;
+}
 
 /**
  * Returns the current time in the simulation.
@@ -28,101 +39,195 @@ Simulation::~Simulation() {}
 double Simulation::getCurrentTime() { return currentTime; }
 
 /**
- * Performs the next iteration in the simulation.
+ * Returns the number of threads used in each iteration.
+ */
+int Simulation::getThreadCount() const { return pool->size(); }
+
+/**
+ * Returns the threads used in each iteration, which can also be used between iterations.
+ */
+ThreadPool *Simulation::getThreadPool() const { return pool; }
+
+/**
+ * Moves a car from the end of a road segment on to the next road on its path.
+ * @param r the road segment the car is leaving
+ * @param c the car
+ */
+void Simulation::moveToNextRoad(RoadSegment *r, Car *c) {
+    Point2D dest = r->getDestination()->getLocation();
+    bool removed = r->removeCar(c);
+    assert(removed && "car not on road");
+    c->setLocation(dest); // the car enters the next road at its source
+    RoadSegment *rp = c->getNextRoad();
+    bool added = rp->addCar(c);
+    assert(added && "car was already on road");
+}
+
+/**
+ * Removes a car that has reached its destination from the simulation.
+ * @param r the road segment the car is on
+ * @param c the car
+ */
+void Simulation::finishJourney(RoadSegment *r, Car *c) {
+    bool removed = r->removeCar(c);
+    assert(removed && "car not on road");
+    c->updateEfficiency(currentTime);
+    Car::pool.release(c);
+}
+
+/**
+ * Advances the cars on a road segment. Only the road segment itself (its cars and its waiting queue) is modified,
+ * so different road segments can be advanced concurrently. Cars leaving the road are recorded in the road's update.
+ * @param index the index of the road segment in the iteration
+ * @param timeElapsed the time elasped since the last iteration
+ */
+void Simulation::advanceRoad(int index, double timeElapsed) {
+    RoadSegment *r = view->getRoadSegment(index);
+    RoadUpdate &update = updates[index];
+    update.releaseFromQueue = false;
+    update.arrivals.clear();
+    int queued = r->countCarsInQueue(); // the cars in the queue that are not leaving in this iteration
+    // HANDLES CARS WAITING IN THE QUEUE TO EXIT INTERSECTION
+    if (queued > 0 && r->getLatestTime() + REACTION_TIME <= currentTime) {
+        Car *head = r->getNextCarFromQueue();
+        if (!head->hasNextRoad() || (head->peekNextLight()->getState() == GREEN
+                && head->peekNextRoad()->getCapacity() - head->peekNextRoad()->getFlow() >= 1)) {
+            update.releaseFromQueue = true;
+            queued--;
+        }
+    }
+    // HANDLES CARS TRAVELLING AT ROAD SPEED
+    // the moving cars are contiguous in the car store, and the cars that stop are moved out of the moving slots afterwards
+    // cars only move forward along the road, so a car has reached a point once it is within a step of passing it
+    update.stops.clear();
+    CarStore &cars = r->getCars();
+    int moving = cars.countMoving();
+    int words = getMaskWords(moving);
+    update.reachedDestination.resize(words);
+    update.reachedEnd.resize(words);
+    update.nearTail.resize(words);
+    CarBatch batch;
+    batch.offsets = cars.getOffsets();
+    batch.speeds = cars.getSpeeds();
+    batch.destinations = cars.getDestinations();
+    batch.size = moving;
+    batch.timeElapsed = timeElapsed;
+    batch.length = r->getLength();
+    batch.hasTail = queued > 0;
+    batch.tail = queued > 0 ? cars.getOffset(r->getLastCarInQueue()->getSlot()) : batch.length; // the offset of the last car in the queue
+    batch.reachedDestination = update.reachedDestination.data();
+    batch.reachedEnd = update.reachedEnd.data();
+    batch.nearTail = update.nearTail.data();
+    advanceCars(batch); // moves every car, then only the cars with a bit set in a mask need to be looked at
+    double tail = batch.tail;
+    bool tailMoved = false; // once a car stops, the cars after it are compared against it instead of the old tail
+    for (int w = 0; w < words; w++) {
+        uint64_t all = w + 1 < words || moving % MASK_BITS == 0 ? ~(uint64_t) 0 : ((uint64_t) 1 << (moving % MASK_BITS)) - 1;
+        uint64_t pending = tailMoved ? all : batch.reachedDestination[w] | batch.reachedEnd[w] | batch.nearTail[w];
+        while (pending != 0) {
+            int bit = getLowestBit(pending);
+            pending &= pending - 1;
+            int i = w * MASK_BITS + bit;
+            Car *c = cars.getCar(i);
+            if (batch.reachedDestination[w] >> bit & 1) {
+                update.arrivals.push_back(make_pair(c, REACHED_DESTINATION));
+                continue;
+            }
+            double eps_dist = timeElapsed * batch.speeds[i] * 0.51; // max distance between frames
+            bool nearTail = tailMoved ? fabs(tail - batch.offsets[i]) <= eps_dist : batch.nearTail[w] >> bit & 1;
+            bool nearEnd = batch.reachedEnd[w] >> bit & 1;
+            bool stopped = false;
+            if (nearTail && (!c->hasNextRoad() || c->peekNextLight()->getType() == LEFT)) {
+                stopped = true; // if there are cars stopped ahead (that are turning left), then this car should also stop
+            } else if (nearEnd) {
+                if (!c->hasNextRoad() || (c->peekNextLight()->getState() == GREEN
+                        && c->peekNextRoad()->getCapacity() - c->peekNextRoad()->getFlow() >= 1)) {
+                    update.arrivals.push_back(make_pair(c, REACHED_END));
+                } else {
+                    stopped = true; // car is waiting to move off the road
+                }
+            }
+            if (stopped) {
+                update.stops.push_back(c);
+                tail = batch.offsets[i];
+                queued++;
+                if (!tailMoved) pending = all & ~(((uint64_t) 2 << bit) - 1); // the rest of the cars in this word
+                tailMoved = true;
+            }
+        }
+    }
+    for (Car *c : update.stops) {
+        r->stop(c);
+    }
+}
+
+/**
+ * Applies the update of a road segment found while advancing its cars. Updates are committed one road at a time
+ * in a fixed order, and the capacity of the next road is checked again since other roads may have filled it.
+ * @param index the index of the road segment in the iteration
+ */
+void Simulation::commitRoad(int index) {
+    RoadSegment *r = view->getRoadSegment(index);
+    RoadUpdate &update = updates[index];
+    if (update.releaseFromQueue) {
+        Car *c = r->getNextCarFromQueue();
+        if (!c->hasNextRoad()) {
+            r->removeNextCarFromQueue(currentTime);
+            finishJourney(r, c);
+        } else if (c->peekNextRoad()->getCapacity() - c->peekNextRoad()->getFlow() >= 1) {
+            r->removeNextCarFromQueue(currentTime);
+            moveToNextRoad(r, c);
+        }
+    }
+    // DELETES CARS THAT HAVE REACHED THE DESTINATION
+    for (pair<Car*, int> c : update.arrivals) {
+        if (c.second == REACHED_DESTINATION || !c.first->hasNextRoad()) {
+            finishJourney(r, c.first);
+        } else if (c.first->peekNextRoad()->getCapacity() - c.first->peekNextRoad()->getFlow() < 1) {
+            r->stop(c.first);
+        } else {
+            moveToNextRoad(r, c.first);
+        }
+    }
+}
+
+/**
+ * Performs the next iteration in the simulation in two phases. First, the cars on every road segment are advanced
+ * in parallel, and then the cars that move between road segments are committed serially in a deterministic order.
  * @param timeElapsed the time elasped since the last iteration
  */
 void Simulation::nextIteration(double timeElapsed) {
     currentTime += timeElapsed;
     controller->runEvents(currentTime);
     WeightedDigraph *G = controller->getGraph();
-    unordered_set<int> done;
-    unordered_set<pair<int, int>, pair_hash<int, int>> toDelete;
     // PRE CHECK
     // for (pair<int, RoadSegment*> r : G->getRoadSegments()) {
-    //     for (pair<int, Car*> c : r.second->getCars()) {
-    //         assert(c.second != nullptr);
-    //         if (c.second->hasNextRoad()) {
-    //             // assert(c.second->peekNextRoad()->incoming.count(c.first));
-    //             assert(r.second->getDestination()->isConnected(r.first, c.second->peekNextRoad()->getID()));
+    //     for (int i = 0; i < r.second->getCars().size(); i++) {
+    //         Car *c = r.second->getCars().getCar(i);
+    //         assert(c != nullptr && c->getSlot() == i);
+    //         if (c->hasNextRoad()) {
+    //             // assert(c->peekNextRoad()->incoming.count(c->getID()));
+    //             assert(r.second->getDestination()->isConnected(r.first, c->peekNextRoad()->getID()));
     //         }
     //     }
     // }
-    for (pair<int, RoadSegment*> r : G->getRoadSegments()) {
-        Point2D dest = r.second->getDestination()->getLocation();
-        // HANDLES CARS WAITING IN THE QUEUE TO EXIT INTERSECTION
-        if (r.second->countCarsInQueue() > 0 && r.second->getLatestTime() + REACTION_TIME <= currentTime) {
-            Car *c = r.second->getNextCarFromQueue();
-            done.insert(c->getID());
-            if (!c->hasNextRoad() || (r.second->getDestination()->getLightBetween(r.first, c->peekNextRoad()->getID())->getState() == GREEN
-                    && c->peekNextRoad()->getCapacity() - c->peekNextRoad()->getFlow() >= 1)) {
-                r.second->removeNextCarFromQueue(currentTime);
-                c->setLocation(dest);
-                assert(r.second->removeCar(c) && "car not on road");
-                if (c->hasNextRoad()) {
-                    RoadSegment *rp = c->getNextRoad();
-                    assert(rp->addCar(c) && "car was already on road");
-                    c->setLocation(dest);
-                } else { // car has reached destination
-                    c->updateEfficiency(currentTime);
-                    delete c;
-                }
-            }
-        }
-        toDelete.clear();
-        // HANDLES CARS TRAVELLING AT ROAD SPEED
-        for (pair<int, Car*> c : r.second->getCars()) {
-            if (done.count(c.first) == 0 && !r.second->isStopped(c.first)) {
-                done.insert(c.first);
-                double dx = (timeElapsed * c.second->getCurrentSpeed()) * cos(c.second->getCurrentLocation().angleTo(dest));
-                double dy = (timeElapsed * c.second->getCurrentSpeed()) * sin(c.second->getCurrentLocation().angleTo(dest));
-                Point2D newLoc(c.second->getCurrentLocation().x + dx, c.second->getCurrentLocation().y + dy);
-                c.second->setLocation(newLoc);
-                double eps_dist = timeElapsed * c.second->getCurrentSpeed() * 0.51; // max distance between frames
-                if (c.second->getDestination().distanceTo(newLoc) <= eps_dist && r.first == c.second->getFinalRoad()->getID()) {
-                    toDelete.insert(make_pair(c.first, 1)); // type 1 means car has reached its destination
-                } else if (r.second->countCarsInQueue() > 0 && r.second->getLastCarInQueue()->getCurrentLocation().distanceTo(newLoc) <= eps_dist
-                        && (!c.second->hasNextRoad() || r.second->getDestination()->getLightBetween(r.first, c.second->peekNextRoad()->getID())->getType() == LEFT)) {
-                    assert(r.second->stop(c.first)); // if there are cars stopped ahead (that are turning left), then this car should also stop
-                } else if (dest.distanceTo(newLoc) <= eps_dist) {
-                    if (!c.second->hasNextRoad() || (r.second->getDestination()->getLightBetween(r.first, c.second->peekNextRoad()->getID())->getState() == GREEN
-                            && c.second->peekNextRoad()->getCapacity() - c.second->peekNextRoad()->getFlow() >= 1)) {
-                        toDelete.insert(make_pair(c.first, 2)); // type 2 means car has reached the end of the road
-                    } else {
-                        assert(r.second->stop(c.first)); // car is waiting to move off the road
-                    }
-                }
-            }
-        }
-        // DELETES CARS THAT HAVE REACHED THE DESTINATION
-        for (pair<int, int> c : toDelete) {
-            Car *car = r.second->getCar(c.first);
-            if (c.second == 1) { // type 1 means car has reached its destination
-                assert(r.second->removeCar(car) && "car not on road");
-                car->updateEfficiency(currentTime);
-                delete car;
-            } else if (car->hasNextRoad()) {
-                if (car->peekNextRoad()->getCapacity() - car->peekNextRoad()->getFlow() < 1) {
-                    assert(r.second->stop(c.first));
-                } else {
-                    assert(r.second->removeCar(car) && "car not on road");
-                    RoadSegment *rp = car->getNextRoad();
-                    assert(rp->addCar(car) && "car was already on road");
-                    car->setLocation(dest);
-                }
-            } else { // car has reached end the of road, and also its destination
-                assert(r.second->removeCar(car) && "car not on road");
-                car->updateEfficiency(currentTime);
-                delete car;
-            }
-        }
+    view = &G->freeze(); // only rebuilt if the city has changed
+    Car::routes.refresh(G); // the lights of the routes are deleted when the roads they join are removed
+    int roadCount = view->countRoadSegments();
+    if ((int) updates.size() < roadCount) updates.resize(roadCount);
+    pool->parallelFor(roadCount, [&] (int i) { advanceRoad(i, timeElapsed); });
+    for (int i = 0; i < roadCount; i++) {
+        commitRoad(i);
     }
+    G->getRouter()->refresh(currentTime); // the cars spawned after this iteration see the new flows
     // POST CHECK
     // for (pair<int, RoadSegment*> r : G->getRoadSegments()) {
-    //     for (pair<int, Car*> c : r.second->getCars()) {
-    //         assert(c.second != nullptr);
-    //         if (c.second->hasNextRoad()) {
-    //             // assert(c.second->peekNextRoad()->incoming.count(c.first));
-    //             assert(r.second->getDestination()->isConnected(r.first, c.second->peekNextRoad()->getID()));
+    //     for (int i = 0; i < r.second->getCars().size(); i++) {
+    //         Car *c = r.second->getCars().getCar(i);
+    //         assert(c != nullptr && c->getSlot() == i);
+    //         if (c->hasNextRoad()) {
+    //             // assert(c->peekNextRoad()->incoming.count(c->getID()));
+    //             assert(r.second->getDestination()->isConnected(r.first, c->peekNextRoad()->getID()));
     //         }
     //     }
     // }
@@ -1,11 +1,32 @@
 #ifndef SIMULATION_H_
 #define SIMULATION_H_
 
+#include <cstdint>
+#include <utility>
+#include <vector>
 #include "controller/Controller.h"
 #include "framework/Framework.h"
+#include "misc/CarKernel.h"
+#include "misc/ThreadPool.h"
 
 #define REACTION_TIME 0.1
 
+// the types of arrivals found while advancing the cars on a road
+#define REACHED_DESTINATION 1
+#define REACHED_END 2
+
+/**
+ * The changes to a road segment found while advancing its cars, to be applied in the commit phase.
+ */
+struct RoadUpdate {
+    bool releaseFromQueue; // true if the next car in the waiting queue is allowed to leave the road
+    std::vector<std::pair<Car*, int>> arrivals; // the cars that reached their destination or the end of the road
+    std::vector<Car*> stops; // the cars that stopped behind the waiting queue, in the order they stopped
+    std::vector<uint64_t> reachedDestination; // the mask of the moving cars that reached their destination
+    std::vector<uint64_t> reachedEnd; // the mask of the moving cars that reached the end of the road
+    std::vector<uint64_t> nearTail; // the mask of the moving cars that reached the last car in the waiting queue
+};
+
 /**
  * Simulates the traffic in the city
  */
@@ -13,11 +34,22 @@ struct Simulation {
 private:
     Controller *controller; // the traffic controller
     double currentTime; // the time elapsed in the simulation
+    ThreadPool *pool; // the threads that advance the cars on each road
+    const GraphView *view; // the frozen view of the graph, whose road segments are committed in order of their index
+    std::vector<RoadUpdate> updates; // the pending changes for each road segment
+
+    void advanceRoad(int index, double timeElapsed);
+    void commitRoad(int index);
+    void moveToNextRoad(RoadSegment *r, Car *c);
+    void finishJourney(RoadSegment *r, Car *c);
 
 public:
     Simulation(Controller *controller);
+    Simulation(Controller *controller, int threadCount);
     ~Simulation();
     double getCurrentTime();
+    int getThreadCount() const;
+    ThreadPool *getThreadPool() const;
     void nextIteration(double timeElapsed);
 };
 
@@ -0,0 +1,14 @@
+QT       -= core gui
+
+# Builds the microbenchmark of the kernels that advance the cars on a road.
+TARGET = traffix-bench
+TEMPLATE = app
+CONFIG += console c++14
+CONFIG -= app_bundle qt
+
+SOURCES += \
+        bench/CarKernelBenchmark.cpp \
+        misc/CarKernel.cpp
+
+HEADERS += \
+        misc/CarKernel.h
@@ -0,0 +1,164 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../misc/CarKernel.h"
+
+using namespace std;
+
+#define BENCH_ROAD_LENGTH 100.0
+#define BENCH_TIME_ELAPSED 0.05
+#define BENCH_SEED 2017
+
+/**
+ * The cars on a road before they are advanced, so that every run starts from the same state.
+ */
+struct BenchRoad {
+    vector<double> offsets;
+    vector<double> speeds;
+    vector<double> destinations;
+};
+
+/**
+ * The loop that advanced the cars on a road before the kernels, which checks every car as it moves it.
+ */
+static void advanceCarsLoop(CarBatch &batch, vector<pair<int, int>> &found) {
+    for (int i = 0; i < batch.size; i++) {
+        double step = batch.timeElapsed * batch.speeds[i];
+        batch.offsets[i] += step;
+        double eps_dist = step * 0.51;
+        if (batch.destinations[i] - batch.offsets[i] <= eps_dist) {
+            found.push_back(make_pair(i, 1));
+            continue;
+        }
+        bool nearTail = batch.hasTail && fabs(batch.tail - batch.offsets[i]) <= eps_dist;
+        bool nearEnd = batch.length - batch.offsets[i] <= eps_dist;
+        if (nearTail || nearEnd) found.push_back(make_pair(i, 2));
+    }
+}
+
+/**
+ * Advances every road once with either a kernel, or the old loop if the kernel is null, and returns the number
+ * of cars that reached a point.
+ */
+static long long advanceAll(vector<BenchRoad> &roads, vector<double> &offsets, CarKernel kernel, vector<uint64_t> &masks,
+        vector<pair<int, int>> &found) {
+    long long count = 0;
+    for (BenchRoad &road : roads) {
+        int n = road.offsets.size();
+        offsets.assign(road.offsets.begin(), road.offsets.end());
+        int words = getMaskWords(n);
+        masks.resize(3 * words);
+        CarBatch batch;
+        batch.offsets = offsets.data();
+        batch.speeds = road.speeds.data();
+        batch.destinations = road.destinations.data();
+        batch.size = n;
+        batch.timeElapsed = BENCH_TIME_ELAPSED;
+        batch.length = BENCH_ROAD_LENGTH;
+        batch.tail = BENCH_ROAD_LENGTH * 0.9;
+        batch.hasTail = true;
+        batch.reachedDestination = masks.data();
+        batch.reachedEnd = masks.data() + words;
+        batch.nearTail = masks.data() + 2 * words;
+        if (kernel == nullptr) {
+            found.clear();
+            advanceCarsLoop(batch, found);
+            count += found.size();
+        } else {
+            kernel(batch);
+            for (int w = 0; w < words; w++) {
+                uint64_t pending = batch.reachedDestination[w] | batch.reachedEnd[w] | batch.nearTail[w];
+                while (pending != 0) {
+                    pending &= pending - 1;
+                    count++;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * Times a kernel and prints the number of car updates per second.
+ */
+static double bench(const char *name, vector<BenchRoad> &roads, CarKernel kernel, int repetitions, long long cars) {
+    vector<double> offsets;
+    vector<uint64_t> masks;
+    vector<pair<int, int>> found;
+    long long reached = advanceAll(roads, offsets, kernel, masks, found); // warms up the caches
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; r++) {
+        advanceAll(roads, offsets, kernel, masks, found);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double rate = cars * repetitions / seconds;
+    printf("%-8s %10.1f M car updates/sec  (%lld cars reached a point)\n", name, rate / 1e6, reached);
+    return rate;
+}
+
+/**
+ * Checks that a kernel gives exactly the same offsets and masks as the scalar kernel.
+ */
+static bool matchesScalar(vector<BenchRoad> &roads, CarKernel kernel) {
+    for (BenchRoad &road : roads) {
+        int n = road.offsets.size(), words = getMaskWords(n);
+        vector<double> expectedOffsets = road.offsets, actualOffsets = road.offsets;
+        vector<uint64_t> expectedMasks(3 * words), actualMasks(3 * words);
+        CarBatch expected = {expectedOffsets.data(), road.speeds.data(), road.destinations.data(), n, BENCH_TIME_ELAPSED,
+                BENCH_ROAD_LENGTH, BENCH_ROAD_LENGTH * 0.9, true, expectedMasks.data(), expectedMasks.data() + words,
+                expectedMasks.data() + 2 * words};
+        CarBatch actual = expected;
+        actual.offsets = actualOffsets.data();
+        actual.reachedDestination = actualMasks.data();
+        actual.reachedEnd = actualMasks.data() + words;
+        actual.nearTail = actualMasks.data() + 2 * words;
+        advanceCarsScalar(expected);
+        kernel(actual);
+        if (expectedOffsets != actualOffsets || expectedMasks != actualMasks) return false;
+    }
+    return true;
+}
+
+/**
+ * Compares the speed of the car kernels against the old loop on roads with random cars.
+ * Usage: traffix-bench [cars per road] [roads] [repetitions]
+ */
+int main(int argc, char *argv[]) {
+    int carsPerRoad = argc > 1 ? atoi(argv[1]) : 64;
+    int roadCount = argc > 2 ? atoi(argv[2]) : 4096;
+    int repetitions = argc > 3 ? atoi(argv[3]) : 200;
+    mt19937 generator(BENCH_SEED);
+    uniform_real_distribution<double> offset(0.0, BENCH_ROAD_LENGTH), speed(5.0, 15.0), chance(0.0, 1.0);
+    vector<BenchRoad> roads(roadCount);
+    for (BenchRoad &road : roads) {
+        for (int i = 0; i < carsPerRoad; i++) {
+            road.offsets.push_back(offset(generator));
+            road.speeds.push_back(speed(generator));
+            // about one in ten cars are on their final road
+            road.destinations.push_back(chance(generator) < 0.1 ? offset(generator) : numeric_limits<double>::infinity());
+        }
+    }
+    long long cars = (long long) carsPerRoad * roadCount;
+    printf("%d roads with %d cars each, %d repetitions, dispatched kernel: %s\n", roadCount, carsPerRoad, repetitions, getCarKernelName());
+    double base = bench("loop", roads, nullptr, repetitions, cars);
+    vector<pair<const char*, CarKernel>> kernels;
+    kernels.push_back(make_pair("scalar", advanceCarsScalar));
+#ifdef CAR_KERNEL_X86
+    if (__builtin_cpu_supports("sse2")) kernels.push_back(make_pair("sse2", advanceCarsSSE2));
+    if (__builtin_cpu_supports("avx")) kernels.push_back(make_pair("avx", advanceCarsAVX));
+#endif
+    for (pair<const char*, CarKernel> k : kernels) {
+        if (!matchesScalar(roads, k.second)) {
+            printf("%s: results differ from the scalar kernel\n", k.first);
+            return 1;
+        }
+        double rate = bench(k.first, roads, k.second, repetitions, cars);
+        printf("         %.2fx the old loop\n", rate / base);
+    }
+    return 0;
+}
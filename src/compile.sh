@@ -1,3 +1,3 @@
- g++ ConsoleDriver.cpp Simulation.cpp main.cpp framework/*.cpp controller/*.cpp -std=c++14
+ g++ ConsoleDriver.cpp Simulation.cpp main.cpp framework/*.cpp controller/*.cpp misc/*.cpp -std=c++14 -pthread
  read -p "Press enter to exit"
  
\ No newline at end of file
@@ -0,0 +1,2 @@
+ g++ bench/CarKernelBenchmark.cpp misc/CarKernel.cpp -std=c++14 -O2 -o traffix-bench
+ read -p "Press enter to exit"
@@ -0,0 +1,2 @@
+ g++ headless.cpp HeadlessDriver.cpp CityGenerator.cpp GridCityGenerator.cpp Simulation.cpp EventSimulation.cpp framework/*.cpp controller/*.cpp misc/*.cpp -std=c++14 -O2 -pthread -o traffix-headless
+ read -p "Press enter to exit"
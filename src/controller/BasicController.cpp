@@ -1,4 +1,6 @@
 #include <assert.h>
+#include <algorithm>
+#include <limits>
 #include "BasicController.h"
 
 using namespace std;
@@ -7,12 +9,19 @@ using namespace std;
  * Initializes the BasicController given a Weighted Directed Graph.
  * @param G the Weighted Directed Graph that the controller will control
  */
-BasicController::BasicController(WeightedDigraph *G) : Controller(G) {}
+BasicController::BasicController(WeightedDigraph *G) : Controller(G) {
+    epoch = -1;
+}
 
 /**
- * Deconstructs the BasicController.
+ * Deconstructs the BasicController, and stops the intersections from recording their flow changes in it.
  */
-BasicController::~BasicController() {}
+BasicController::~BasicController() {
+    if (epoch == -1) return;
+    for (pair<int, Intersection*> n : G->getIntersections()) {
+        n.second->watchFlows(nullptr);
+    }
+}
 
 /**
  * Adds an event with a specified intersection ID at a specified time.
@@ -31,15 +40,72 @@ void BasicController::addEvent(double time, int id) {
  * @param currentTime the current time
  */
 bool BasicController::checkNextEvent(double currentTime) const {
-    return currentTime >= events.top().first;
+    return !events.empty() && currentTime >= events.top().first;
+}
+
+/**
+ * Returns the next time the controller needs to run. This is the current time if the flows of an intersection have
+ * changed or the graph has changed, and otherwise the time of the next scheduled event or the next time an
+ * intersection is checked, whichever is sooner, or infinity if there are neither.
+ * @param currentTime the current time
+ */
+double BasicController::getNextEventTime(double currentTime) const {
+    if (!flowChanges.empty() || G->getEpoch() != epoch) return currentTime;
+    double next = events.empty() ? numeric_limits<double>::infinity() : events.top().first;
+    return wakeups.empty() ? next : min(next, wakeups.top().first);
+}
+
+/**
+ * Checks an intersection again at a specified time, unless it is already going to be checked by that time.
+ * @param id the ID of the intersection
+ * @param time the time to check the intersection
+ */
+void BasicController::wake(int id, double time) {
+    auto it = wakeTimes.find(id);
+    if (it != wakeTimes.end() && it->second <= time) return;
+    wakeTimes[id] = time;
+    wakeups.push(make_pair(time, id));
+}
+
+/**
+ * Schedules an intersection to cycle if the flow of its red lights is high enough, or if it has been too long since
+ * it last cycled. Whether it cycles only changes when its flows change, when it cycles, or when MIN_TIME or MAX_TIME
+ * have passed since it last cycled, so the intersection is checked again at the next of those times that matters.
+ * @param n the intersection
+ * @param currentTime the current time
+ */
+void BasicController::check(Intersection *n, double currentTime) {
+    double last = n->getTimeOfLastCycle();
+    if (n->leftTurnSignalOn() || n->getScheduledTime() > currentTime) {
+        return; // checked again once it cycles
+    } else if (currentTime < last + MIN_TIME) {
+        wake(n->getID(), last + MIN_TIME);
+    } else if (currentTime >= last + MAX_TIME && n->getOppositeFlow() != 0) {
+        addEvent(currentTime + COOLDOWN, n->getID());
+        assert(n->isScheduled());
+    } else if (n->getCurrentFlow() < 2 * n->getOppositeFlow()) {
+        addEvent(currentTime + COOLDOWN, n->getID());
+        assert(n->isScheduled());
+    } else if (currentTime < last + MAX_TIME && n->getOppositeFlow() != 0) {
+        wake(n->getID(), last + MAX_TIME);
+    }
 }
 
 /**
  * Runs the events that are before or at the current time that have not yet been run and adds the
- * next events to the event queue.
+ * next events to the event queue. Only the intersections that have cycled, have had their flows change, or are due
+ * to be checked again are checked, rather than every intersection in the city.
  * @param currentTime the current time
  */
 void BasicController::runEvents(double currentTime) {
+    if (G->getEpoch() != epoch) { // new intersections are watched, and every intersection is checked since its roads may have changed
+        epoch = G->getEpoch();
+        flowChanges.clear();
+        for (pair<int, Intersection*> n : G->getIntersections()) {
+            n.second->watchFlows(&flowChanges);
+            flowChanges.push_back(n.first);
+        }
+    }
     while (!events.empty() && events.top().first <= currentTime) {
         Intersection *n = G->getIntersection(events.top().second);
         events.pop();
@@ -48,19 +114,27 @@ void BasicController::runEvents(double currentTime) {
         if (n->leftTurnSignalOn()) {
             addEvent(currentTime + LEFT_SIGNAL_TIME, n->getID());
             assert(n->isScheduled());
+        } else {
+            wake(n->getID(), n->getTimeOfLastCycle() + MIN_TIME);
         }
     }
+    checks.clear();
+    checks.swap(flowChanges);
+    while (!wakeups.empty() && wakeups.top().first <= currentTime) {
+        pair<double, int> w = wakeups.top();
+        wakeups.pop();
+        auto it = wakeTimes.find(w.second);
+        if (it == wakeTimes.end() || it->second != w.first) continue; // a sooner check has replaced this one
+        wakeTimes.erase(it);
+        checks.push_back(w.second);
+    }
     // get current cycle number in intersection, if green, check if net flow is less than 2 times the opposite flow
     // if so, then cycle the lights
-    for (pair<int, Intersection*> n : G->getIntersections()) {
-        if (currentTime - n.second->getTimeOfLastCycle() < MIN_TIME || n.second->leftTurnSignalOn() || n.second->getScheduledTime() > currentTime) {
-            continue;
-        } else if (currentTime - n.second->getTimeOfLastCycle() >= MAX_TIME && n.second->getOppositeFlow() != 0) {
-            addEvent(currentTime + COOLDOWN, n.first);
-            assert(n.second->isScheduled());
-        } else if (n.second->getCurrentFlow() < 2 * n.second->getOppositeFlow()) {
-            addEvent(currentTime + COOLDOWN, n.first);
-            assert(n.second->isScheduled());
-        }
+    const unordered_map<int, Intersection*> &intersections = G->getIntersections();
+    for (int id : checks) {
+        auto it = intersections.find(id);
+        if (it == intersections.end()) continue; // the intersection has been removed
+        it->second->watchFlows(&flowChanges);
+        check(it->second, currentTime);
     }
 }
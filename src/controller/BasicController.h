@@ -1,6 +1,11 @@
 #ifndef BASICCONTROLLER_H_
 #define BASICCONTROLLER_H_
 
+#include <functional>
+#include <utility>
+#include <vector>
+#include <queue>
+#include <unordered_map>
 #include "../framework/Framework.h"
 #include "Controller.h"
 
@@ -8,12 +13,24 @@
 #define MAX_TIME 60
 #define LEFT_SIGNAL_TIME 20
 #define COOLDOWN 5
+
 struct BasicController : public Controller {
+private:
+    std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> wakeups; // the times the intersections are checked again
+    std::unordered_map<int, double> wakeTimes; // the soonest time each intersection is checked again
+    std::vector<int> flowChanges; // the intersections whose flows have changed since they were last checked
+    std::vector<int> checks; // the intersections being checked
+    long long epoch; // the epoch of the graph the intersections were last watched in, -1 if they have not been
+
+    void wake(int id, double time);
+    void check(Intersection *n, double currentTime);
+
 public:
     BasicController(WeightedDigraph *G);
     ~BasicController();
     void addEvent(double time, int id);
     bool checkNextEvent(double currentTime) const;
+    double getNextEventTime(double currentTime) const;
     void runEvents(double currentTime);
 };
 
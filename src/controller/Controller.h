@@ -14,10 +14,11 @@ protected:
 
 public:
     Controller(WeightedDigraph *G);
-    ~Controller();
+    virtual ~Controller();
     WeightedDigraph *getGraph() const;
     virtual void addEvent(double time, int id) = 0;
     virtual bool checkNextEvent(double currentTime) const = 0;
+    virtual double getNextEventTime(double currentTime) const = 0;
     virtual void runEvents(double currentTime) = 0;
 };
 
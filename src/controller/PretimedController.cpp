@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <limits>
 #include "PretimedController.h"
 
 using namespace std;
@@ -30,7 +31,15 @@ void PretimedController::addEvent(double time, int id) {
  * @param currentTime the current time
  */
 bool PretimedController::checkNextEvent(double currentTime) const {
-    return currentTime >= events.top().first;
+    return !events.empty() && currentTime >= events.top().first;
+}
+
+/**
+ * Returns the time the next event is scheduled to occur, or infinity if there are no events.
+ * @param currentTime the current time
+ */
+double PretimedController::getNextEventTime(double /*currentTime*/) const {
+    return events.empty() ? numeric_limits<double>::infinity() : events.top().first;
 }
 
 /**
@@ -10,6 +10,7 @@ public:
     ~PretimedController();
     void addEvent(double time, int id);
     bool checkNextEvent(double currentTime) const;
+    double getNextEventTime(double currentTime) const;
     void runEvents(double currentTime);
 };
 
@@ -0,0 +1,45 @@
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#include "framework/Framework.h"
+
+#define CONVERT_SPAWNS_PER_SECOND 100
+
+using namespace std;
+
+/**
+ * Converts a city from the text format of the data directory or from an OpenStreetMap XML file to the binary city
+ * format, with the traffic lights connected and linked the same way the drivers do when they load the text file.
+ * Usage: traffix-convert <text city file | OSM file> <binary city file> [cars per second of an OSM file]
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <text city file | OSM file> <binary city file> [cars per second of an OSM file]\n", argv[0]);
+        return 1;
+    }
+    WeightedDigraph *G = new WeightedDigraph();
+    vector<Intersection*> intersections;
+    int cntCars;
+    int carsPerSecond;
+    if (OSMImporter::isOSMFile(argv[1])) {
+        OSMImporter importer;
+        importer.import(argv[1], G, intersections);
+        cntCars = 0;
+        carsPerSecond = argc > 3 ? atoi(argv[3]) : CONVERT_SPAWNS_PER_SECOND;
+    } else {
+        string error;
+        if (!CityFile::readText(argv[1], G, intersections, cntCars, carsPerSecond, error)) {
+            fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+            return 1;
+        }
+    }
+    for (pair<int, Intersection*> intxn : G->getIntersections()) {
+        intxn.second->autoConnectAndLink();
+    }
+    CityFile::write(argv[2], G, intersections, cntCars, carsPerSecond);
+    printf("%d intersections, %d road segments\n", G->countIntersections(), G->countRoadSegments());
+    delete G;
+    return 0;
+}
@@ -0,0 +1,50 @@
+QT       -= core gui
+
+# Builds the converter from the text city format or OpenStreetMap XML to the binary city format.
+TARGET = traffix-convert
+TEMPLATE = app
+CONFIG += console c++14
+CONFIG -= app_bundle qt
+LIBS += -pthread
+
+SOURCES += \
+        convert.cpp \
+        misc/CarKernel.cpp \
+        misc/IndexMinPQ.cpp \
+        misc/ThreadPool.cpp \
+        framework/Car.cpp \
+        framework/CarStore.cpp \
+        framework/CarPool.cpp \
+        framework/RouteTable.cpp \
+        framework/DijkstraDirectedSP.cpp \
+        framework/AStarDirectedSP.cpp \
+        framework/Router.cpp \
+        framework/DijkstraRouter.cpp \
+        framework/AStarRouter.cpp \
+        framework/Landmarks.cpp \
+        framework/ALTRouter.cpp \
+        framework/ContractionHierarchy.cpp \
+        framework/ContractionHierarchySP.cpp \
+        framework/ContractionHierarchyRouter.cpp \
+        framework/CustomizableHierarchyRouter.cpp \
+        framework/CachedRouter.cpp \
+        framework/SpawnWave.cpp \
+        framework/RerouteService.cpp \
+        framework/TravelTimeMatrix.cpp \
+        framework/CityFile.cpp \
+        framework/OSMImporter.cpp \
+        framework/Intersection.cpp \
+        framework/GraphView.cpp \
+        framework/SpatialIndex.cpp \
+        framework/Point2D.cpp \
+        framework/RoadSegment.cpp \
+        framework/TrafficLight.cpp \
+        framework/WeightedDigraph.cpp
+
+HEADERS += \
+        misc/pair_hash.h \
+        misc/vector_hash.h \
+        misc/CarKernel.h \
+        misc/IndexMinPQ.h \
+        misc/ThreadPool.h \
+        framework/Framework.h
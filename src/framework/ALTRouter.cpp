@@ -0,0 +1,85 @@
+#include <assert.h>
+#include "ALTRouter.h"
+#include "AStarDirectedSP.h"
+#include "WeightedDigraph.h"
+#include "Car.h"
+
+using namespace std;
+
+/**
+ * Initializes the ALTRouter given a Weighted Directed Graph. The landmarks are chosen the first time the router is
+ * prepared.
+ * @param G the Weighted Directed Graph that the router will find paths in
+ * @param count the number of landmarks
+ * @param selection how the landmarks are chosen, LANDMARK_FARTHEST or LANDMARK_AVOID
+ */
+ALTRouter::ALTRouter(WeightedDigraph *G, int count, int selection) : Router(G) {
+    assert(count > 0 && "there must be at least one landmark");
+    assert((selection == LANDMARK_FARTHEST || selection == LANDMARK_AVOID) && "unknown landmark selection");
+    this->count = count;
+    this->selection = selection;
+}
+
+/**
+ * Deconstructs the ALTRouter.
+ */
+ALTRouter::~ALTRouter() {}
+
+/**
+ * Returns the name of the router.
+ */
+const char *ALTRouter::getName() const { return "alt"; }
+
+/**
+ * Freezes the graph and chooses the landmarks again if the graph has changed since they were last chosen.
+ */
+void ALTRouter::prepare() {
+    const GraphView &view = G->freeze();
+    if (landmarks.getEpoch() != view.getEpoch()) landmarks.build(view, count, selection);
+}
+
+/**
+ * Finds the fastest path from one of the sources to one of the destinations.
+ * @param sourceIDs the intersection IDs of the sources
+ * @param initialTime the initial times to each of the sources
+ * @param destinationIDs the intersection IDs of the possible destinations
+ * @param excessTime the extra time required for each of the possible destinations
+ * @param path the path that is found
+ */
+void ALTRouter::route(vector<int> &sourceIDs, vector<double> &initialTime, vector<int> &destinationIDs, vector<double> &excessTime, ShortestPath &path) {
+    static thread_local AStarDirectedSP search; // reused by every search on this thread
+    if (landmarks.getEpoch() != G->getEpoch()) prepare();
+    search.search(G, &landmarks, sourceIDs, initialTime, destinationIDs, excessTime);
+    path.time = search.getShortestTime();
+    path.sourceID = search.getSourceID();
+    path.destinationID = search.getDestinationID();
+    path.roads.assign(search.getShortestPath().begin(), search.getShortestPath().end());
+}
+
+/**
+ * Returns a lower bound on the time between two intersections at the speed limits in constant time for a fixed
+ * number of landmarks, or infinity if there is no path. Must be called from a single thread if the router may not
+ * have been prepared.
+ * @param sourceID the ID of the intersection the path starts at
+ * @param destinationID the ID of the intersection the path ends at
+ */
+double ALTRouter::getLowerBound(int sourceID, int destinationID) {
+    if (landmarks.getEpoch() != G->getEpoch()) prepare();
+    return landmarks.getLowerBound(G->getIntersection(sourceID)->getIndex(), G->getIntersection(destinationID)->getIndex());
+}
+
+/**
+ * Returns a lower bound on the time the car needs to reach its destination at the speed limits, from the end of the
+ * road it is on to the start of its final road, which can be shown next to Car::getExpectedTime().
+ * @param c the car, which must be on a road
+ */
+double ALTRouter::getRemainingTime(Car *c) {
+    assert(c->getCurrentRoad() != nullptr && "car is not on a road");
+    if (!c->hasNextRoad()) return 0.0;
+    return getLowerBound(c->getCurrentRoad()->getDestination()->getID(), c->getFinalRoad()->getSource()->getID());
+}
+
+/**
+ * Returns the landmarks of the router.
+ */
+const Landmarks &ALTRouter::getLandmarks() const { return landmarks; }
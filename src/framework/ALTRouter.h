@@ -0,0 +1,31 @@
+#ifndef ALTROUTER_H_
+#define ALTROUTER_H_
+
+#include "Router.h"
+#include "Landmarks.h"
+
+/**
+ * Routes cars with A* search guided by landmarks (ALT). Choosing the landmarks takes a few searches over the whole
+ * city, after which each search visits far fewer intersections than A* with straight line distances. The landmarks
+ * also give a lower bound on the time between any two intersections without searching, which is used to estimate
+ * how long the cars have left. The landmarks are chosen again whenever the structure of the graph changes.
+ */
+struct ALTRouter : public Router {
+private:
+    Landmarks landmarks; // the landmarks chosen in the current graph
+    int count; // the number of landmarks
+    int selection; // how the landmarks are chosen, LANDMARK_FARTHEST or LANDMARK_AVOID
+
+public:
+    ALTRouter(WeightedDigraph *G, int count, int selection);
+    ~ALTRouter();
+    const char *getName() const;
+    void prepare();
+    void route(std::vector<int> &sourceIDs, std::vector<double> &initialTime, std::vector<int> &destinationIDs,
+            std::vector<double> &excessTime, ShortestPath &path);
+    double getLowerBound(int sourceID, int destinationID);
+    double getRemainingTime(Car *c);
+    const Landmarks &getLandmarks() const;
+};
+
+#endif
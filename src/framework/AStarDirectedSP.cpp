@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <assert.h>
+#include "AStarDirectedSP.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty structure with no path, which can be reused for any number of searches.
+ */
+AStarDirectedSP::AStarDirectedSP() {
+    shortestPathSourceID = shortestPathDestinationID = -1;
+    shortestTime = numeric_limits<double>::infinity();
+    stamp = 0;
+    landmarks = nullptr;
+}
+
+/**
+ * Deconstructs the structure.
+ */
+AStarDirectedSP::~AStarDirectedSP() {}
+
+/**
+ * Calculates the shortest path based on expected time to each of the possible destinations, replacing the result
+ * of the previous search. Gives the same shortest time as DijkstraDirectedSP.
+ * @param G the Weighted Directed Graph
+ * @param sourceIDs the intersection IDs of the sources
+ * @param initialTime the initial times to each of the sources
+ * @param destinationIDs the intersection IDs of the possible destinations
+ * @param excesstime the extra time required for each of the possible destinations
+ */
+void AStarDirectedSP::search(WeightedDigraph *G, vector<int> &sourceIDs, vector<double> &initialTime, vector<int> &destinationIDs, vector<double> &excessTime) {
+    search(G, nullptr, sourceIDs, initialTime, destinationIDs, excessTime);
+}
+
+/**
+ * Calculates the shortest path like search(), with lower bounds from the landmarks. The landmarks must have been
+ * built from the current view of the graph.
+ * @param G the Weighted Directed Graph
+ * @param landmarks the landmarks that give the lower bounds, nullptr to use straight line distances
+ * @param sourceIDs the intersection IDs of the sources
+ * @param initialTime the initial times to each of the sources
+ * @param destinationIDs the intersection IDs of the possible destinations
+ * @param excesstime the extra time required for each of the possible destinations
+ */
+void AStarDirectedSP::search(WeightedDigraph *G, const Landmarks *landmarks, vector<int> &sourceIDs, vector<double> &initialTime, vector<int> &destinationIDs, vector<double> &excessTime) {
+    shortestPath.clear();
+    const GraphView &view = G->freeze();
+    assert((landmarks == nullptr || landmarks->getEpoch() == view.getEpoch()) && "landmarks are not built from the current graph");
+    this->landmarks = landmarks;
+    prepare(view.countIntersections());
+    for (int d = 0; d < (int) destinationIDs.size(); d++) {
+        int v = G->getIntersection(destinationIDs[d])->getIndex();
+        if (destinationStamp[v] != stamp) {
+            destinationStamp[v] = stamp;
+            excessAt[v] = excessTime[d];
+            destinations.push_back(v);
+        } else {
+            excessAt[v] = min(excessAt[v], excessTime[d]);
+        }
+    }
+    for (int s = 0; s < (int) sourceIDs.size(); s++) {
+        relax(view, G->getIntersection(sourceIDs[s])->getIndex(), initialTime[s], -1);
+    }
+    shortestPathSourceID = shortestPathDestinationID = -1;
+    shortestTime = numeric_limits<double>::infinity();
+    int destination = -1;
+    const int *outRoads = view.getOutRoads();
+    const int *outTargets = view.getOutTargets();
+    const double *outWeights = view.getOutWeights();
+    // the key of every unvisited intersection is a lower bound on any path through it
+    while (!pq.isEmpty() && pq.topKey() < shortestTime) {
+        int v = pq.pop();
+        if (destinationStamp[v] == stamp && timeTo[v] + excessAt[v] < shortestTime) {
+            shortestTime = timeTo[v] + excessAt[v];
+            destination = v;
+        }
+        for (int e = view.outBegin(v); e < view.outEnd(v); e++) {
+            relax(view, outTargets[e], timeTo[v] + outWeights[e], outRoads[e]);
+        }
+    }
+    if (shortestTime != numeric_limits<double>::infinity()) {
+        shortestPathDestinationID = view.getIntersection(destination)->getID();
+        // the path is built backwards from the destination into the reused vector, then reversed
+        for (int e = roadTo[destination]; e != -1; e = roadTo[view.getSource(e)]) {
+            shortestPath.push_back(view.getRoadSegment(e));
+        }
+        assert(!shortestPath.empty() && "no path for car to reach destination from sources");
+        reverse(shortestPath.begin(), shortestPath.end());
+        shortestPathSourceID = shortestPath.front()->getSource()->getID();
+    }
+}
+
+/**
+ * Starts a new search by moving to the next stamp, which invalidates the entries of the previous search without
+ * touching them. The scratch arrays only grow when the city has more intersections than before.
+ * @param V the number of intersections in the frozen view
+ */
+void AStarDirectedSP::prepare(int V) {
+    pq.clear();
+    destinations.clear();
+    if ((int) reached.size() < V) {
+        timeTo.resize(V);
+        estimate.resize(V);
+        roadTo.resize(V);
+        reached.resize(V, 0);
+        excessAt.resize(V);
+        destinationStamp.resize(V, 0);
+        pq.reserve(V);
+    }
+    if (stamp == numeric_limits<int>::max()) { // the stamps wrapped around, so the old ones have to be cleared
+        fill(reached.begin(), reached.end(), 0);
+        fill(destinationStamp.begin(), destinationStamp.end(), 0);
+        stamp = 0;
+    }
+    stamp++;
+}
+
+/**
+ * Returns a lower bound on the time to finish the journey from an intersection. No road is shorter than the
+ * straight line between its ends or faster than the largest speed limit, so the bound never overestimates. The
+ * landmark bounds follow from the triangle inequality instead.
+ * @param view the frozen view of the graph
+ * @param v the index of the intersection
+ */
+double AStarDirectedSP::lowerBound(const GraphView &view, int v) const {
+    double best = numeric_limits<double>::infinity();
+    if (landmarks != nullptr) {
+        for (int d : destinations) {
+            best = min(best, landmarks->getLowerBound(v, d) + excessAt[d]);
+        }
+        return best;
+    }
+    const double *xs = view.getXs(), *ys = view.getYs();
+    for (int d : destinations) {
+        double dist = sqrt((xs[v] - xs[d]) * (xs[v] - xs[d]) + (ys[v] - ys[d]) * (ys[v] - ys[d]));
+        best = min(best, dist / view.getMaxSpeedLimit() + excessAt[d]);
+    }
+    return best;
+}
+
+/**
+ * Records a path to an intersection if it is shorter than the shortest path found so far.
+ * @param view the frozen view of the graph
+ * @param v the index of the intersection
+ * @param time the time to reach the intersection on the path
+ * @param road the index of the last road on the path, -1 if the intersection is a source
+ */
+void AStarDirectedSP::relax(const GraphView &view, int v, double time, int road) {
+    if (reached[v] == stamp && timeTo[v] <= time) return;
+    if (reached[v] != stamp) estimate[v] = lowerBound(view, v);
+    bool queued = reached[v] == stamp && pq.contains(v);
+    reached[v] = stamp;
+    timeTo[v] = time;
+    roadTo[v] = road;
+    if (queued) pq.decreaseKey(v, time + estimate[v]);
+    else pq.push(v, time + estimate[v]);
+}
+
+/**
+ * Returns whether there is a path from the source to reach the destination.
+ */
+bool AStarDirectedSP::hasPath() const { return shortestTime != numeric_limits<double>::infinity(); }
+
+/**
+ * Returns the shortest amount of time to reach the destination.
+ */
+double AStarDirectedSP::getShortestTime() const { return shortestTime; }
+
+/**
+ * Returns the ID of starting (source) intersection of the shortest path.
+ */
+int AStarDirectedSP::getSourceID() const { return shortestPathSourceID; }
+
+/**
+ * Returns the ID of destination intersection of the shortest path.
+ */
+int AStarDirectedSP::getDestinationID() const { return shortestPathDestinationID; }
+
+/**
+ * Returns the shortest path based on time to reach one of the possible destination intersections from one of the source intersections.
+ */
+const vector<RoadSegment*> &AStarDirectedSP::getShortestPath() const { return shortestPath; }
@@ -0,0 +1,54 @@
+#ifndef ASTARDIRECTEDSP_H_
+#define ASTARDIRECTEDSP_H_
+
+#include <vector>
+#include "Forward.h"
+#include "RoadSegment.h"
+#include "Intersection.h"
+#include "WeightedDigraph.h"
+#include "Landmarks.h"
+#include "../misc/IndexMinPQ.h"
+
+/**
+ * Finds the fastest path like DijkstraDirectedSP, but visits the intersections in order of the time to reach them
+ * plus a lower bound on the time left. The lower bound is the straight line distance to a possible destination
+ * divided by the largest speed limit in the city, plus the excess time of that destination, so the search heads
+ * towards the destinations instead of spreading out in every direction. When landmarks are given, the lower bound
+ * comes from the landmarks instead, which is much closer to the real time on a road network (ALT search).
+ */
+struct AStarDirectedSP {
+private:
+    // the scratch arrays are indexed by the intersection index in the frozen view, and an entry is only valid
+    // if its stamp matches the current search, so nothing has to be reset between searches
+    std::vector<double> timeTo; // the shortest time to each intersection found so far
+    std::vector<double> estimate; // the lower bound on the time left from each intersection
+    std::vector<int> roadTo; // the index of the last road on the shortest path to each intersection, -1 if there is none
+    std::vector<int> reached; // the stamp of the last search that reached each intersection
+    std::vector<double> excessAt; // the smallest excess time of each possible destination intersection
+    std::vector<int> destinationStamp; // the stamp of the last search that had each intersection as a destination
+    std::vector<int> destinations; // the indices of the distinct possible destination intersections
+    int stamp; // the stamp of the current search
+    const Landmarks *landmarks; // the landmarks that give the lower bounds, nullptr to use straight line distances
+    IndexMinPQ pq; // the intersections that have been reached but not visited, keyed by time plus lower bound
+    int shortestPathSourceID;
+    int shortestPathDestinationID;
+    double shortestTime;
+    std::vector<RoadSegment*> shortestPath;
+
+    void prepare(int V);
+    double lowerBound(const GraphView &view, int v) const;
+    void relax(const GraphView &view, int v, double time, int road);
+
+public:
+    AStarDirectedSP();
+    ~AStarDirectedSP();
+    void search(WeightedDigraph *G, std::vector<int> &sourceIDs, std::vector<double> &initialTime, std::vector<int> &destinationIDs, std::vector<double> &excessTime);
+    void search(WeightedDigraph *G, const Landmarks *landmarks, std::vector<int> &sourceIDs, std::vector<double> &initialTime, std::vector<int> &destinationIDs, std::vector<double> &excessTime);
+    bool hasPath() const;
+    double getShortestTime() const;
+    int getSourceID() const;
+    int getDestinationID() const;
+    const std::vector<RoadSegment*> &getShortestPath() const;
+};
+
+#endif
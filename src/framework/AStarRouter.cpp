@@ -0,0 +1,37 @@
+#include "AStarRouter.h"
+#include "AStarDirectedSP.h"
+
+using namespace std;
+
+/**
+ * Initializes the AStarRouter given a Weighted Directed Graph.
+ * @param G the Weighted Directed Graph that the router will find paths in
+ */
+AStarRouter::AStarRouter(WeightedDigraph *G) : Router(G) {}
+
+/**
+ * Deconstructs the AStarRouter.
+ */
+AStarRouter::~AStarRouter() {}
+
+/**
+ * Returns the name of the router.
+ */
+const char *AStarRouter::getName() const { return "astar"; }
+
+/**
+ * Finds the fastest path from one of the sources to one of the destinations.
+ * @param sourceIDs the intersection IDs of the sources
+ * @param initialTime the initial times to each of the sources
+ * @param destinationIDs the intersection IDs of the possible destinations
+ * @param excessTime the extra time required for each of the possible destinations
+ * @param path the path that is found
+ */
+void AStarRouter::route(vector<int> &sourceIDs, vector<double> &initialTime, vector<int> &destinationIDs, vector<double> &excessTime, ShortestPath &path) {
+    static thread_local AStarDirectedSP search; // reused by every search on this thread
+    search.search(G, sourceIDs, initialTime, destinationIDs, excessTime);
+    path.time = search.getShortestTime();
+    path.sourceID = search.getSourceID();
+    path.destinationID = search.getDestinationID();
+    path.roads.assign(search.getShortestPath().begin(), search.getShortestPath().end());
+}
@@ -0,0 +1,18 @@
+#ifndef ASTARROUTER_H_
+#define ASTARROUTER_H_
+
+#include "Router.h"
+
+/**
+ * Routes cars with A* search, which explores less of the city than Dijkstra's algorithm for the same paths.
+ */
+struct AStarRouter : public Router {
+public:
+    AStarRouter(WeightedDigraph *G);
+    ~AStarRouter();
+    const char *getName() const;
+    void route(std::vector<int> &sourceIDs, std::vector<double> &initialTime, std::vector<int> &destinationIDs,
+            std::vector<double> &excessTime, ShortestPath &path);
+};
+
+#endif
@@ -0,0 +1,201 @@
+#include <limits>
+#include <assert.h>
+#include "CachedRouter.h"
+#include "WeightedDigraph.h"
+#include "RoadSegment.h"
+
+using namespace std;
+
+/**
+ * Initializes the CachedRouter in front of another router, which it takes ownership of.
+ * @param router the router that finds the paths that are not cached
+ * @param capacity the most pairs of intersections kept in the cache
+ */
+CachedRouter::CachedRouter(Router *router, int capacity) : Router(router->getGraph()) {
+    assert(capacity > 0 && "capacity must be a positive value");
+    this->router = router;
+    this->capacity = capacity;
+    name = string("cached ") + router->getName();
+    epoch = -1;
+    weightEpoch = -1;
+    hits = misses = 0;
+}
+
+/**
+ * Deconstructs the CachedRouter and the router in front of which it was.
+ */
+CachedRouter::~CachedRouter() {
+    delete router;
+}
+
+/**
+ * Returns the name of the router.
+ */
+const char *CachedRouter::getName() const { return name.c_str(); }
+
+/**
+ * Prepares the router in front of which the cache is.
+ */
+void CachedRouter::prepare() {
+    router->prepare();
+}
+
+/**
+ * Lets the router in front of which the cache is update its weights. The cache is dropped the next time a car is
+ * routed if the weights changed.
+ * @param currentTime the current time of the simulation
+ */
+void CachedRouter::refresh(double currentTime) {
+    router->refresh(currentTime);
+}
+
+/**
+ * Returns the weight epoch of the router in front of which the cache is.
+ */
+long long CachedRouter::getWeightEpoch() const { return router->getWeightEpoch(); }
+
+/**
+ * Finds the fastest path from one of the sources to one of the destinations, from the cached path between each
+ * pair of source and destination intersections. A source that is also a destination is not a path.
+ * @param sourceIDs the intersection IDs of the sources
+ * @param initialTime the initial times to each of the sources
+ * @param destinationIDs the intersection IDs of the possible destinations
+ * @param excessTime the extra time required for each of the possible destinations
+ * @param path the path that is found
+ */
+void CachedRouter::route(vector<int> &sourceIDs, vector<double> &initialTime, vector<int> &destinationIDs, vector<double> &excessTime, ShortestPath &path) {
+    static thread_local CachedRoute route, best; // reused by every search on this thread
+    path.clear();
+    best.time = numeric_limits<double>::infinity();
+    for (int s = 0; s < (int) sourceIDs.size(); s++) {
+        for (int d = 0; d < (int) destinationIDs.size(); d++) {
+            if (sourceIDs[s] == destinationIDs[d]) continue;
+            find(sourceIDs[s], destinationIDs[d], route);
+            if (route.time == numeric_limits<double>::infinity()) continue;
+            double time = initialTime[s] + route.time + excessTime[d];
+            if (time < path.time) {
+                path.time = time;
+                path.sourceID = sourceIDs[s];
+                path.destinationID = destinationIDs[d];
+                best.roads.swap(route.roads);
+            }
+        }
+    }
+    if (!path.exists()) return;
+    const GraphView &view = G->getView();
+    for (int r : best.roads) {
+        path.roads.push_back(view.getRoadSegment(r));
+    }
+}
+
+/**
+ * Finds the fastest path between two intersections, from the cache if it is there or from the router otherwise.
+ * @param sourceID the ID of the source intersection
+ * @param destinationID the ID of the destination intersection
+ * @param route the path that is found
+ */
+void CachedRouter::find(int sourceID, int destinationID, CachedRoute &route) {
+    if (lookup(sourceID, destinationID, route)) return;
+    static thread_local vector<int> sources(1), destinations(1);
+    static thread_local vector<double> zero(1, 0.0);
+    static thread_local ShortestPath search;
+    sources[0] = sourceID;
+    destinations[0] = destinationID;
+    router->route(sources, zero, destinations, zero, search);
+    route.time = search.time;
+    route.roads.clear();
+    for (RoadSegment *r : search.roads) {
+        route.roads.push_back(r->getIndex());
+    }
+    insert(sourceID, destinationID, route);
+}
+
+/**
+ * Copies the cached path between two intersections, and marks it as the most recently used. The cache is dropped
+ * first if the graph or the weights have changed since the paths in it were found.
+ * @param sourceID the ID of the source intersection
+ * @param destinationID the ID of the destination intersection
+ * @param route the cached path
+ * @return true if the path was in the cache, false otherwise
+ */
+bool CachedRouter::lookup(int sourceID, int destinationID, CachedRoute &route) {
+    lock_guard<mutex> lock(mtx);
+    if (epoch != G->getEpoch() || weightEpoch != router->getWeightEpoch()) {
+        entries.clear();
+        index.clear();
+        epoch = G->getEpoch();
+        weightEpoch = router->getWeightEpoch();
+    }
+    auto it = index.find(make_pair(sourceID, destinationID));
+    if (it == index.end()) {
+        misses++;
+        return false;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    route.time = it->second->second.time;
+    route.roads.assign(it->second->second.roads.begin(), it->second->second.roads.end());
+    return true;
+}
+
+/**
+ * Adds the path between two intersections to the cache as the most recently used, dropping the least recently
+ * used path if the cache is full. The path is not added if the graph or the weights changed while it was found.
+ * @param sourceID the ID of the source intersection
+ * @param destinationID the ID of the destination intersection
+ * @param route the path
+ */
+void CachedRouter::insert(int sourceID, int destinationID, const CachedRoute &route) {
+    lock_guard<mutex> lock(mtx);
+    if (epoch != G->getEpoch() || weightEpoch != router->getWeightEpoch()) return;
+    Key key = make_pair(sourceID, destinationID);
+    if (index.count(key)) return; // found by another thread at the same time
+    if ((int) entries.size() == capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+    entries.emplace_front(key, route);
+    index[key] = entries.begin();
+}
+
+/**
+ * Returns the router in front of which the cache is.
+ */
+Router *CachedRouter::getRouter() const { return router; }
+
+/**
+ * Returns the number of pairs of intersections in the cache.
+ */
+int CachedRouter::size() {
+    lock_guard<mutex> lock(mtx);
+    return entries.size();
+}
+
+/**
+ * Returns the most pairs of intersections kept in the cache.
+ */
+int CachedRouter::getCapacity() const { return capacity; }
+
+/**
+ * Returns the number of times a path was found in the cache.
+ */
+long long CachedRouter::countHits() const { return hits; }
+
+/**
+ * Returns the number of times a path was not found in the cache.
+ */
+long long CachedRouter::countMisses() const { return misses; }
+
+/**
+ * Returns the fraction of lookups that found the path in the cache, 0 if there were none.
+ */
+double CachedRouter::getHitRate() const { return hits + misses == 0 ? 0.0 : (double) hits / (hits + misses); }
+
+/**
+ * Drops every path in the cache, keeping the counters.
+ */
+void CachedRouter::clear() {
+    lock_guard<mutex> lock(mtx);
+    entries.clear();
+    index.clear();
+}
@@ -0,0 +1,68 @@
+#ifndef CACHEDROUTER_H_
+#define CACHEDROUTER_H_
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Router.h"
+#include "../misc/pair_hash.h"
+
+#define ROUTE_CACHE_CAPACITY 4096 // the default number of intersection pairs kept in the cache
+
+/**
+ * The fastest path between two intersections, stored as the indices of its road segments in the frozen view.
+ */
+struct CachedRoute {
+    double time; // the expected time of the path, infinity if there is no path
+    std::vector<int> roads; // the indices of the road segments on the path
+};
+
+/**
+ * Caches the fastest paths between pairs of intersections found by another router. Cars are routed from any of a
+ * few source intersections to any of a few destination intersections, with times that depend on where exactly the
+ * car starts and ends, so the cache keeps the path between each pair of intersections and combines them with the
+ * times of each car. Only the least recently used pairs are dropped when the cache is full, and the whole cache is
+ * dropped when the graph or the weights of the router change.
+ */
+struct CachedRouter : public Router {
+private:
+    typedef std::pair<int, int> Key; // the IDs of the source and destination intersections
+    typedef std::list<std::pair<Key, CachedRoute>> Entries;
+
+    Router *router; // the router that finds the paths that are not cached
+    std::string name; // the name of the router
+    int capacity; // the most pairs kept in the cache
+    Entries entries; // the cached pairs from the most to the least recently used
+    std::unordered_map<Key, Entries::iterator, pair_hash<int, int>> index; // the position of each cached pair
+    long long epoch; // the epoch of the graph the cached paths were found in
+    long long weightEpoch; // the weight epoch of the router the cached paths were found with
+    long long hits;
+    long long misses;
+    std::mutex mtx; // guards the cache, so cars can be routed from multiple threads
+
+    bool lookup(int sourceID, int destinationID, CachedRoute &route);
+    void insert(int sourceID, int destinationID, const CachedRoute &route);
+    void find(int sourceID, int destinationID, CachedRoute &route);
+
+public:
+    CachedRouter(Router *router, int capacity);
+    ~CachedRouter();
+    const char *getName() const;
+    void prepare();
+    void refresh(double currentTime);
+    long long getWeightEpoch() const;
+    void route(std::vector<int> &sourceIDs, std::vector<double> &initialTime, std::vector<int> &destinationIDs,
+            std::vector<double> &excessTime, ShortestPath &path);
+    Router *getRouter() const;
+    int size();
+    int getCapacity() const;
+    long long countHits() const;
+    long long countMisses() const;
+    double getHitRate() const;
+    void clear();
+};
+
+#endif
@@ -12,8 +12,24 @@ double Car::efficiency = 1.0;
 int Car::reached = 0;
 mt19937 Car::generator;
 uniform_real_distribution<double> Car::distribution(0, 1);
+CarPool Car::pool;
+RouteTable Car::routes;
+
+/**
+ * Initializes a car that is not in use. Cars are allocated by the pool and must be initialized with init().
+ */
+Car::Car() {
+    currentRoad = nullptr;
+    slot = -1;
+    route = -1;
+    path = nullptr;
+    lights = nullptr;
+    handle = {-1, -1};
+}
+
 /**
- * Initializes a car given the starting and ending point.
+ * Initializes a car given the starting and ending point. A car that has been released to the pool can be
+ * initialized again, and reuses the memory of its previous journey.
  * @param source the exact location of the source in the x, y plane
  * @param destination the exact location of the destination in the x, y plane
  * @param sourceRoads the road segments the lead out of the source
@@ -21,48 +37,135 @@ uniform_real_distribution<double> Car::distribution(0, 1);
  * @param currentTime the current time in the simulation
  * @param G the Weighted Directed Graph
  */
-Car::Car(Point2D &source, Point2D &destination, vector<RoadSegment*> &sourceRoads, vector<RoadSegment*> &destinationRoads, double currentTime, WeightedDigraph *G) {
+void Car::init(Point2D &source, Point2D &destination, vector<RoadSegment*> &sourceRoads, vector<RoadSegment*> &destinationRoads, double currentTime, WeightedDigraph *G) {
+    static thread_local ShortestPath search; // reused by every car routed on this thread
+    findPath(source, destination, sourceRoads, destinationRoads, G, search);
+    init(source, destination, sourceRoads, destinationRoads, search, currentTime);
+}
+
+/**
+ * Finds the path of a car from the starting point to the ending point without creating the car, so the paths of
+ * many cars can be found in parallel. Only reads the graph, which must be frozen and have a prepared router.
+ * @param source the exact location of the source in the x, y plane
+ * @param destination the exact location of the destination in the x, y plane
+ * @param sourceRoads the road segments the lead out of the source
+ * @param destinationRoads the road segments that lead into the destination
+ * @param G the Weighted Directed Graph
+ * @param path the path that is found
+ */
+void Car::findPath(Point2D &source, Point2D &destination, vector<RoadSegment*> &sourceRoads, vector<RoadSegment*> &destinationRoads, WeightedDigraph *G, ShortestPath &path) {
+    // the search inputs are only needed while routing, so they are kept per thread instead of per car
+    static thread_local vector<int> sourceIntersections, destinationIntersections;
+    static thread_local vector<double> initialTime, excessTime;
+    sourceIntersections.clear();
+    initialTime.clear();
+    destinationIntersections.clear();
+    excessTime.clear();
+    for (RoadSegment *r : sourceRoads) {
+        sourceIntersections.push_back(r->getDestination()->getID());
+        initialTime.push_back(r->getDestination()->getLocation().distanceTo(source) / r->getLength() * r->getExpectedTime());
+    }
+    for (RoadSegment *r : destinationRoads) {
+        destinationIntersections.push_back(r->getSource()->getID());
+        excessTime.push_back(r->getSource()->getLocation().distanceTo(destination) / r->getLength() * r->getExpectedTime());
+    }
+    G->getRouter()->route(sourceIntersections, initialTime, destinationIntersections, excessTime, path);
+}
+
+/**
+ * Initializes a car given the starting and ending point and the path found for it by findPath(), and adds it to its
+ * source road.
+ * @param source the exact location of the source in the x, y plane
+ * @param destination the exact location of the destination in the x, y plane
+ * @param sourceRoads the road segments the lead out of the source
+ * @param destinationRoads the road segments that lead into the destination
+ * @param search the path of the car
+ * @param currentTime the current time in the simulation
+ */
+void Car::init(Point2D &source, Point2D &destination, vector<RoadSegment*> &sourceRoads, vector<RoadSegment*> &destinationRoads, const ShortestPath &search, double currentTime) {
+    assert(route == -1 && "car is already in use");
     this->source = source;
     this->destination = destination;
-    this->sourceRoads = sourceRoads;
-    this->destinationRoads = destinationRoads;
     this->expectedTime = 0.0;
+    currentRoad = nullptr;
+    slot = -1;
     id = counter++;
+    static thread_local vector<RoadSegment*> roads;
     for (RoadSegment *r : sourceRoads) {
         assert(r->getCapacity() - r->getFlow() >= 1);
-        sourceIntersections.push_back(r->getDestination()->getID());
-        initialTime.push_back(r->getDestination()->getLocation().distanceTo(this->source) / r->getLength() * r->getExpectedTime());
-    }
-    for (RoadSegment *r : destinationRoads) {
-        destinationIntersections.push_back(r->getSource()->getID());
-        excessTime.push_back(r->getSource()->getLocation().distanceTo(this->destination) / r->getLength() * r->getExpectedTime());
     }
-    path = new DijkstraDirectedSP(G, sourceIntersections, initialTime, destinationIntersections, excessTime);
-    assert(path->hasPath() && "there is no path for the car to reach the destination from the source");
-    for (RoadSegment *r : path->getShortestPath()) {
+    assert(search.exists() && "there is no path for the car to reach the destination from the source");
+    for (RoadSegment *r : search.roads) {
         expectedTime += r->getExpectedTime();
     }
     currentLocation = this->source;
+    RoadSegment *sourceRoad = nullptr;
     for (RoadSegment *r : sourceRoads) {
-        if (r->getDestination()->getID() == path->getSourceID()) {
-            currentRoad = r;
-            expectedTime += currentRoad->getDestination()->getLocation().distanceTo(source) / currentRoad->getSpeedLimit();
+        if (r->getDestination()->getID() == search.sourceID) {
+            sourceRoad = r;
+            expectedTime += sourceRoad->getDestination()->getLocation().distanceTo(source) / sourceRoad->getSpeedLimit();
             break;
         }
     }
-    assert(currentRoad != nullptr);
+    assert(sourceRoad != nullptr);
+    RoadSegment *finalRoad = nullptr;
     for (RoadSegment *r : destinationRoads) {
-        if (r->getSource()->getID() == path->getDestinationID()) {
+        if (r->getSource()->getID() == search.destinationID) {
             finalRoad = r;
             expectedTime += finalRoad->getSource()->getLocation().distanceTo(destination) / finalRoad->getSpeedLimit();
             break;
         }
     }
     assert(finalRoad != nullptr);
-    pathIndex = -1;
-    currentRoad->addIncoming(this);
-    assert(currentRoad->addCar(this));
+    roads.clear();
+    roads.push_back(sourceRoad);
+    roads.insert(roads.end(), search.roads.begin(), search.roads.end());
+    roads.push_back(finalRoad);
+    route = routes.intern(roads);
+    path = &routes.getRoute(route);
+    lights = &routes.getLights(route);
+    pathIndex = 0;
+    sourceRoad->addIncoming(this);
+    bool added = sourceRoad->addCar(this);
+    assert(added && "car could not be added to the source road");
     this->startTime = currentTime;
+    routeTime = currentTime;
+}
+
+/**
+ * Replaces the rest of the path of the car after the road it is on. The new path goes from the end of the current
+ * road to the start of the final road, which does not change. The expected time of the journey is not changed, so
+ * the efficiency of the car still compares against its original path.
+ * @param search the path from the destination of the current road to the source of the final road
+ * @param currentTime the current time in the simulation
+ */
+void Car::reroute(const ShortestPath &search, double currentTime) {
+    assert(currentRoad != nullptr && hasNextRoad() && "car does not have a path to change");
+    assert(search.exists() && search.sourceID == currentRoad->getDestination()->getID()
+           && search.destinationID == getFinalRoad()->getSource()->getID() && "path does not join the current and final roads");
+    static thread_local vector<RoadSegment*> roads;
+    roads.assign(path->begin(), path->begin() + pathIndex + 1);
+    roads.insert(roads.end(), search.roads.begin(), search.roads.end());
+    roads.push_back(getFinalRoad());
+    peekNextRoad()->removeIncoming(this);
+    int previous = route;
+    route = routes.intern(roads); // interned before the old route is released, in case they share roads
+    routes.release(previous);
+    path = &routes.getRoute(route);
+    lights = &routes.getLights(route);
+    peekNextRoad()->addIncoming(this);
+    routeTime = currentTime;
+}
+
+/**
+ * Releases the route of the car from the route table. Called when the car is returned to the pool.
+ */
+void Car::releaseRoute() {
+    assert(route != -1 && "car does not have a route");
+    routes.release(route);
+    route = -1;
+    path = nullptr;
+    lights = nullptr;
 }
 
 /**
@@ -83,12 +186,17 @@ double Car::getExpectedTime() const { return expectedTime; }
 /**
  * Returns the car's current speed.
  */
-double Car::getCurrentSpeed() const { return currentSpeed; }
+double Car::getCurrentSpeed() const {
+    return currentRoad != nullptr ? currentRoad->getCars().getSpeed(slot) : currentSpeed;
+}
 
 /**
  * Sets the car's speed.
  */
-void Car::setSpeed(double speed) { currentSpeed = speed; }
+void Car::setSpeed(double speed) {
+    if (currentRoad != nullptr) currentRoad->getCars().setSpeed(slot, speed);
+    else currentSpeed = speed;
+}
 
 /**
  * Returns the road the car is currently on.
@@ -98,13 +206,13 @@ RoadSegment *Car::getCurrentRoad() const { return currentRoad; }
 /**
  * Returns the final road the car will travel on.
  */
-RoadSegment *Car::getFinalRoad() const { return finalRoad; }
+RoadSegment *Car::getFinalRoad() const { return path->back(); }
 
 /**
  * Returns true if the car has another road on its path, false otherwise.
  */
 bool Car::hasNextRoad() const {
-    return pathIndex + 1 <= path->getShortestPath().size();
+    return pathIndex + 1 < (int) path->size();
 }
 
 /**
@@ -122,23 +230,67 @@ RoadSegment *Car::getNextRoad() {
  */
 RoadSegment *Car::peekNextRoad() const {
     assert(hasNextRoad() && "car does not have another road on its path");
-    return pathIndex + 1 < path->getShortestPath().size() ? path->getShortestPath()[pathIndex + 1] : finalRoad;
+    return (*path)[pathIndex + 1];
 }
 
+/**
+ * Returns the traffic light that lets the car from the road it is on onto the next road on its path.
+ */
+TrafficLight *Car::peekNextLight() const {
+    assert(hasNextRoad() && "car does not have another road on its path");
+    assert((*lights)[pathIndex] != nullptr && "the path of the car goes through a road segment that was removed");
+    return (*lights)[pathIndex];
+}
+
+/**
+ * Returns the roads the car travels on, from the road it started on to the road its destination is on.
+ */
+const vector<RoadSegment*> &Car::getPath() const { return *path; }
+
+/**
+ * Returns the index of the road the car is on in its path.
+ */
+int Car::getPathIndex() const { return pathIndex; }
+
+/**
+ * Returns the time the path of the car was last found or checked.
+ */
+double Car::getRouteTime() const { return routeTime; }
+
+/**
+ * Sets the time the path of the car was last found or checked.
+ */
+void Car::setRouteTime(double routeTime) { this->routeTime = routeTime; }
+
 /**
  * Sets the road the car is on.
  */
 void Car::setRoad(RoadSegment *road) { currentRoad = road; }
 
+/**
+ * Returns the slot of the car in the car store of the road it is on.
+ */
+int Car::getSlot() const { return slot; }
+
+/**
+ * Sets the slot of the car in the car store of the road it is on.
+ */
+void Car::setSlot(int slot) { this->slot = slot; }
+
 /**
  * Returns the car's current location.
  */
-Point2D Car::getCurrentLocation() const { return currentLocation; }
+Point2D Car::getCurrentLocation() const {
+    return currentRoad != nullptr ? currentRoad->getPointAt(currentRoad->getCars().getOffset(slot)) : currentLocation;
+}
 
 /**
  * Sets the car's location.
  */
-void Car::setLocation(Point2D &location) { currentLocation = location; }
+void Car::setLocation(Point2D &location) {
+    if (currentRoad != nullptr) currentRoad->getCars().setOffset(slot, currentRoad->getOffsetOf(location));
+    else currentLocation = location;
+}
 
 /**
  * Returns the car's source location.
@@ -151,11 +303,19 @@ Point2D Car::getSource() const { return source; }
 Point2D Car::getDestination() const { return destination; }
 
 /**
- * Deconstructs the Car and updates the efficiency
+ * Returns the handle that refers to the car in the pool.
  */
-Car::~Car() {
-    delete path;
-}
+CarHandle Car::getHandle() const { return handle; }
+
+/**
+ * Sets the handle that refers to the car in the pool.
+ */
+void Car::setHandle(const CarHandle &handle) { this->handle = handle; }
+
+/**
+ * Deconstructs the Car.
+ */
+Car::~Car() {}
 
 /**
  * Updates the efficiency of the car.
@@ -172,6 +332,16 @@ void Car::updateEfficiency(double endTime) {
  */
 double Car::getEfficiency() { return efficiency; }
 
+/**
+ * Returns the number of cars that have been created.
+ */
+int Car::countCreated() { return counter; }
+
+/**
+ * Returns the number of cars that have reached their destination.
+ */
+int Car::countReached() { return reached; }
+
 /**
  * Returns a random road segment in the graph.
  */
@@ -190,11 +360,7 @@ RoadSegment *getRandomRoadSegment(WeightedDigraph *G) {
  */
 Point2D getRandomLocation(RoadSegment *r) {
     double randDist = r->getLength() * Car::distribution(Car::generator);
-    Point2D srcLoc = r->getSource()->getLocation(), destLoc = r->getDestination()->getLocation();
-    double angle = srcLoc.angleTo(destLoc);
-    double dx = randDist * cos(angle);
-    double dy = randDist * sin(angle);
-    return Point2D(srcLoc.x + dx, srcLoc.y + dy);
+    return r->getPointAt(randDist);
 }
 
 /**
@@ -207,10 +373,12 @@ Car *getRandomCar(WeightedDigraph *G, double currentTime) {
     do {
         dest = getRandomRoadSegment(G);
     } while (src->getID() == dest->getID() || src->getDestination()->getID() == dest->getSource()->getID() || src->getSource()->getID() == dest->getDestination()->getID());
-    vector<RoadSegment*> sourceRoads, destinationRoads;
-    sourceRoads.push_back(src);
-    destinationRoads.push_back(dest);
+    static thread_local vector<RoadSegment*> sourceRoads, destinationRoads; // reused so that spawning does not allocate
+    sourceRoads.assign(1, src);
+    destinationRoads.assign(1, dest);
     Point2D srcLoc = getRandomLocation(src);
     Point2D destLoc = getRandomLocation(dest);
-    return new Car(srcLoc, destLoc, sourceRoads, destinationRoads, currentTime, G);
+    Car *c = Car::pool.acquire();
+    c->init(srcLoc, destLoc, sourceRoads, destinationRoads, currentTime, G);
+    return c;
 }
@@ -9,6 +9,9 @@
 #include "Intersection.h"
 #include "WeightedDigraph.h"
 #include "DijkstraDirectedSP.h"
+#include "Router.h"
+#include "CarPool.h"
+#include "RouteTable.h"
 
 struct RoadSegment; // forward declaration
 struct Intersection; // foward declaration
@@ -20,29 +23,36 @@ private:
     static int reached; // number of cars that have reached the destination
     int id; // each car has a unique id number
     double expectedTime; // the expected time for the car to complete its journey
-    double currentSpeed; // the car's curent speed
-    Point2D currentLocation; // the car's current location
+    double currentSpeed; // the car's curent speed, while it is not on a road
+    Point2D currentLocation; // the car's current location, while it is not on a road
     RoadSegment *currentRoad; // the road the car is currently on
-    RoadSegment *finalRoad; // the final road the car will travel on
+    int slot; // the slot of the car in the car store of the current road
     Point2D source; // the x y location of the source
     Point2D destination; // the x y location of the destination
-    std::vector<RoadSegment*> sourceRoads; // possible roads the that lead directly out from the source
-    std::vector<RoadSegment*> destinationRoads; // possible roads that lead directly into the destination
-    std::vector<int> sourceIntersections; // IDs of possible source intersections
-    std::vector<int> destinationIntersections; // IDs of possible destination intersections
-    std::vector<double> initialTime; // the initial time to reach of the possible source intersections
-    std::vector<double> excessTime; // the extra time to reach the destination from the possible destination interesctions
-    DijkstraDirectedSP *path; // the path that the car will take
+    int route; // the ID of the route the car takes in the route table, -1 if the car is not in use
+    const std::vector<RoadSegment*> *path; // the roads the car travels on, shared with cars on the same route
+    const std::vector<TrafficLight*> *lights; // the light at the end of each road on the path, shared with cars on the same route
     int pathIndex; // the current index on the path that the car is on
+    double routeTime; // the time the path of the car was last found or checked
+    CarHandle handle; // refers to the car in the pool
 
 public:
-    Car(Point2D &source, Point2D &destination, std::vector<RoadSegment*> &sourceRoads, std::vector<RoadSegment*> &destinationRoads, double currentTime, WeightedDigraph *G);
+    static CarPool pool; // the pool that every car is allocated from
+    static RouteTable routes; // the routes of all the cars
+    Car();
     ~Car();
+    void init(Point2D &source, Point2D &destination, std::vector<RoadSegment*> &sourceRoads, std::vector<RoadSegment*> &destinationRoads, double currentTime, WeightedDigraph *G);
+    void init(Point2D &source, Point2D &destination, std::vector<RoadSegment*> &sourceRoads, std::vector<RoadSegment*> &destinationRoads, const ShortestPath &search, double currentTime);
+    static void findPath(Point2D &source, Point2D &destination, std::vector<RoadSegment*> &sourceRoads, std::vector<RoadSegment*> &destinationRoads, WeightedDigraph *G, ShortestPath &path);
+    void releaseRoute();
+    void reroute(const ShortestPath &search, double currentTime);
     static std::mt19937 generator;
     static std::uniform_real_distribution<double> distribution;
     double startTime; // the starting time on the road's journey
     void updateEfficiency(double endTime);
     static double getEfficiency();
+    static int countCreated();
+    static int countReached();
     int getID() const;
     double getElapsedTime(double currentTime) const;
     double getExpectedTime() const;
@@ -53,7 +63,16 @@ public:
     bool hasNextRoad() const;
     RoadSegment *getNextRoad();
     RoadSegment *peekNextRoad() const;
+    TrafficLight *peekNextLight() const;
+    const std::vector<RoadSegment*> &getPath() const;
+    int getPathIndex() const;
+    double getRouteTime() const;
+    void setRouteTime(double routeTime);
     void setRoad(RoadSegment *road);
+    int getSlot() const;
+    void setSlot(int slot);
+    CarHandle getHandle() const;
+    void setHandle(const CarHandle &handle);
     Point2D getCurrentLocation() const;
     void setLocation(Point2D &location);
     Point2D getSource() const;
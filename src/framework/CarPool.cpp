@@ -0,0 +1,89 @@
+#include <assert.h>
+#include "CarPool.h"
+#include "Car.h"
+
+using namespace std;
+
+/**
+ * Returns true if both handles refer to the same use of the same car, false otherwise.
+ */
+bool CarHandle::operator == (const CarHandle &h) const { return index == h.index && generation == h.generation; }
+
+/**
+ * Returns true if the handles refer to different cars or different uses of the same car, false otherwise.
+ */
+bool CarHandle::operator != (const CarHandle &h) const { return !(*this == h); }
+
+/**
+ * Initializes an empty car pool.
+ */
+CarPool::CarPool() {
+    inUse = 0;
+}
+
+/**
+ * Deconstructs the car pool and frees every slab.
+ */
+CarPool::~CarPool() {
+    for (Car *slab : slabs) delete[] slab;
+}
+
+/**
+ * Returns a car that is not in use, allocating a new slab if there are none.
+ * The car must be initialized before it is used.
+ */
+Car *CarPool::acquire() {
+    if (freeIndices.empty()) {
+        int start = (int) slabs.size() * CAR_POOL_SLAB_SIZE;
+        slabs.push_back(new Car[CAR_POOL_SLAB_SIZE]);
+        generations.resize(start + CAR_POOL_SLAB_SIZE, 0);
+        for (int i = start + CAR_POOL_SLAB_SIZE - 1; i >= start; i--) {
+            freeIndices.push_back(i); // the lowest indices are used first
+        }
+    }
+    int index = freeIndices.back();
+    freeIndices.pop_back();
+    inUse++;
+    Car *c = &slabs[index / CAR_POOL_SLAB_SIZE][index % CAR_POOL_SLAB_SIZE];
+    c->setHandle({index, generations[index]});
+    return c;
+}
+
+/**
+ * Returns a car to the pool. Every handle to the car becomes stale.
+ * @param c the pointer to the car (must not be on a road)
+ */
+void CarPool::release(Car *c) {
+    CarHandle h = c->getHandle();
+    assert(isValid(h) && get(h) == c && "car is not in use in this pool");
+    assert(c->getCurrentRoad() == nullptr && "car is still on a road");
+    c->releaseRoute();
+    generations[h.index]++;
+    freeIndices.push_back(h.index);
+    inUse--;
+}
+
+/**
+ * Returns the car a handle refers to, or nullptr if the handle is stale.
+ */
+Car *CarPool::get(const CarHandle &h) const {
+    if (!isValid(h)) return nullptr;
+    return &slabs[h.index / CAR_POOL_SLAB_SIZE][h.index % CAR_POOL_SLAB_SIZE];
+}
+
+/**
+ * Returns true if the car a handle refers to has not been released since the handle was made, false otherwise.
+ */
+bool CarPool::isValid(const CarHandle &h) const {
+    return h.index >= 0 && h.index < (int) generations.size() && generations[h.index] == h.generation;
+}
+
+/**
+ * Returns the number of cars that are in use.
+ */
+int CarPool::size() const { return inUse; }
+
+/**
+ * Returns the number of cars that have been allocated.
+ */
+int CarPool::capacity() const { return (int) generations.size(); }
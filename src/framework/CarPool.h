@@ -0,0 +1,42 @@
+#ifndef CARPOOL_H_
+#define CARPOOL_H_
+
+#include <vector>
+#include "Forward.h"
+
+#define CAR_POOL_SLAB_SIZE 256 // the number of cars allocated at once when the pool runs out of free cars
+
+/**
+ * Refers to a car in the pool. A handle becomes stale once the car is released, even if its slot is reused.
+ */
+struct CarHandle {
+    int index; // the index of the car in the pool
+    int generation; // the number of times the car had been released when the handle was made
+
+    bool operator == (const CarHandle &h) const;
+    bool operator != (const CarHandle &h) const;
+};
+
+/**
+ * Allocates cars in slabs and recycles released cars, so that spawning and removing cars does not allocate memory
+ * once the pool has grown to the number of cars in the city. A recycled car keeps the capacity of its vectors.
+ */
+struct CarPool {
+private:
+    std::vector<Car*> slabs; // the arrays of cars that have been allocated
+    std::vector<int> generations; // the number of times the car at each index has been released
+    std::vector<int> freeIndices; // the indices of the cars that are not in use
+    int inUse; // the number of cars that are in use
+
+public:
+    CarPool();
+    ~CarPool();
+    Car *acquire();
+    void release(Car *c);
+    Car *get(const CarHandle &h) const;
+    bool isValid(const CarHandle &h) const;
+    int size() const;
+    int capacity() const;
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include <assert.h>
+#include "CarStore.h"
+#include "Car.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty car store.
+ */
+CarStore::CarStore() {
+    moving = 0;
+}
+
+/**
+ * Deconstructs the car store.
+ */
+CarStore::~CarStore() {}
+
+/**
+ * Copies the car in one slot to another slot and updates the slot of the car.
+ */
+void CarStore::copy(int from, int to) {
+    if (from == to) return;
+    cars[to] = cars[from];
+    offsets[to] = offsets[from];
+    speeds[to] = speeds[from];
+    destinations[to] = destinations[from];
+    cars[to]->setSlot(to);
+}
+
+/**
+ * Swaps the cars in two slots and updates the slots of the cars.
+ */
+void CarStore::swap(int i, int j) {
+    if (i == j) return;
+    std::swap(cars[i], cars[j]);
+    std::swap(offsets[i], offsets[j]);
+    std::swap(speeds[i], speeds[j]);
+    std::swap(destinations[i], destinations[j]);
+    cars[i]->setSlot(i);
+    cars[j]->setSlot(j);
+}
+
+/**
+ * Returns the number of cars in the store.
+ */
+int CarStore::size() const { return cars.size(); }
+
+/**
+ * Returns the number of moving cars, which are in the slots [0, countMoving()).
+ */
+int CarStore::countMoving() const { return moving; }
+
+/**
+ * Adds a moving car to the store and sets the slot of the car.
+ * @param c the pointer to the car
+ * @param offset the distance of the car from the source of the road
+ * @param speed the speed of the car
+ * @param destination the offset of the destination of the car, infinity if it is not on this road
+ * @return the slot of the car
+ */
+int CarStore::add(Car *c, double offset, double speed, double destination) {
+    cars.push_back(c);
+    offsets.push_back(offset);
+    speeds.push_back(speed);
+    destinations.push_back(destination);
+    c->setSlot(size() - 1);
+    swap(size() - 1, moving++); // keeps the moving cars before the stopped cars
+    return c->getSlot();
+}
+
+/**
+ * Removes the car in a slot. The slots of other cars may change.
+ * @param slot the slot of the car
+ */
+void CarStore::remove(int slot) {
+    assert(slot >= 0 && slot < size() && "there is no car in this slot");
+    if (slot < moving) {
+        moving--;
+        copy(moving, slot); // the last moving car fills the slot
+        copy(size() - 1, moving); // the last stopped car fills the slot of the last moving car
+    } else {
+        copy(size() - 1, slot);
+    }
+    cars.pop_back();
+    offsets.pop_back();
+    speeds.pop_back();
+    destinations.pop_back();
+}
+
+/**
+ * Marks the moving car in a slot as stopped. The slots of other cars may change.
+ * @param slot the slot of the car
+ */
+void CarStore::stop(int slot) {
+    assert(slot >= 0 && slot < moving && "there is no moving car in this slot");
+    swap(slot, --moving);
+}
+
+/**
+ * Returns true if the car in the slot is stopped, false otherwise.
+ */
+bool CarStore::isStopped(int slot) const { return slot >= moving; }
+
+/**
+ * Returns the pointer to the car in a slot.
+ */
+Car *CarStore::getCar(int slot) const { return cars[slot]; }
+
+/**
+ * Returns the distance of the car in a slot from the source of the road.
+ */
+double CarStore::getOffset(int slot) const { return offsets[slot]; }
+
+/**
+ * Sets the distance of the car in a slot from the source of the road.
+ */
+void CarStore::setOffset(int slot, double offset) { offsets[slot] = offset; }
+
+/**
+ * Returns the speed of the car in a slot.
+ */
+double CarStore::getSpeed(int slot) const { return speeds[slot]; }
+
+/**
+ * Sets the speed of the car in a slot.
+ */
+void CarStore::setSpeed(int slot, double speed) { speeds[slot] = speed; }
+
+/**
+ * Returns the offset of the destination of the car in a slot, or infinity if the destination is not on this road.
+ */
+double CarStore::getDestination(int slot) const { return destinations[slot]; }
+
+/**
+ * Returns the array of offsets of the cars.
+ */
+double *CarStore::getOffsets() { return offsets.data(); }
+
+/**
+ * Returns the array of speeds of the cars.
+ */
+const double *CarStore::getSpeeds() const { return speeds.data(); }
+
+/**
+ * Returns the array of destination offsets of the cars.
+ */
+const double *CarStore::getDestinations() const { return destinations.data(); }
@@ -0,0 +1,44 @@
+#ifndef CARSTORE_H_
+#define CARSTORE_H_
+
+#include <vector>
+#include "Forward.h"
+
+/**
+ * Stores the state of the cars on a road segment as a structure of arrays, so the state that is updated in every
+ * iteration is contiguous in memory. Moving cars are kept in the slots [0, countMoving()) and cars that are stopped
+ * in the waiting queue are kept in the slots [countMoving(), size()). Cars only move along the road, so a location
+ * is stored as the distance from the source of the road.
+ */
+struct CarStore {
+private:
+    std::vector<Car*> cars; // the car in each slot
+    std::vector<double> offsets; // the distance of each car from the source of the road
+    std::vector<double> speeds; // the speed of each car
+    std::vector<double> destinations; // the offset of the destination of each car, infinity if it is not on this road
+    int moving; // the number of moving cars
+
+    void copy(int from, int to);
+    void swap(int i, int j);
+
+public:
+    CarStore();
+    ~CarStore();
+    int size() const;
+    int countMoving() const;
+    int add(Car *c, double offset, double speed, double destination);
+    void remove(int slot);
+    void stop(int slot);
+    bool isStopped(int slot) const;
+    Car *getCar(int slot) const;
+    double getOffset(int slot) const;
+    void setOffset(int slot, double offset);
+    double getSpeed(int slot) const;
+    void setSpeed(int slot, double speed);
+    double getDestination(int slot) const;
+    double *getOffsets();
+    const double *getSpeeds() const;
+    const double *getDestinations() const;
+};
+
+#endif
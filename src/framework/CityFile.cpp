@@ -0,0 +1,523 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <assert.h>
+#ifdef _WIN32
+#include <cstdlib>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "CityFile.h"
+#include "Intersection.h"
+#include "RoadSegment.h"
+#include "TrafficLight.h"
+#include "WeightedDigraph.h"
+#include "../misc/CarKernel.h"
+
+using namespace std;
+
+/**
+ * Initializes a CityFile with no file open.
+ */
+CityFile::CityFile() {
+    data = nullptr;
+    size = 0;
+    mapped = false;
+    header = nullptr;
+    intersections = nullptr;
+    roads = nullptr;
+    lights = nullptr;
+    links = nullptr;
+    masks = nullptr;
+    slots = nullptr;
+    turns = nullptr;
+}
+
+/**
+ * Deconstructs the CityFile and closes the open file.
+ */
+CityFile::~CityFile() {
+    close();
+}
+
+/**
+ * Returns true if the file is a binary city file, false otherwise.
+ * @param fileName the name of the file
+ */
+bool CityFile::isCityFile(string fileName) {
+    FILE *in = fopen(fileName.c_str(), "rb");
+    if (in == nullptr) return false;
+    char magic[8] = {};
+    bool read = fread(magic, 1, sizeof(magic), in) == sizeof(magic);
+    fclose(in);
+    return read && memcmp(magic, CITY_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+/**
+ * Reads a city in the text format of the data directory into an empty graph. The first line holds the number of
+ * intersections, road segments and cars, and the number of cars added per second, followed by the x and y
+ * coordinates of each intersection, and the source, destination, speed limit and capacity of each road segment.
+ * The traffic lights are not connected. If the file is not valid, the graph holds the part of the city read so far.
+ * @param fileName the name of the file
+ * @param G the Weighted Directed Graph
+ * @param created the intersections that are created, in the order of the file
+ * @param cars the number of cars to add at the start of the simulation
+ * @param carsPerSecond the number of cars added per second
+ * @param error set to the reason the file could not be read
+ * @return true if the city was read, false if the file could not be opened or is not valid
+ */
+bool CityFile::readText(string fileName, WeightedDigraph *G, vector<Intersection*> &created, int &cars, int &carsPerSecond, string &error) {
+    FILE *in = fopen(fileName.c_str(), "r");
+    if (in == nullptr) {
+        error = "unable to open file";
+        return false;
+    }
+    auto fail = [&] (const char *reason) {
+        fclose(in);
+        error = reason;
+        return false;
+    };
+    int cntIntersections;
+    int cntRoadSegments;
+    if (fscanf(in, "%d %d %d %d", &cntIntersections, &cntRoadSegments, &cars, &carsPerSecond) != 4) return fail("missing counts");
+    if (cntIntersections < 0 || cntRoadSegments < 0 || cars < 0 || carsPerSecond < 0) return fail("negative count");
+    G->reserve(G->countIntersections() + cntIntersections, G->countRoadSegments() + cntRoadSegments);
+    created.clear();
+    created.reserve(cntIntersections);
+    for (int i = 0; i < cntIntersections; i++) {
+        double x;
+        double y;
+        if (fscanf(in, "%lf %lf", &x, &y) != 2) return fail("missing intersection");
+        created.push_back(new Intersection(x, y));
+    }
+    for (int i = 0; i < cntRoadSegments; i++) {
+        int A;
+        int B;
+        double speedLimit;
+        int capacity;
+        if (fscanf(in, "%d %d %lf %d", &A, &B, &speedLimit, &capacity) != 4) return fail("missing road segment");
+        if (A < 0 || A >= cntIntersections || B < 0 || B >= cntIntersections) return fail("road segment refers to a missing intersection");
+        if (!(speedLimit > 0.0) || capacity < 0) return fail("road segment has an invalid speed limit or capacity");
+        bool added = G->addRoadSegment(new RoadSegment(created[A], created[B], speedLimit, capacity));
+        assert(added && "road segment is already in the city");
+    }
+    fclose(in);
+    return true;
+}
+
+/**
+ * Writes a city to a binary city file. The traffic lights must already be connected and linked, and are written in
+ * the order they were created, so that loading the file creates them with the same IDs. The phase table of each
+ * intersection is compiled if it is out of date and written with it.
+ * @param fileName the name of the file
+ * @param G the Weighted Directed Graph
+ * @param intersections the intersections of the city in the order they are written
+ * @param cars the number of cars to add at the start of the simulation
+ * @param carsPerSecond the number of cars added per second
+ */
+void CityFile::write(string fileName, WeightedDigraph *G, const vector<Intersection*> &intersections, int cars, int carsPerSecond) {
+    unordered_map<int, int> intersectionIndex;
+    for (int i = 0; i < (int) intersections.size(); i++) {
+        intersectionIndex[intersections[i]->getID()] = i;
+    }
+    vector<RoadSegment*> roadList;
+    for (pair<int, RoadSegment*> r : G->getRoadSegments()) {
+        roadList.push_back(r.second);
+    }
+    sort(roadList.begin(), roadList.end(), [] (RoadSegment *a, RoadSegment *b) { return a->getID() < b->getID(); });
+    unordered_map<int, int> roadIndex;
+    for (int i = 0; i < (int) roadList.size(); i++) {
+        roadIndex[roadList[i]->getID()] = i;
+    }
+    vector<pair<TrafficLight*, Intersection*>> lightList;
+    for (Intersection *intxn : intersections) {
+        for (pair<int, TrafficLight*> t : intxn->getTrafficLights()) {
+            lightList.push_back(make_pair(t.second, intxn));
+        }
+    }
+    sort(lightList.begin(), lightList.end(), [] (const pair<TrafficLight*, Intersection*> &a, const pair<TrafficLight*, Intersection*> &b) {
+        return a.first->getID() < b.first->getID();
+    });
+    unordered_map<int, int> lightIndex;
+    for (int i = 0; i < (int) lightList.size(); i++) {
+        lightIndex[lightList[i].first->getID()] = i;
+    }
+    vector<CityFileLink> linkList;
+    vector<pair<int, int>> intersectionLinks;
+    for (Intersection *intxn : intersections) {
+        intxn->getLinks(intersectionLinks);
+        for (pair<int, int> l : intersectionLinks) {
+            linkList.push_back({lightIndex[l.first], lightIndex[l.second]});
+        }
+    }
+    vector<CityFileIntersection> intersectionList;
+    vector<uint64_t> maskList;
+    vector<int32_t> slotList;
+    vector<int32_t> turnList;
+    vector<RoadSegment*> entering, leaving;
+    vector<TrafficLight*> turnLights;
+    vector<uint64_t> phaseMasks;
+    for (Intersection *intxn : intersections) {
+        intxn->getPhaseTable(entering, leaving, turnLights, phaseMasks);
+        CityFileIntersection record;
+        record.x = intxn->getLocation().x;
+        record.y = intxn->getLocation().y;
+        record.cycles = intxn->countCycles();
+        record.entries = entering.size();
+        record.exits = leaving.size();
+        record.firstSlot = slotList.size();
+        record.firstTurn = turnList.size();
+        record.firstMask = maskList.size();
+        intersectionList.push_back(record);
+        for (RoadSegment *r : entering) slotList.push_back(roadIndex[r->getID()]);
+        for (RoadSegment *r : leaving) slotList.push_back(roadIndex[r->getID()]);
+        for (TrafficLight *t : turnLights) turnList.push_back(t != nullptr ? lightIndex[t->getID()] : -1);
+        maskList.insert(maskList.end(), phaseMasks.begin(), phaseMasks.end());
+    }
+    assert(slotList.size() == 2 * roadList.size() && "every intersection of a road segment must be written");
+    CityFileHeader header = {};
+    memcpy(header.magic, CITY_FILE_MAGIC, sizeof(header.magic));
+    header.version = CITY_FILE_VERSION;
+    header.intersections = intersections.size();
+    header.roads = roadList.size();
+    header.lights = lightList.size();
+    header.links = linkList.size();
+    header.masks = maskList.size();
+    header.turns = turnList.size();
+    header.cars = cars;
+    header.carsPerSecond = carsPerSecond;
+    FILE *out = fopen(fileName.c_str(), "wb");
+    assert(out != nullptr && "unable to open file");
+    fwrite(&header, sizeof(header), 1, out);
+    if (!intersectionList.empty()) fwrite(intersectionList.data(), sizeof(CityFileIntersection), intersectionList.size(), out);
+    for (RoadSegment *r : roadList) {
+        CityFileRoad record = {};
+        assert(intersectionIndex.count(r->getSource()->getID()) && intersectionIndex.count(r->getDestination()->getID())
+               && "every intersection of a road segment must be written");
+        record.source = intersectionIndex[r->getSource()->getID()];
+        record.destination = intersectionIndex[r->getDestination()->getID()];
+        record.speedLimit = r->getSpeedLimit();
+        record.capacity = r->getCapacity();
+        fwrite(&record, sizeof(record), 1, out);
+    }
+    for (pair<TrafficLight*, Intersection*> t : lightList) {
+        CityFileLight record;
+        record.from = roadIndex[t.first->getFrom()->getID()];
+        record.to = roadIndex[t.first->getTo()->getID()];
+        record.type = t.first->getType();
+        record.cycle = t.second->getCycleNumber(t.first->getID());
+        fwrite(&record, sizeof(record), 1, out);
+    }
+    if (!linkList.empty()) fwrite(linkList.data(), sizeof(CityFileLink), linkList.size(), out);
+    if (!maskList.empty()) fwrite(maskList.data(), sizeof(uint64_t), maskList.size(), out);
+    if (!slotList.empty()) fwrite(slotList.data(), sizeof(int32_t), slotList.size(), out);
+    if (!turnList.empty()) fwrite(turnList.data(), sizeof(int32_t), turnList.size(), out);
+    fclose(out);
+}
+
+/**
+ * Closes the file that is being opened and records why it could not be opened.
+ * @param reason the reason the file could not be opened
+ * @return false
+ */
+bool CityFile::fail(string reason) {
+    close();
+    error = reason;
+    return false;
+}
+
+/**
+ * Opens a binary city file, closing the file that was open. The file is mapped into memory where it is supported,
+ * and read into memory otherwise.
+ * @param fileName the name of the file
+ * @return true if the file was opened, false if it could not be read or is not a valid city file (see getError())
+ */
+bool CityFile::open(string fileName) {
+    close();
+    error.clear();
+#ifdef _WIN32
+    FILE *in = fopen(fileName.c_str(), "rb");
+    if (in == nullptr) return fail("unable to open file");
+    long length = fseek(in, 0, SEEK_END) == 0 ? ftell(in) : -1;
+    if (length < 0 || fseek(in, 0, SEEK_SET) != 0) {
+        fclose(in);
+        return fail("unable to read file");
+    }
+    size = length;
+    char *buffer = (char*) malloc(max(size, (size_t) 1));
+    size_t read = buffer != nullptr ? fread(buffer, 1, size, in) : 0;
+    fclose(in);
+    if (buffer == nullptr) return fail("unable to read file");
+    data = buffer;
+    mapped = false;
+    if (read != size) return fail("unable to read file");
+#else
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd == -1) return fail("unable to open file");
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return fail("unable to read file");
+    }
+    size = st.st_size;
+    if (size < sizeof(CityFileHeader)) {
+        ::close(fd);
+        return fail("file is too small to be a city file");
+    }
+    void *contents = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping stays valid after the file is closed
+    if (contents == MAP_FAILED) return fail("unable to map file");
+    data = (const char*) contents;
+    mapped = true;
+#endif
+    return check();
+}
+
+/**
+ * Checks the header and every record of the file being opened, and finds the sections.
+ * @return true if the file is a valid city file, false otherwise
+ */
+bool CityFile::check() {
+    if (size < sizeof(CityFileHeader)) return fail("file is too small to be a city file");
+    header = (const CityFileHeader*) data;
+    if (memcmp(header->magic, CITY_FILE_MAGIC, sizeof(header->magic)) != 0) return fail("file is not a city file");
+    if (header->version != CITY_FILE_VERSION) return fail("unsupported city file version");
+    if (header->intersections < 0 || header->roads < 0 || header->lights < 0 || header->links < 0 || header->masks < 0 || header->turns < 0) {
+        return fail("city file has a negative count");
+    }
+    // the counts are at most 2^31, so the expected size cannot overflow
+    unsigned long long expected = sizeof(CityFileHeader)
+            + (unsigned long long) header->intersections * sizeof(CityFileIntersection)
+            + (unsigned long long) header->roads * sizeof(CityFileRoad)
+            + (unsigned long long) header->lights * sizeof(CityFileLight)
+            + (unsigned long long) header->links * sizeof(CityFileLink)
+            + (unsigned long long) header->masks * sizeof(uint64_t)
+            + (unsigned long long) header->roads * 2 * sizeof(int32_t)
+            + (unsigned long long) header->turns * sizeof(int32_t);
+    if (expected != size) return fail("city file has the wrong size");
+    intersections = (const CityFileIntersection*) (header + 1);
+    roads = (const CityFileRoad*) (intersections + header->intersections);
+    lights = (const CityFileLight*) (roads + header->roads);
+    links = (const CityFileLink*) (lights + header->lights);
+    masks = (const uint64_t*) (links + header->links);
+    slots = (const int32_t*) (masks + header->masks);
+    turns = slots + 2 * header->roads;
+    long long slotCount = 0, turnCount = 0, maskCount = 0;
+    for (int i = 0; i < header->intersections; i++) {
+        const CityFileIntersection &v = intersections[i];
+        if (!isfinite(v.x) || !isfinite(v.y)) return fail("intersection has an invalid location");
+        if (v.cycles < 0 || v.entries < 0 || v.exits < 0) return fail("intersection has a negative count");
+        if (v.firstSlot != slotCount || v.firstTurn != turnCount || v.firstMask != maskCount) {
+            return fail("intersection has a phase table out of place");
+        }
+        long long bits = (long long) v.entries * v.exits;
+        slotCount += (long long) v.entries + v.exits;
+        turnCount += bits;
+        if (slotCount > 2LL * header->roads || turnCount > header->turns) return fail("intersection has a phase table out of place");
+        // bits is now at most 2^31, so the number of mask words cannot overflow
+        maskCount += (bits + MASK_BITS - 1) / MASK_BITS * (1 + 2 * (long long) v.cycles);
+        if (maskCount > header->masks) return fail("intersection has a phase table out of place");
+    }
+    if (slotCount != 2LL * header->roads || turnCount != header->turns || maskCount != header->masks) {
+        return fail("phase tables do not fill their sections");
+    }
+    for (int i = 0; i < header->roads; i++) {
+        const CityFileRoad &r = roads[i];
+        if (r.source < 0 || r.source >= header->intersections || r.destination < 0 || r.destination >= header->intersections) {
+            return fail("road segment refers to a missing intersection");
+        }
+        if (!(r.speedLimit > 0.0) || r.capacity < 0) return fail("road segment has an invalid speed limit or capacity");
+    }
+    vector<int> entrySlot(header->roads, -1), exitSlot(header->roads, -1);
+    for (int i = 0; i < header->intersections; i++) {
+        const CityFileIntersection &v = intersections[i];
+        for (int k = 0; k < v.entries + v.exits; k++) {
+            int r = slots[v.firstSlot + k];
+            if (r < 0 || r >= header->roads) return fail("phase table refers to a missing road segment");
+            bool entering = k < v.entries;
+            if ((entering ? roads[r].destination : roads[r].source) != i || (entering ? entrySlot[r] : exitSlot[r]) != -1) {
+                return fail("phase table has a road segment in the wrong slot");
+            }
+            if (entering) entrySlot[r] = k;
+            else exitSlot[r] = k - v.entries;
+        }
+    }
+    vector<int> straights(header->intersections, 0); // the number of straight lights in each intersection
+    for (int i = 0; i < header->lights; i++) {
+        const CityFileLight &t = lights[i];
+        if (t.from < 0 || t.from >= header->roads || t.to < 0 || t.to >= header->roads) {
+            return fail("traffic light refers to a missing road segment");
+        }
+        if (roads[t.from].destination != roads[t.to].source) return fail("traffic light joins road segments that do not meet");
+        if (t.type < LEFT || t.type > UTURN) return fail("traffic light has an invalid type");
+        int v = roads[t.from].destination;
+        if (t.type == STRAIGHT ? t.cycle < 0 || t.cycle >= intersections[v].cycles : t.cycle != -1) {
+            return fail("traffic light has an invalid cycle");
+        }
+        if (t.type == STRAIGHT) straights[v]++;
+    }
+    for (int i = 0; i < header->intersections; i++) {
+        // every cycle has at least one straight light
+        if (intersections[i].cycles > straights[i]) return fail("intersection has more cycles than straight lights");
+    }
+    for (int i = 0; i < header->links; i++) {
+        const CityFileLink &l = links[i];
+        if (l.a < 0 || l.a >= header->lights || l.b < 0 || l.b >= header->lights) return fail("link refers to a missing traffic light");
+        if (roads[lights[l.a].from].destination != roads[lights[l.b].from].destination || lights[l.a].type != STRAIGHT) {
+            return fail("link joins traffic lights that cannot be linked");
+        }
+    }
+    // every light has the turn of its road segments, and the masks are the ones the intersection compiles from the
+    // lights, links and cycles, except for the green mask, which may hold any of the lights
+    vector<int> lightBit(header->lights, -1);
+    for (int i = 0; i < header->intersections; i++) {
+        const CityFileIntersection &v = intersections[i];
+        for (int bit = 0; bit < v.entries * v.exits; bit++) {
+            int t = turns[v.firstTurn + bit];
+            if (t == -1) continue;
+            if (t < 0 || t >= header->lights) return fail("phase table refers to a missing traffic light");
+            if (roads[lights[t].from].destination != i || entrySlot[lights[t].from] != bit / v.exits
+                    || exitSlot[lights[t].to] != bit % v.exits || lightBit[t] != -1) {
+                return fail("phase table has a traffic light in the wrong turn");
+            }
+            lightBit[t] = bit;
+        }
+    }
+    vector<uint64_t> compiled(header->masks, 0);
+    auto set = [&] (int mask, int light) {
+        const CityFileIntersection &v = intersections[roads[lights[light].from].destination];
+        uint64_t &word = compiled[v.firstMask + (long long) mask * getMaskWords(v.entries * v.exits) + lightBit[light] / MASK_BITS];
+        word |= (uint64_t) 1 << (lightBit[light] % MASK_BITS);
+    };
+    for (int i = 0; i < header->lights; i++) {
+        if (lightBit[i] == -1) return fail("traffic light is missing from its phase table");
+        set(0, i);
+        if (lights[i].type == STRAIGHT) set(1 + 2 * lights[i].cycle, i);
+    }
+    for (int i = 0; i < header->links; i++) {
+        const CityFileLink &l = links[i];
+        if (lights[l.b].type == LEFT || lights[l.b].type == UTURN) set(2 + 2 * lights[l.a].cycle, l.b);
+    }
+    for (int i = 0; i < header->intersections; i++) {
+        const CityFileIntersection &v = intersections[i];
+        int words = getMaskWords(v.entries * v.exits);
+        for (int w = 0; w < words; w++) {
+            if (masks[v.firstMask + w] & ~compiled[v.firstMask + w]) return fail("green mask holds a missing traffic light");
+        }
+        for (int w = words; w < words * (1 + 2 * v.cycles); w++) {
+            if (masks[v.firstMask + w] != compiled[v.firstMask + w]) return fail("phase table does not match the traffic lights");
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the reason the last file could not be opened, empty if it was opened.
+ */
+const string &CityFile::getError() const { return error; }
+
+/**
+ * Closes the open file, if there is one.
+ */
+void CityFile::close() {
+    if (data == nullptr) return;
+#ifdef _WIN32
+    free((void*) data);
+#else
+    if (mapped) munmap((void*) data, size);
+#endif
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    intersections = nullptr;
+    roads = nullptr;
+    lights = nullptr;
+    links = nullptr;
+    masks = nullptr;
+    slots = nullptr;
+    turns = nullptr;
+}
+
+/**
+ * Adds the city in the open file to an empty graph. The traffic lights are connected, linked and assigned to their
+ * cycles as they were saved, so autoConnectAndLink() must not be called on the intersections. Each intersection
+ * adopts its phase table from the file, and builds the maps of its roads, lights, links and cycles when it is first
+ * changed or asked for them. The records were checked when the file was opened.
+ * @param G the Weighted Directed Graph
+ * @param created the intersections that are created, in the order of the file
+ */
+void CityFile::load(WeightedDigraph *G, vector<Intersection*> &created) const {
+    assert(data != nullptr && "no file is open");
+    G->reserve(G->countIntersections() + header->intersections, G->countRoadSegments() + header->roads);
+    created.resize(header->intersections);
+    for (int i = 0; i < header->intersections; i++) {
+        created[i] = new Intersection(intersections[i].x, intersections[i].y);
+    }
+    vector<RoadSegment*> roadList(header->roads);
+    for (int i = 0; i < header->roads; i++) {
+        const CityFileRoad &r = roads[i];
+        roadList[i] = new RoadSegment(created[r.source], created[r.destination], r.speedLimit, r.capacity);
+    }
+    vector<TrafficLight*> lightList(header->lights);
+    for (int i = 0; i < header->lights; i++) {
+        lightList[i] = new TrafficLight(roadList[lights[i].from], roadList[lights[i].to], lights[i].type);
+    }
+    vector<int> firstLink(header->intersections + 1, 0); // the links of intersection i are from firstLink[i] to firstLink[i + 1]
+    for (int i = 0; i < header->links; i++) {
+        firstLink[roads[lights[links[i].a].from].destination + 1]++;
+    }
+    for (int i = 0; i < header->intersections; i++) {
+        firstLink[i + 1] += firstLink[i];
+    }
+    vector<pair<int, int>> linkList(header->links);
+    vector<int> next(firstLink.begin(), firstLink.end() - 1);
+    for (int i = 0; i < header->links; i++) {
+        const CityFileLink &l = links[i];
+        linkList[next[roads[lights[l.a].from].destination]++] = make_pair(lightList[l.a]->getID(), lightList[l.b]->getID());
+    }
+    vector<RoadSegment*> entering, leaving;
+    vector<TrafficLight*> turnLights;
+    vector<uint64_t> phaseMasks;
+    vector<pair<int, int>> intersectionLinks;
+    for (int i = 0; i < header->intersections; i++) {
+        const CityFileIntersection &v = intersections[i];
+        entering.resize(v.entries);
+        for (int k = 0; k < v.entries; k++) entering[k] = roadList[slots[v.firstSlot + k]];
+        leaving.resize(v.exits);
+        for (int k = 0; k < v.exits; k++) leaving[k] = roadList[slots[v.firstSlot + v.entries + k]];
+        turnLights.resize(v.entries * v.exits);
+        for (int bit = 0; bit < v.entries * v.exits; bit++) {
+            int t = turns[v.firstTurn + bit];
+            turnLights[bit] = t != -1 ? lightList[t] : nullptr;
+        }
+        phaseMasks.assign(masks + v.firstMask, masks + v.firstMask + getMaskWords(v.entries * v.exits) * (1 + 2 * v.cycles));
+        intersectionLinks.assign(linkList.begin() + firstLink[i], linkList.begin() + firstLink[i + 1]);
+        created[i]->adopt(entering, leaving, turnLights, phaseMasks, v.cycles, intersectionLinks);
+    }
+    G->addAdoptedRoadSegments(roadList);
+}
+
+/**
+ * Returns the number of intersections in the open file.
+ */
+int CityFile::countIntersections() const { return header->intersections; }
+
+/**
+ * Returns the number of road segments in the open file.
+ */
+int CityFile::countRoadSegments() const { return header->roads; }
+
+/**
+ * Returns the number of cars to add at the start of the simulation.
+ */
+int CityFile::countCars() const { return header->cars; }
+
+/**
+ * Returns the number of cars added per second.
+ */
+int CityFile::getCarsPerSecond() const { return header->carsPerSecond; }
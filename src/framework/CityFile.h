@@ -0,0 +1,120 @@
+#ifndef CITYFILE_H_
+#define CITYFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Forward.h"
+
+#define CITY_FILE_MAGIC "TRAFFIX" // the first bytes of every binary city file, followed by a null character
+#define CITY_FILE_VERSION 2 // the version of the binary city format written by this build
+
+/**
+ * The header at the start of a binary city file. Every count is the number of records in the section of that name,
+ * and the sections follow the header in the order of the counts, except for the slot section, which has two records
+ * for each road segment and comes after the mask section.
+ */
+struct CityFileHeader {
+    char magic[8]; // CITY_FILE_MAGIC
+    int32_t version; // the version of the format
+    int32_t intersections; // the number of intersections
+    int32_t roads; // the number of road segments
+    int32_t lights; // the number of traffic lights
+    int32_t links; // the number of links between traffic lights
+    int32_t masks; // the number of 64 bit words in the masks of the phase tables
+    int32_t turns; // the number of pairs of entry and exit slots in the phase tables
+    int32_t cars; // the number of cars to add at the start of the simulation
+    int32_t carsPerSecond; // the number of cars added per second
+    int32_t reserved; // keeps the sections aligned to 8 bytes
+};
+
+/**
+ * An intersection in a binary city file, with where its phase table is in the slot, turn and mask sections.
+ */
+struct CityFileIntersection {
+    double x; // the x coordinate
+    double y; // the y coordinate
+    int32_t cycles; // the number of cycles of the traffic lights
+    int32_t entries; // the number of road segments entering the intersection
+    int32_t exits; // the number of road segments leaving the intersection
+    int32_t firstSlot; // the first slot, with the entering and then the leaving road segments in the order of their slots
+    int32_t firstTurn; // the first turn, with the light of each pair of entry and exit slots at entry * exits + exit
+    int32_t firstMask; // the first mask word, with the green mask and then the straight and left masks of each cycle
+};
+
+/**
+ * A road segment in a binary city file.
+ */
+struct CityFileRoad {
+    int32_t source; // the index of the intersection the road segment leaves
+    int32_t destination; // the index of the intersection the road segment enters
+    double speedLimit; // the speed limit
+    int32_t capacity; // the vehicle capacity
+    int32_t reserved; // keeps the records aligned to 8 bytes
+};
+
+/**
+ * A traffic light in a binary city file, in the intersection the from road segment enters. The lights are stored in
+ * the order they were created.
+ */
+struct CityFileLight {
+    int32_t from; // the index of the road segment leading into the intersection
+    int32_t to; // the index of the road segment leading out of the intersection
+    int32_t type; // the type of turn the light controls
+    int32_t cycle; // the cycle number of the light if it is straight, -1 otherwise
+};
+
+/**
+ * A link between two traffic lights of the same intersection in a binary city file.
+ */
+struct CityFileLink {
+    int32_t a; // the index of the straight light
+    int32_t b; // the index of the light linked to it
+};
+
+/**
+ * Reads and writes cities in a versioned binary format, which holds the intersections, the road segments, and the
+ * traffic lights with their links and cycles as they are after Intersection::autoConnectAndLink(), along with the
+ * phase table each intersection compiles from them. Every section is an array of fixed size records, so a file is
+ * mapped into memory and read in place without parsing. Every record is checked when the file is opened, so a
+ * truncated or corrupt file is reported instead of being read out of bounds. Loading creates the intersections,
+ * road segments and traffic lights, which the simulation refers to by pointer, and hands each intersection its phase
+ * table (see Intersection::adopt()), so neither the turns and links are found again nor are the lights added to the
+ * maps of their intersections one at a time. The maps are built for an intersection when it is first changed.
+ */
+struct CityFile {
+private:
+    const char *data; // the contents of the open file, nullptr if no file is open
+    size_t size; // the size of the open file in bytes
+    bool mapped; // whether the contents are mapped from the file rather than read into memory
+    const CityFileHeader *header; // the header of the open file
+    const CityFileIntersection *intersections; // the intersection section of the open file
+    const CityFileRoad *roads; // the road segment section of the open file
+    const CityFileLight *lights; // the traffic light section of the open file
+    const CityFileLink *links; // the link section of the open file
+    const uint64_t *masks; // the mask section of the open file
+    const int32_t *slots; // the slot section of the open file, holding the index of each road segment
+    const int32_t *turns; // the turn section of the open file, holding the index of each light, -1 where there is none
+    std::string error; // the reason the last file could not be opened, empty if it was opened
+
+    bool fail(std::string reason);
+    bool check();
+
+public:
+    CityFile();
+    ~CityFile();
+    static bool isCityFile(std::string fileName);
+    static bool readText(std::string fileName, WeightedDigraph *G, std::vector<Intersection*> &created, int &cars, int &carsPerSecond, std::string &error);
+    static void write(std::string fileName, WeightedDigraph *G, const std::vector<Intersection*> &intersections, int cars, int carsPerSecond);
+    bool open(std::string fileName);
+    const std::string &getError() const;
+    void close();
+    void load(WeightedDigraph *G, std::vector<Intersection*> &created) const;
+    int countIntersections() const;
+    int countRoadSegments() const;
+    int countCars() const;
+    int getCarsPerSecond() const;
+};
+
+#endif
@@ -0,0 +1,468 @@
+#include <limits>
+#include <algorithm>
+#include <assert.h>
+#include "ContractionHierarchy.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty hierarchy that has not been built.
+ */
+ContractionHierarchy::ContractionHierarchy() {
+    epoch = -1;
+    weightEpoch = 0;
+    V = 0;
+    shortcuts = 0;
+    customizable = false;
+    stamp = 0;
+}
+
+/**
+ * Deconstructs the hierarchy.
+ */
+ContractionHierarchy::~ContractionHierarchy() {}
+
+/**
+ * Builds the hierarchy from a frozen view of the graph, replacing the previous hierarchy. Intersections are
+ * contracted in the order of their priority. The edge difference of an intersection is only recomputed when it
+ * reaches the front of the queue after one of its neighbours was contracted, and the intersection is put back if
+ * it is no longer the least important. A customizable hierarchy is contracted in nested dissection order instead.
+ * The hierarchy starts with the expected times of the road segments.
+ * @param view the frozen view of the graph
+ * @param customizable true to build a hierarchy whose weights can be customized
+ */
+void ContractionHierarchy::build(const GraphView &view, bool customizable) {
+    epoch = view.getEpoch();
+    weightEpoch++;
+    V = view.countIntersections();
+    this->customizable = customizable;
+    edges.clear();
+    triangles.clear();
+    roadEdge.assign(view.countRoadSegments(), -1);
+    rank.assign(V, -1);
+    outEdges.assign(V, vector<int>());
+    inEdges.assign(V, vector<int>());
+    contracted.assign(V, 0);
+    deletedNeighbours.assign(V, 0);
+    depth.assign(V, 0);
+    edgeDifference.assign(V, 0);
+    stale.assign(V, 0);
+    witnessTime.assign(V, 0.0);
+    witnessStamp.assign(V, 0);
+    targetOf.assign(V, -1);
+    stamp = 0;
+    witnessPQ.reserve(V);
+    const int *outRoads = view.getOutRoads();
+    const int *outTargets = view.getOutTargets();
+    const double *outWeights = view.getOutWeights();
+    for (int v = 0; v < V; v++) {
+        for (int e = view.outBegin(v); e < view.outEnd(v); e++) {
+            if (outTargets[e] != v) roadEdge[outRoads[e]] = addEdge(v, outTargets[e], outWeights[e], outRoads[e], -1, -1);
+        }
+    }
+    int next = 0;
+    if (customizable) {
+        // the order only depends on the layout of the city, so any weights can be customized later
+        vector<int> order;
+        vector<int> all(V);
+        for (int v = 0; v < V; v++) all[v] = v;
+        part.assign(V, 0);
+        parts = 0;
+        dissect(view, all, order);
+        for (int v : order) eliminate(v, next++, nullptr);
+    } else {
+        IndexMinPQ order;
+        order.reserve(V);
+        for (int v = 0; v < V; v++) {
+            estimate(v);
+            order.push(v, priority(v));
+        }
+        while (!order.isEmpty()) {
+            int v = order.pop();
+            if (stale[v]) {
+                estimate(v);
+                if (!order.isEmpty() && priority(v) > order.topKey()) { // another intersection has become less important
+                    order.push(v, priority(v));
+                    continue;
+                }
+            }
+            eliminate(v, next++, &order);
+        }
+    }
+    buildSearchGraph();
+    shortcuts = 0;
+    for (const CHEdge &e : edges) {
+        if (e.road == -1) shortcuts++;
+    }
+    // the memory used while building is released, since the hierarchy can be much larger than the city
+    vector<vector<int>>().swap(outEdges);
+    vector<vector<int>>().swap(inEdges);
+    vector<char>().swap(contracted);
+    vector<int>().swap(deletedNeighbours);
+    vector<int>().swap(depth);
+    vector<int>().swap(edgeDifference);
+    vector<char>().swap(stale);
+    vector<double>().swap(witnessTime);
+    vector<int>().swap(witnessStamp);
+    vector<int>().swap(targetOf);
+    vector<int>().swap(part);
+    witnessPQ = IndexMinPQ();
+}
+
+/**
+ * Adds an edge between two intersections that have not been contracted, or lowers the weight of the existing edge
+ * between them if the new edge is faster. The existing edge cannot be part of a shortcut yet, since shortcuts only
+ * replace edges of contracted intersections.
+ * @param from the index of the intersection the edge leaves
+ * @param to the index of the intersection the edge enters
+ * @param weight the time of the edge
+ * @param road the index of the road segment, -1 for a shortcut
+ * @param first the first edge replaced by a shortcut, -1 for a road segment
+ * @param second the second edge replaced by a shortcut, -1 for a road segment
+ * @return the index of the edge between the intersections
+ */
+int ContractionHierarchy::addEdge(int from, int to, double weight, int road, int first, int second) {
+    for (int e : outEdges[from]) {
+        if (edges[e].to != to) continue;
+        if (edges[e].weight <= weight) return e;
+        edges[e].weight = weight;
+        if (road != -1) edges[e].road = road;
+        edges[e].first = first;
+        edges[e].second = second;
+        return e;
+    }
+    edges.push_back({from, to, weight, road, first, second});
+    outEdges[from].push_back(edges.size() - 1);
+    inEdges[to].push_back(edges.size() - 1);
+    return edges.size() - 1;
+}
+
+/**
+ * Replaces the weights of a customizable hierarchy. The road segments give the weights of their edges, then the
+ * triangles are walked in the order their intersections were contracted, so both lower edges of a triangle are
+ * final before the shortcut above them is updated.
+ * @param weights the time of each road segment, indexed by the road segment index in the frozen view
+ */
+void ContractionHierarchy::customize(const vector<double> &weights) {
+    assert(customizable && "hierarchy is not customizable");
+    assert(weights.size() == roadEdge.size() && "weights do not match the hierarchy");
+    for (CHEdge &e : edges) {
+        e.weight = numeric_limits<double>::infinity();
+        e.road = e.first = e.second = -1;
+    }
+    for (int r = 0; r < (int) roadEdge.size(); r++) {
+        if (roadEdge[r] == -1) continue;
+        CHEdge &e = edges[roadEdge[r]];
+        if (weights[r] < e.weight) {
+            e.weight = weights[r];
+            e.road = r;
+        }
+    }
+    for (const CHTriangle &t : triangles) {
+        double via = edges[t.first].weight + edges[t.second].weight;
+        CHEdge &e = edges[t.shortcut];
+        if (via < e.weight) {
+            e.weight = via;
+            e.first = t.first;
+            e.second = t.second;
+        }
+    }
+    weightEpoch++;
+}
+
+/**
+ * Contracts an intersection and removes it from the remaining graph.
+ * @param v the index of the intersection
+ * @param r the rank of the intersection
+ * @param order the intersections that have not been contracted keyed by their priority, nullptr if the order is fixed
+ */
+void ContractionHierarchy::eliminate(int v, int r, IndexMinPQ *order) {
+    contract(v, false);
+    contracted[v] = 1;
+    rank[v] = r;
+    // the edges to the contracted intersection are no longer needed by the remaining contractions
+    for (int e : inEdges[v]) {
+        int u = edges[e].from;
+        outEdges[u].erase(remove_if(outEdges[u].begin(), outEdges[u].end(), [&] (int f) { return edges[f].to == v; }), outEdges[u].end());
+        if (order != nullptr) updateNeighbour(*order, v, u);
+    }
+    for (int e : outEdges[v]) {
+        int x = edges[e].to;
+        inEdges[x].erase(remove_if(inEdges[x].begin(), inEdges[x].end(), [&] (int f) { return edges[f].from == v; }), inEdges[x].end());
+        if (order != nullptr) updateNeighbour(*order, v, x);
+    }
+}
+
+/**
+ * Orders intersections by nested dissection. The intersections are split in half across the longer side of their
+ * bounding box, and the intersections of the first half with a neighbour in the second half separate the halves.
+ * Both halves are ordered first and the separator last, so no shortcut crosses a separator and the shortcuts of a
+ * city laid out on a plane stay few enough to add between every pair of neighbours.
+ * @param view the frozen view of the graph
+ * @param nodes the indices of the intersections to order
+ * @param order the order the intersections are appended to
+ */
+void ContractionHierarchy::dissect(const GraphView &view, vector<int> &nodes, vector<int> &order) {
+    if ((int) nodes.size() <= CH_DISSECTION_LEAF_SIZE) {
+        order.insert(order.end(), nodes.begin(), nodes.end());
+        return;
+    }
+    const double *xs = view.getXs();
+    const double *ys = view.getYs();
+    double minX = xs[nodes[0]], maxX = xs[nodes[0]], minY = ys[nodes[0]], maxY = ys[nodes[0]];
+    for (int v : nodes) {
+        minX = min(minX, xs[v]);
+        maxX = max(maxX, xs[v]);
+        minY = min(minY, ys[v]);
+        maxY = max(maxY, ys[v]);
+    }
+    const double *coordinates = maxX - minX >= maxY - minY ? xs : ys;
+    int half = nodes.size() / 2;
+    nth_element(nodes.begin(), nodes.begin() + half, nodes.end(), [&] (int a, int b) {
+        return coordinates[a] < coordinates[b] || (coordinates[a] == coordinates[b] && a < b);
+    });
+    int first = ++parts;
+    int second = ++parts;
+    for (int i = 0; i < (int) nodes.size(); i++) part[nodes[i]] = i < half ? first : second;
+    vector<int> firstHalf, secondHalf, separator;
+    const int *outTargets = view.getOutTargets();
+    const int *inRoads = view.getInRoads();
+    for (int i = 0; i < half; i++) {
+        int v = nodes[i];
+        bool crosses = false;
+        for (int e = view.outBegin(v); e < view.outEnd(v) && !crosses; e++) crosses = part[outTargets[e]] == second;
+        for (int e = view.inBegin(v); e < view.inEnd(v) && !crosses; e++) crosses = part[view.getSource(inRoads[e])] == second;
+        if (crosses) separator.push_back(v);
+        else firstHalf.push_back(v);
+    }
+    secondHalf.assign(nodes.begin() + half, nodes.end());
+    dissect(view, firstHalf, order);
+    dissect(view, secondHalf, order);
+    order.insert(order.end(), separator.begin(), separator.end());
+}
+
+/**
+ * Finds the shortest times from an intersection to the neighbours of the intersection being contracted without
+ * passing through it. The search stops once every neighbour has been visited, and gives up after visiting a number
+ * of intersections, which can only add shortcuts that are not needed.
+ * @param source the index of the intersection to search from
+ * @param skip the index of the intersection being contracted
+ * @param targets the number of neighbours to visit
+ * @param limit the longest time that is of interest
+ * @param settleLimit the most intersections to visit
+ */
+void ContractionHierarchy::witnessSearch(int source, int skip, int targets, double limit, int settleLimit) {
+    if (stamp == numeric_limits<int>::max()) {
+        fill(witnessStamp.begin(), witnessStamp.end(), 0);
+        stamp = 0;
+    }
+    stamp++;
+    witnessPQ.clear();
+    witnessStamp[source] = stamp;
+    witnessTime[source] = 0.0;
+    witnessPQ.push(source, 0.0);
+    for (int settled = 0; !witnessPQ.isEmpty() && witnessPQ.topKey() <= limit && settled < settleLimit; settled++) {
+        int v = witnessPQ.pop();
+        if (targetOf[v] == skip && v != source && --targets == 0) break;
+        for (int e : outEdges[v]) {
+            int x = edges[e].to;
+            if (x == skip || contracted[x]) continue;
+            double time = witnessTime[v] + edges[e].weight;
+            if (witnessStamp[x] == stamp && witnessTime[x] <= time) continue;
+            bool queued = witnessStamp[x] == stamp && witnessPQ.contains(x);
+            witnessStamp[x] = stamp;
+            witnessTime[x] = time;
+            if (queued) witnessPQ.decreaseKey(x, time);
+            else witnessPQ.push(x, time);
+        }
+    }
+}
+
+/**
+ * Contracts an intersection by adding a shortcut between each pair of its neighbours that is not connected by a
+ * path at least as fast as the path through the intersection, or between every pair of its neighbours if the
+ * hierarchy is customizable.
+ * @param v the index of the intersection
+ * @param simulate true to only count the shortcuts that would be added
+ * @return the number of shortcuts that are needed
+ */
+int ContractionHierarchy::contract(int v, bool simulate) {
+    int needed = 0;
+    // a customizable hierarchy cannot rely on witnesses, since they may not be shorter under other weights
+    int settleLimit = customizable ? 0 : simulate ? CH_ESTIMATE_SETTLE_LIMIT : CH_WITNESS_SETTLE_LIMIT;
+    for (int b : outEdges[v]) targetOf[edges[b].to] = v;
+    for (int i = 0; i < (int) inEdges[v].size(); i++) {
+        int a = inEdges[v][i];
+        int u = edges[a].from;
+        double limit = -1.0;
+        int targets = 0;
+        for (int b : outEdges[v]) {
+            if (edges[b].to == u) continue;
+            limit = max(limit, edges[a].weight + edges[b].weight);
+            targets++;
+        }
+        if (targets == 0) continue;
+        witnessSearch(u, v, targets, limit, settleLimit);
+        for (int j = 0; j < (int) outEdges[v].size(); j++) {
+            int b = outEdges[v][j];
+            int x = edges[b].to;
+            if (x == u) continue;
+            double via = edges[a].weight + edges[b].weight;
+            if (witnessStamp[x] == stamp && witnessTime[x] <= via) continue;
+            needed++;
+            if (simulate) continue;
+            int e = addEdge(u, x, via, -1, a, b);
+            if (customizable) triangles.push_back({a, b, e});
+        }
+    }
+    return needed;
+}
+
+/**
+ * Recomputes the edge difference of an intersection, which is the number of shortcuts its contraction would add
+ * minus the number of edges it would remove.
+ * @param v the index of the intersection
+ */
+void ContractionHierarchy::estimate(int v) {
+    int removed = inEdges[v].size() + outEdges[v].size();
+    edgeDifference[v] = contract(v, true) - removed;
+    stale[v] = 0;
+}
+
+/**
+ * Returns the priority of an intersection, where less important intersections are contracted first. Intersections
+ * that add few shortcuts compared to the edges they remove, and that have few contracted neighbours, have a lower
+ * priority, which keeps the hierarchy small and spreads the contractions evenly over the city. The depth of the
+ * intersection in the hierarchy is added to keep the searches up the hierarchy short.
+ * @param v the index of the intersection
+ */
+double ContractionHierarchy::priority(int v) const {
+    return CH_EDGE_DIFFERENCE_WEIGHT * edgeDifference[v] + deletedNeighbours[v] + depth[v];
+}
+
+/**
+ * Updates the priority of a neighbour of an intersection that was just contracted. The edge difference of the
+ * neighbour is marked as stale rather than recomputed, since most neighbours are updated several times before they
+ * are contracted.
+ * @param order the intersections that have not been contracted, keyed by their priority
+ * @param v the index of the contracted intersection
+ * @param n the index of the neighbour
+ */
+void ContractionHierarchy::updateNeighbour(IndexMinPQ &order, int v, int n) {
+    deletedNeighbours[n]++;
+    depth[n] = max(depth[n], depth[v] + 1);
+    stale[n] = 1;
+    order.changeKey(n, priority(n));
+}
+
+/**
+ * Splits the edges into the upward edges used by the forward search and the downward edges used by the backward
+ * search, each stored contiguously by intersection.
+ */
+void ContractionHierarchy::buildSearchGraph() {
+    upStart.assign(V + 1, 0);
+    downStart.assign(V + 1, 0);
+    for (const CHEdge &e : edges) {
+        if (rank[e.from] < rank[e.to]) upStart[e.from + 1]++;
+        else downStart[e.to + 1]++;
+    }
+    for (int v = 0; v < V; v++) {
+        upStart[v + 1] += upStart[v];
+        downStart[v + 1] += downStart[v];
+    }
+    upEdges.resize(upStart[V]);
+    downEdges.resize(downStart[V]);
+    vector<int> upNext(upStart.begin(), upStart.end() - 1);
+    vector<int> downNext(downStart.begin(), downStart.end() - 1);
+    for (int e = 0; e < (int) edges.size(); e++) {
+        if (rank[edges[e].from] < rank[edges[e].to]) upEdges[upNext[edges[e].from]++] = e;
+        else downEdges[downNext[edges[e].to]++] = e;
+    }
+}
+
+/**
+ * Returns the epoch of the graph the hierarchy was built from, -1 if it has not been built.
+ */
+long long ContractionHierarchy::getEpoch() const { return epoch; }
+
+/**
+ * Returns the number of times the weights of the hierarchy have changed, which is also changed by building it.
+ */
+long long ContractionHierarchy::getWeightEpoch() const { return weightEpoch; }
+
+/**
+ * Returns whether the weights can be replaced without building the hierarchy again.
+ */
+bool ContractionHierarchy::isCustomizable() const { return customizable; }
+
+/**
+ * Returns the number of triangles walked when the hierarchy is customized.
+ */
+int ContractionHierarchy::countTriangles() const { return triangles.size(); }
+
+/**
+ * Returns the number of intersections in the hierarchy.
+ */
+int ContractionHierarchy::countIntersections() const { return V; }
+
+/**
+ * Returns the number of edges added by the contraction.
+ */
+int ContractionHierarchy::countShortcuts() const { return shortcuts; }
+
+/**
+ * Returns the order an intersection was contracted in.
+ * @param v the index of the intersection
+ */
+int ContractionHierarchy::getRank(int v) const { return rank[v]; }
+
+/**
+ * Returns an edge of the hierarchy.
+ * @param e the index of the edge
+ */
+const CHEdge &ContractionHierarchy::getEdge(int e) const { return edges[e]; }
+
+/**
+ * Returns the position of the first upward edge leaving an intersection.
+ */
+int ContractionHierarchy::upBegin(int v) const { return upStart[v]; }
+
+/**
+ * Returns the position after the last upward edge leaving an intersection.
+ */
+int ContractionHierarchy::upEnd(int v) const { return upStart[v + 1]; }
+
+/**
+ * Returns the position of the first downward edge entering an intersection.
+ */
+int ContractionHierarchy::downBegin(int v) const { return downStart[v]; }
+
+/**
+ * Returns the position after the last downward edge entering an intersection.
+ */
+int ContractionHierarchy::downEnd(int v) const { return downStart[v + 1]; }
+
+/**
+ * Returns the indices of the upward edges, ordered by the intersection they leave.
+ */
+const int *ContractionHierarchy::getUpEdges() const { return upEdges.data(); }
+
+/**
+ * Returns the indices of the downward edges, ordered by the intersection they enter.
+ */
+const int *ContractionHierarchy::getDownEdges() const { return downEdges.data(); }
+
+/**
+ * Appends the road segments of an edge to a path, replacing each shortcut with the edges it replaced.
+ * @param e the index of the edge
+ * @param roads the indices of the road segments on the path
+ */
+void ContractionHierarchy::unpack(int e, vector<int> &roads) const {
+    const CHEdge &edge = edges[e];
+    if (edge.first == -1) {
+        roads.push_back(edge.road);
+    } else {
+        unpack(edge.first, roads);
+        unpack(edge.second, roads);
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef CONTRACTIONHIERARCHY_H_
+#define CONTRACTIONHIERARCHY_H_
+
+#include <vector>
+#include "Forward.h"
+#include "GraphView.h"
+#include "../misc/IndexMinPQ.h"
+
+#define CH_WITNESS_SETTLE_LIMIT 500 // the most intersections a witness search visits before giving up
+#define CH_ESTIMATE_SETTLE_LIMIT 50 // the most intersections a witness search visits when estimating the priority
+#define CH_EDGE_DIFFERENCE_WEIGHT 2 // the weight of the edge difference in the priority of an intersection
+#define CH_DISSECTION_LEAF_SIZE 4 // the most intersections that nested dissection leaves unsplit
+
+/**
+ * An edge of the contraction hierarchy. An edge is either a road segment, or a shortcut that replaces the two
+ * edges through an intersection that was contracted, whichever is faster.
+ */
+struct CHEdge {
+    int from; // the index of the intersection the edge leaves
+    int to; // the index of the intersection the edge enters
+    double weight; // the time of the edge under the current weights
+    int road; // the index of the fastest road segment between the intersections, -1 if there is none
+    int first; // the first edge replaced by the shortcut, -1 if the edge is a road segment
+    int second; // the second edge replaced by the shortcut, -1 if the edge is a road segment
+};
+
+/**
+ * Two edges through a contracted intersection and the edge between their other ends, which is updated from the
+ * two edges when the hierarchy is customized.
+ */
+struct CHTriangle {
+    int first; // the edge entering the contracted intersection
+    int second; // the edge leaving the contracted intersection
+    int shortcut; // the edge from the start of the first edge to the end of the second edge
+};
+
+/**
+ * A contraction hierarchy of the city. Intersections are contracted one at a time from least to most important,
+ * and shortcuts are added between the neighbours of each contracted intersection when the intersection is on the
+ * only shortest path between them. A shortest path then always goes up the hierarchy and then down again, so a
+ * query only has to search upwards from both ends.
+ *
+ * A customizable hierarchy adds a shortcut for every pair of neighbours instead of only the ones on a shortest path,
+ * so it does not depend on the weights it was built with. Its weights can then be replaced by customizing it, which
+ * only walks the triangles of the hierarchy once and is much faster than building it again.
+ */
+struct ContractionHierarchy {
+private:
+    long long epoch; // the epoch of the graph the hierarchy was built from, -1 if it has not been built
+    int V; // the number of intersections
+    std::vector<int> rank; // the order each intersection was contracted in
+    std::vector<CHEdge> edges; // the road segments and the shortcuts
+    std::vector<int> upStart; // the upward edges leaving intersection v are upEdges[upStart[v], upStart[v + 1])
+    std::vector<int> upEdges; // the edges leaving each intersection for a higher ranked intersection
+    std::vector<int> downStart; // the downward edges entering intersection v are downEdges[downStart[v], downStart[v + 1])
+    std::vector<int> downEdges; // the edges entering each intersection from a higher ranked intersection
+    int shortcuts; // the number of edges added by the contraction
+    bool customizable; // whether the weights can be replaced without building the hierarchy again
+    std::vector<int> roadEdge; // the edge of each road segment, -1 if the road segment is a loop
+    std::vector<CHTriangle> triangles; // the triangles of a customizable hierarchy in the order they were contracted
+    long long weightEpoch; // incremented every time the weights change
+
+    // the state that is only used while building
+    std::vector<std::vector<int>> outEdges; // the edges leaving each intersection
+    std::vector<std::vector<int>> inEdges; // the edges entering each intersection
+    std::vector<char> contracted; // whether each intersection has been contracted
+    std::vector<int> deletedNeighbours; // the number of contracted neighbours of each intersection
+    std::vector<int> depth; // the longest chain of contracted intersections below each intersection
+    std::vector<int> edgeDifference; // the last computed edge difference of each intersection
+    std::vector<char> stale; // whether a neighbour of each intersection was contracted since its edge difference was computed
+    std::vector<double> witnessTime; // the time to each intersection in the witness search
+    std::vector<int> witnessStamp; // the stamp of the witness search that reached each intersection
+    std::vector<int> targetOf; // the last intersection contracted with each intersection as an out neighbour
+    int stamp; // the stamp of the current witness search
+    std::vector<int> part; // the part of each intersection in the current step of nested dissection
+    int parts; // the number of parts made by nested dissection
+    IndexMinPQ witnessPQ; // the priority queue of the witness search
+
+    int addEdge(int from, int to, double weight, int road, int first, int second);
+    void witnessSearch(int source, int skip, int targets, double limit, int settleLimit);
+    int contract(int v, bool simulate);
+    void estimate(int v);
+    double priority(int v) const;
+    void updateNeighbour(IndexMinPQ &order, int v, int n);
+    void eliminate(int v, int r, IndexMinPQ *order);
+    void dissect(const GraphView &view, std::vector<int> &nodes, std::vector<int> &order);
+    void buildSearchGraph();
+
+public:
+    ContractionHierarchy();
+    ~ContractionHierarchy();
+    void build(const GraphView &view, bool customizable);
+    void customize(const std::vector<double> &weights);
+    long long getEpoch() const;
+    long long getWeightEpoch() const;
+    bool isCustomizable() const;
+    int countTriangles() const;
+    int countIntersections() const;
+    int countShortcuts() const;
+    int getRank(int v) const;
+    const CHEdge &getEdge(int e) const;
+    int upBegin(int v) const;
+    int upEnd(int v) const;
+    int downBegin(int v) const;
+    int downEnd(int v) const;
+    const int *getUpEdges() const;
+    const int *getDownEdges() const;
+    void unpack(int e, std::vector<int> &roads) const;
+};
+
+#endif
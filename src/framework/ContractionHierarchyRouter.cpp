@@ -0,0 +1,69 @@
+#include "ContractionHierarchyRouter.h"
+#include "ContractionHierarchySP.h"
+#include "WeightedDigraph.h"
+
+using namespace std;
+
+/**
+ * Initializes the ContractionHierarchyRouter given a Weighted Directed Graph. The hierarchy is built the first time
+ * the router is prepared.
+ * @param G the Weighted Directed Graph that the router will find paths in
+ */
+ContractionHierarchyRouter::ContractionHierarchyRouter(WeightedDigraph *G) : Router(G) {
+    customizable = false;
+}
+
+/**
+ * Initializes the ContractionHierarchyRouter given a Weighted Directed Graph and the kind of hierarchy to build.
+ * @param G the Weighted Directed Graph that the router will find paths in
+ * @param customizable true to build a hierarchy whose weights can be customized
+ */
+ContractionHierarchyRouter::ContractionHierarchyRouter(WeightedDigraph *G, bool customizable) : Router(G) {
+    this->customizable = customizable;
+}
+
+/**
+ * Deconstructs the ContractionHierarchyRouter.
+ */
+ContractionHierarchyRouter::~ContractionHierarchyRouter() {}
+
+/**
+ * Returns the name of the router.
+ */
+const char *ContractionHierarchyRouter::getName() const { return "ch"; }
+
+/**
+ * Freezes the graph and rebuilds the hierarchy if the graph has changed since it was last built.
+ */
+void ContractionHierarchyRouter::prepare() {
+    const GraphView &view = G->freeze();
+    if (hierarchy.getEpoch() != view.getEpoch()) hierarchy.build(view, customizable);
+}
+
+/**
+ * Finds the fastest path from one of the sources to one of the destinations.
+ * @param sourceIDs the intersection IDs of the sources
+ * @param initialTime the initial times to each of the sources
+ * @param destinationIDs the intersection IDs of the possible destinations
+ * @param excessTime the extra time required for each of the possible destinations
+ * @param path the path that is found
+ */
+void ContractionHierarchyRouter::route(vector<int> &sourceIDs, vector<double> &initialTime, vector<int> &destinationIDs, vector<double> &excessTime, ShortestPath &path) {
+    static thread_local ContractionHierarchySP search; // reused by every search on this thread
+    if (hierarchy.getEpoch() != G->getEpoch()) prepare();
+    search.search(hierarchy, G, sourceIDs, initialTime, destinationIDs, excessTime);
+    path.time = search.getShortestTime();
+    path.sourceID = search.getSourceID();
+    path.destinationID = search.getDestinationID();
+    path.roads.assign(search.getShortestPath().begin(), search.getShortestPath().end());
+}
+
+/**
+ * Returns the number of times the weights of the hierarchy have changed.
+ */
+long long ContractionHierarchyRouter::getWeightEpoch() const { return hierarchy.getWeightEpoch(); }
+
+/**
+ * Returns the contraction hierarchy of the router.
+ */
+const ContractionHierarchy &ContractionHierarchyRouter::getHierarchy() const { return hierarchy; }
@@ -0,0 +1,30 @@
+#ifndef CONTRACTIONHIERARCHYROUTER_H_
+#define CONTRACTIONHIERARCHYROUTER_H_
+
+#include "Router.h"
+#include "ContractionHierarchy.h"
+
+/**
+ * Routes cars with a contraction hierarchy of the city. Building the hierarchy takes much longer than a single
+ * search, but each search afterwards only visits a few hundred intersections even in very large cities. The
+ * hierarchy is rebuilt whenever the structure of the graph changes.
+ */
+struct ContractionHierarchyRouter : public Router {
+protected:
+    ContractionHierarchy hierarchy; // the hierarchy built from the current graph
+    bool customizable; // whether the hierarchy is built so that its weights can be customized
+
+    ContractionHierarchyRouter(WeightedDigraph *G, bool customizable);
+
+public:
+    ContractionHierarchyRouter(WeightedDigraph *G);
+    ~ContractionHierarchyRouter();
+    const char *getName() const;
+    void prepare();
+    void route(std::vector<int> &sourceIDs, std::vector<double> &initialTime, std::vector<int> &destinationIDs,
+            std::vector<double> &excessTime, ShortestPath &path);
+    long long getWeightEpoch() const;
+    const ContractionHierarchy &getHierarchy() const;
+};
+
+#endif
@@ -0,0 +1,177 @@
+#include <limits>
+#include <algorithm>
+#include <assert.h>
+#include "ContractionHierarchySP.h"
+#include "Intersection.h"
+#include "GraphView.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty structure with no path, which can be reused for any number of searches.
+ */
+ContractionHierarchySP::ContractionHierarchySP() {
+    shortestPathSourceID = shortestPathDestinationID = -1;
+    shortestTime = numeric_limits<double>::infinity();
+    stamp = 0;
+}
+
+/**
+ * Calculates the shortest path based on expected time to each of the possible destinations, replacing the result
+ * of the previous search. The searches alternate by always visiting the closer of the two next intersections, and
+ * stop once neither can lead to a shorter path than the best meeting point found so far.
+ * @param ch the contraction hierarchy, which must be built from the current graph
+ * @param G the Weighted Directed Graph
+ * @param sourceIDs the intersection IDs of the sources
+ * @param initialTime the initial times to each of the sources
+ * @param destinationIDs the intersection IDs of the possible destinations
+ * @param excesstime the extra time required for each of the possible destinations
+ */
+void ContractionHierarchySP::search(const ContractionHierarchy &ch, WeightedDigraph *G, vector<int> &sourceIDs, vector<double> &initialTime,
+        vector<int> &destinationIDs, vector<double> &excessTime) {
+    shortestPath.clear();
+    const GraphView &view = G->freeze();
+    assert(ch.getEpoch() == view.getEpoch() && "contraction hierarchy is out of date");
+    prepare(view.countIntersections());
+    for (int d = 0; d < (int) destinationIDs.size(); d++) {
+        relax(CH_BACKWARD, G->getIntersection(destinationIDs[d])->getIndex(), excessTime[d], -1);
+    }
+    for (int s = 0; s < (int) sourceIDs.size(); s++) {
+        relax(CH_FORWARD, G->getIntersection(sourceIDs[s])->getIndex(), initialTime[s], -1);
+    }
+    shortestPathSourceID = shortestPathDestinationID = -1;
+    shortestTime = numeric_limits<double>::infinity();
+    int meeting = -1;
+    const int *upEdges = ch.getUpEdges();
+    const int *downEdges = ch.getDownEdges();
+    while (true) {
+        double forwardKey = pq[CH_FORWARD].isEmpty() ? numeric_limits<double>::infinity() : pq[CH_FORWARD].topKey();
+        double backwardKey = pq[CH_BACKWARD].isEmpty() ? numeric_limits<double>::infinity() : pq[CH_BACKWARD].topKey();
+        if (min(forwardKey, backwardKey) >= shortestTime) break;
+        int side = forwardKey <= backwardKey ? CH_FORWARD : CH_BACKWARD;
+        int v = pq[side].pop();
+        if (reached[1 - side][v] == stamp && timeTo[CH_FORWARD][v] + timeTo[CH_BACKWARD][v] < shortestTime) {
+            shortestTime = timeTo[CH_FORWARD][v] + timeTo[CH_BACKWARD][v];
+            meeting = v;
+        }
+        if (isStalled(ch, side, v)) continue;
+        if (side == CH_FORWARD) {
+            for (int i = ch.upBegin(v); i < ch.upEnd(v); i++) {
+                const CHEdge &e = ch.getEdge(upEdges[i]);
+                relax(CH_FORWARD, e.to, timeTo[CH_FORWARD][v] + e.weight, upEdges[i]);
+            }
+        } else {
+            for (int i = ch.downBegin(v); i < ch.downEnd(v); i++) {
+                const CHEdge &e = ch.getEdge(downEdges[i]);
+                relax(CH_BACKWARD, e.from, timeTo[CH_BACKWARD][v] + e.weight, downEdges[i]);
+            }
+        }
+    }
+    if (shortestTime != numeric_limits<double>::infinity()) {
+        // the edges from the meeting point back to the source are collected backwards, then the edges to the destination
+        edgePath.clear();
+        for (int e = edgeTo[CH_FORWARD][meeting]; e != -1; e = edgeTo[CH_FORWARD][ch.getEdge(e).from]) edgePath.push_back(e);
+        reverse(edgePath.begin(), edgePath.end());
+        for (int e = edgeTo[CH_BACKWARD][meeting]; e != -1; e = edgeTo[CH_BACKWARD][ch.getEdge(e).to]) edgePath.push_back(e);
+        roadPath.clear();
+        for (int e : edgePath) ch.unpack(e, roadPath);
+        for (int r : roadPath) shortestPath.push_back(view.getRoadSegment(r));
+        assert(!shortestPath.empty() && "no path for car to reach destination from sources");
+        shortestPathSourceID = shortestPath.front()->getSource()->getID();
+        shortestPathDestinationID = shortestPath.back()->getDestination()->getID();
+    }
+}
+
+/**
+ * Deconstructs the structure.
+ */
+ContractionHierarchySP::~ContractionHierarchySP() {}
+
+/**
+ * Starts a new search by moving to the next stamp, which invalidates the entries of the previous search without
+ * touching them. The scratch arrays only grow when the city has more intersections than before.
+ * @param V the number of intersections in the frozen view
+ */
+void ContractionHierarchySP::prepare(int V) {
+    for (int side = 0; side < 2; side++) {
+        pq[side].clear();
+        if ((int) reached[side].size() < V) {
+            timeTo[side].resize(V);
+            edgeTo[side].resize(V);
+            reached[side].resize(V, 0);
+            pq[side].reserve(V);
+        }
+    }
+    if (stamp == numeric_limits<int>::max()) { // the stamps wrapped around, so the old ones have to be cleared
+        fill(reached[CH_FORWARD].begin(), reached[CH_FORWARD].end(), 0);
+        fill(reached[CH_BACKWARD].begin(), reached[CH_BACKWARD].end(), 0);
+        stamp = 0;
+    }
+    stamp++;
+}
+
+/**
+ * Records a path to an intersection in one direction if it is shorter than the shortest path found so far.
+ * @param side CH_FORWARD or CH_BACKWARD
+ * @param v the index of the intersection
+ * @param time the time to reach the intersection on the path
+ * @param edge the index of the last edge of the hierarchy on the path, -1 if the intersection is where the search starts
+ */
+void ContractionHierarchySP::relax(int side, int v, double time, int edge) {
+    if (reached[side][v] == stamp && timeTo[side][v] <= time) return;
+    bool queued = reached[side][v] == stamp && pq[side].contains(v);
+    reached[side][v] = stamp;
+    timeTo[side][v] = time;
+    edgeTo[side][v] = edge;
+    if (queued) pq[side].decreaseKey(v, time);
+    else pq[side].push(v, time);
+}
+
+/**
+ * Returns whether an intersection can be reached faster through a more important intersection in the same
+ * direction, in which case the time to it is not the shortest and its edges do not have to be followed.
+ * @param ch the contraction hierarchy
+ * @param side CH_FORWARD or CH_BACKWARD
+ * @param v the index of the intersection
+ */
+bool ContractionHierarchySP::isStalled(const ContractionHierarchy &ch, int side, int v) const {
+    if (side == CH_FORWARD) {
+        const int *downEdges = ch.getDownEdges();
+        for (int i = ch.downBegin(v); i < ch.downEnd(v); i++) {
+            const CHEdge &e = ch.getEdge(downEdges[i]);
+            if (reached[CH_FORWARD][e.from] == stamp && timeTo[CH_FORWARD][e.from] + e.weight < timeTo[CH_FORWARD][v]) return true;
+        }
+    } else {
+        const int *upEdges = ch.getUpEdges();
+        for (int i = ch.upBegin(v); i < ch.upEnd(v); i++) {
+            const CHEdge &e = ch.getEdge(upEdges[i]);
+            if (reached[CH_BACKWARD][e.to] == stamp && timeTo[CH_BACKWARD][e.to] + e.weight < timeTo[CH_BACKWARD][v]) return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns whether there is a path from the source to reach the destination.
+ */
+bool ContractionHierarchySP::hasPath() const { return shortestTime != numeric_limits<double>::infinity(); }
+
+/**
+ * Returns the shortest amount of time to reach the destination.
+ */
+double ContractionHierarchySP::getShortestTime() const { return shortestTime; }
+
+/**
+ * Returns the ID of starting (source) intersection of the shortest path.
+ */
+int ContractionHierarchySP::getSourceID() const { return shortestPathSourceID; }
+
+/**
+ * Returns the ID of destination intersection of the shortest path.
+ */
+int ContractionHierarchySP::getDestinationID() const { return shortestPathDestinationID; }
+
+/**
+ * Returns the shortest path based on time to reach one of the possible destination intersections from one of the source intersections.
+ */
+const std::vector<RoadSegment*> &ContractionHierarchySP::getShortestPath() const { return shortestPath; }
@@ -0,0 +1,50 @@
+#ifndef CONTRACTIONHIERARCHYSP_H_
+#define CONTRACTIONHIERARCHYSP_H_
+
+#include <vector>
+#include "Forward.h"
+#include "ContractionHierarchy.h"
+#include "WeightedDigraph.h"
+#include "../misc/IndexMinPQ.h"
+
+#define CH_FORWARD 0 // the search up the hierarchy from the sources
+#define CH_BACKWARD 1 // the search up the hierarchy from the destinations
+
+/**
+ * Finds shortest paths with a bidirectional search on a contraction hierarchy. The forward search starts from the
+ * sources with their initial times and the backward search starts from the destinations with their excess times,
+ * and both only follow edges up the hierarchy, so they meet at the most important intersection on the path.
+ */
+struct ContractionHierarchySP {
+private:
+    // the scratch arrays are indexed by the intersection index in the frozen view and by the direction of the
+    // search, and an entry is only valid if its stamp matches the current search
+    std::vector<double> timeTo[2]; // the shortest time to each intersection found so far
+    std::vector<int> edgeTo[2]; // the last edge of the hierarchy on the path to each intersection, -1 if there is none
+    std::vector<int> reached[2]; // the stamp of the last search that reached each intersection
+    int stamp; // the stamp of the current search
+    IndexMinPQ pq[2]; // the intersections that have been reached but not visited
+    std::vector<int> edgePath; // the edges of the hierarchy on the shortest path
+    std::vector<int> roadPath; // the indices of the road segments on the shortest path
+    int shortestPathSourceID;
+    int shortestPathDestinationID;
+    double shortestTime;
+    std::vector<RoadSegment*> shortestPath;
+
+    void prepare(int V);
+    void relax(int side, int v, double time, int edge);
+    bool isStalled(const ContractionHierarchy &ch, int side, int v) const;
+
+public:
+    ContractionHierarchySP();
+    void search(const ContractionHierarchy &ch, WeightedDigraph *G, std::vector<int> &sourceIDs, std::vector<double> &initialTime,
+            std::vector<int> &destinationIDs, std::vector<double> &excessTime);
+    ~ContractionHierarchySP();
+    bool hasPath() const;
+    double getShortestTime() const;
+    int getSourceID() const;
+    int getDestinationID() const;
+    const std::vector<RoadSegment*> &getShortestPath() const;
+};
+
+#endif
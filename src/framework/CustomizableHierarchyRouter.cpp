@@ -0,0 +1,84 @@
+#include <assert.h>
+#include "CustomizableHierarchyRouter.h"
+#include "WeightedDigraph.h"
+#include "RoadSegment.h"
+
+using namespace std;
+
+/**
+ * Initializes the CustomizableHierarchyRouter given a Weighted Directed Graph. The hierarchy is built the first time
+ * the router is prepared.
+ * @param G the Weighted Directed Graph that the router will find paths in
+ * @param interval the number of seconds between customizations
+ */
+CustomizableHierarchyRouter::CustomizableHierarchyRouter(WeightedDigraph *G, double interval) : ContractionHierarchyRouter(G, true) {
+    assert(interval > 0.0 && "interval must be a positive value");
+    this->interval = interval;
+    lastCustomized = 0.0;
+    queueDelay = 0.0;
+}
+
+/**
+ * Deconstructs the CustomizableHierarchyRouter.
+ */
+CustomizableHierarchyRouter::~CustomizableHierarchyRouter() {}
+
+/**
+ * Returns the name of the router.
+ */
+const char *CustomizableHierarchyRouter::getName() const { return "cch"; }
+
+/**
+ * Freezes the graph and rebuilds the hierarchy if the graph has changed since it was last built, then customizes
+ * the new hierarchy with the current projected speeds.
+ */
+void CustomizableHierarchyRouter::prepare() {
+    long long built = hierarchy.getEpoch();
+    ContractionHierarchyRouter::prepare();
+    if (hierarchy.getEpoch() != built) customize();
+}
+
+/**
+ * Customizes the hierarchy with the current projected speeds if the interval has passed since the last time.
+ * @param currentTime the current time of the simulation
+ */
+void CustomizableHierarchyRouter::refresh(double currentTime) {
+    if (currentTime - lastCustomized < interval) return;
+    lastCustomized = currentTime;
+    if (hierarchy.getEpoch() != G->getEpoch()) prepare(); // already customized after building
+    else customize();
+}
+
+/**
+ * Returns the number of seconds between customizations.
+ */
+double CustomizableHierarchyRouter::getInterval() const { return interval; }
+
+/**
+ * Returns the number of seconds each car in the waiting queue of a road segment adds to its weight.
+ */
+double CustomizableHierarchyRouter::getQueueDelay() const { return queueDelay; }
+
+/**
+ * Sets the number of seconds each car in the waiting queue of a road segment adds to its weight, which takes effect
+ * at the next customization. The weights only use the projected speeds by default.
+ * @param queueDelay the delay of each waiting car (a non-negative value)
+ */
+void CustomizableHierarchyRouter::setQueueDelay(double queueDelay) {
+    assert(queueDelay >= 0.0 && "queueDelay must be non-negative");
+    this->queueDelay = queueDelay;
+}
+
+/**
+ * Replaces the weights of the hierarchy with the time to cross each road segment at its projected speed, and to wait
+ * for the cars in its queue.
+ */
+void CustomizableHierarchyRouter::customize() {
+    const GraphView &view = G->getView();
+    weights.resize(view.countRoadSegments());
+    for (int r = 0; r < view.countRoadSegments(); r++) {
+        RoadSegment *road = view.getRoadSegment(r);
+        weights[r] = road->getLength() / road->getProjectedSpeed() + road->countCarsInQueue() * queueDelay;
+    }
+    hierarchy.customize(weights);
+}
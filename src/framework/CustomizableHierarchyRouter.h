@@ -0,0 +1,35 @@
+#ifndef CUSTOMIZABLEHIERARCHYROUTER_H_
+#define CUSTOMIZABLEHIERARCHYROUTER_H_
+
+#include <vector>
+#include "ContractionHierarchyRouter.h"
+
+#define CUSTOMIZATION_INTERVAL 10.0 // the default number of seconds between customizations
+
+/**
+ * Routes cars with a customizable contraction hierarchy whose weights are the times to cross each road segment at
+ * its projected speed. The weights are customized again at a fixed interval, so new cars are routed around
+ * congestion without building the hierarchy again. The cars waiting at the end of each road segment can also be
+ * counted in its weight, since a long queue at a light slows a road down long before it nears its capacity.
+ */
+struct CustomizableHierarchyRouter : public ContractionHierarchyRouter {
+private:
+    double interval; // the number of seconds between customizations
+    double lastCustomized; // the time of the simulation when the hierarchy was last customized
+    double queueDelay; // the number of seconds each car in the waiting queue of a road segment adds to its weight
+    std::vector<double> weights; // the time to cross each road segment, indexed by the road segment index
+
+    void customize();
+
+public:
+    CustomizableHierarchyRouter(WeightedDigraph *G, double interval);
+    ~CustomizableHierarchyRouter();
+    const char *getName() const;
+    void prepare();
+    void refresh(double currentTime);
+    double getInterval() const;
+    double getQueueDelay() const;
+    void setQueueDelay(double queueDelay);
+};
+
+#endif
@@ -1,13 +1,21 @@
 #include <utility>
 #include <functional>
 #include <limits>
-#include <stack>
-#include <queue>
+#include <algorithm>
 #include <assert.h>
 #include "DijkstraDirectedSP.h"
 
 using namespace std;
 
+/**
+ * Initializes an empty structure with no path, which can be reused for any number of searches.
+ */
+DijkstraDirectedSP::DijkstraDirectedSP() {
+    shortestPathSourceID = shortestPathDestinationID = -1;
+    shortestTime = numeric_limits<double>::infinity();
+    stamp = 0;
+}
+
 /**
  * Calculates the shortest path based on expected time to each of the possible destinations.
  * @param G the Weighted Directed Graph
@@ -17,26 +25,59 @@ using namespace std;
  * @param excesstime the extra time required for each of the possible destinations
  */
 DijkstraDirectedSP::DijkstraDirectedSP(WeightedDigraph *G, vector<int> &sourceIDs, vector<double> &initialTime, vector<int> &destinationIDs, vector<double> &excessTime) {
-    dijkstra(G, sourceIDs, initialTime);
+    search(G, sourceIDs, initialTime, destinationIDs, excessTime);
+}
+
+/**
+ * Calculates the shortest path based on expected time to each of the possible destinations, replacing the result
+ * of the previous search. The search stops as soon as no unvisited intersection can lead to a shorter path, so the
+ * cost depends on the part of the city that is explored rather than the size of the city.
+ * @param G the Weighted Directed Graph
+ * @param sourceIDs the intersection IDs of the sources
+ * @param initialTime the initial times to each of the sources
+ * @param destinationIDs the intersection IDs of the possible destinations
+ * @param excesstime the extra time required for each of the possible destinations
+ */
+void DijkstraDirectedSP::search(WeightedDigraph *G, vector<int> &sourceIDs, vector<double> &initialTime, vector<int> &destinationIDs, vector<double> &excessTime) {
+    shortestPath.clear();
+    const GraphView &view = G->freeze();
+    prepare(view.countIntersections());
+    for (int d = 0; d < destinationIDs.size(); d++) {
+        int v = G->getIntersection(destinationIDs[d])->getIndex();
+        if (destinationStamp[v] != stamp || excessTime[d] < excessAt[v]) {
+            destinationStamp[v] = stamp;
+            excessAt[v] = excessTime[d];
+        }
+    }
+    for (int s = 0; s < sourceIDs.size(); s++) {
+        relax(G->getIntersection(sourceIDs[s])->getIndex(), initialTime[s], -1);
+    }
     shortestPathSourceID = shortestPathDestinationID = -1;
     shortestTime = numeric_limits<double>::infinity();
-    for (int d = 0; d < destinationIDs.size(); d++) {
-        if (timeTo[destinationIDs[d]] + excessTime[d] < shortestTime) {
-            shortestTime = timeTo[destinationIDs[d]] + excessTime[d];
-            shortestPathDestinationID = destinationIDs[d];
+    int destination = -1;
+    const int *outRoads = view.getOutRoads();
+    const int *outTargets = view.getOutTargets();
+    const double *outWeights = view.getOutWeights();
+    // the excess times are non-negative, so no intersection visited after this point can lead to a shorter path
+    while (!pq.isEmpty() && pq.topKey() < shortestTime) {
+        int v = pq.pop();
+        if (destinationStamp[v] == stamp && timeTo[v] + excessAt[v] < shortestTime) {
+            shortestTime = timeTo[v] + excessAt[v];
+            destination = v;
+        }
+        for (int e = view.outBegin(v); e < view.outEnd(v); e++) {
+            relax(outTargets[e], timeTo[v] + outWeights[e], outRoads[e]);
         }
     }
     if (shortestTime != numeric_limits<double>::infinity()) {
-        stack<RoadSegment*> stk;
-        for (RoadSegment *r = roadTo[shortestPathDestinationID]; r != nullptr; r = roadTo[r->getSource()->getID()]) {
-            stk.push(r);
-        }
-        assert(!stk.empty() && "no path for car to reach destination from sources");
-        shortestPathSourceID = stk.top()->getSource()->getID();
-        while (!stk.empty()) {
-            shortestPath.push_back(stk.top());
-            stk.pop();
+        shortestPathDestinationID = view.getIntersection(destination)->getID();
+        // the path is built backwards from the destination into the reused vector, then reversed
+        for (int e = roadTo[destination]; e != -1; e = roadTo[view.getSource(e)]) {
+            shortestPath.push_back(view.getRoadSegment(e));
         }
+        assert(!shortestPath.empty() && "no path for car to reach destination from sources");
+        reverse(shortestPath.begin(), shortestPath.end());
+        shortestPathSourceID = shortestPath.front()->getSource()->getID();
     }
 }
 
@@ -46,33 +87,42 @@ DijkstraDirectedSP::DijkstraDirectedSP(WeightedDigraph *G, vector<int> &sourceID
 DijkstraDirectedSP::~DijkstraDirectedSP() {}
 
 /**
- * Performs Dijkstra's Single Source Shortest Path Algorithm
- * @param G the Weighted Directed Graph
- * @param sourceIDs the intersection IDs of the sources
- * @param initialTime the initial time to each of the sources
+ * Starts a new search by moving to the next stamp, which invalidates the entries of the previous search without
+ * touching them. The scratch arrays only grow when the city has more intersections than before.
+ * @param V the number of intersections in the frozen view
  */
-void DijkstraDirectedSP::dijkstra(WeightedDigraph *G, vector<int> &sourceIDs, vector<double> &initialTime) {
-    priority_queue<pair<double, int>, vector<pair<double, int>> , greater<pair<double, int>>> pq;
-    for (pair<int, Intersection*> i : G->getIntersections()) {
-        timeTo[i.first] = numeric_limits<double>::infinity();
-    }
-    for (int s = 0; s < sourceIDs.size(); s++) {
-        timeTo[sourceIDs[s]] = initialTime[s];
-        roadTo[sourceIDs[s]] = nullptr;
-        pq.push({timeTo[sourceIDs[s]], sourceIDs[s]});
+void DijkstraDirectedSP::prepare(int V) {
+    pq.clear();
+    if ((int) reached.size() < V) {
+        timeTo.resize(V);
+        roadTo.resize(V);
+        reached.resize(V, 0);
+        excessAt.resize(V);
+        destinationStamp.resize(V, 0);
+        pq.reserve(V);
     }
-    while (!pq.empty()) {
-        int v = pq.top().second;
-        pq.pop();
-        for (pair<int, RoadSegment*> r : G->getIntersection(v)->getOutboundRoads()) {
-            int w = r.second->getDestination()->getID();
-            if (timeTo[w] > timeTo[v] + r.second->getExpectedTime()) {
-                timeTo[w] = timeTo[v] + r.second->getExpectedTime();
-                roadTo[w] = r.second;
-                pq.push({timeTo[w], w});
-            }
-        }
+    if (stamp == numeric_limits<int>::max()) { // the stamps wrapped around, so the old ones have to be cleared
+        fill(reached.begin(), reached.end(), 0);
+        fill(destinationStamp.begin(), destinationStamp.end(), 0);
+        stamp = 0;
     }
+    stamp++;
+}
+
+/**
+ * Records a path to an intersection if it is shorter than the shortest path found so far.
+ * @param v the index of the intersection
+ * @param time the time to reach the intersection on the path
+ * @param road the index of the last road on the path, -1 if the intersection is a source
+ */
+void DijkstraDirectedSP::relax(int v, double time, int road) {
+    if (reached[v] == stamp && timeTo[v] <= time) return;
+    bool queued = reached[v] == stamp && pq.contains(v);
+    reached[v] = stamp;
+    timeTo[v] = time;
+    roadTo[v] = road;
+    if (queued) pq.decreaseKey(v, time);
+    else pq.push(v, time);
 }
 
 /**
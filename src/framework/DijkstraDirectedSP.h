@@ -2,25 +2,35 @@
 #define DIJKSTRADIRECTEDSP_H_
 
 #include <vector>
-#include <unordered_map>
 #include "Forward.h"
 #include "RoadSegment.h"
 #include "Intersection.h"
 #include "WeightedDigraph.h"
+#include "../misc/IndexMinPQ.h"
 
 struct DijkstraDirectedSP {
 private:
-    std::unordered_map<int, double> timeTo;
-    std::unordered_map<int, RoadSegment*> roadTo;
+    // the scratch arrays are indexed by the intersection index in the frozen view, and an entry is only valid
+    // if its stamp matches the current search, so nothing has to be reset between searches
+    std::vector<double> timeTo; // the shortest time to each intersection found so far
+    std::vector<int> roadTo; // the index of the last road on the shortest path to each intersection, -1 if there is none
+    std::vector<int> reached; // the stamp of the last search that reached each intersection
+    std::vector<double> excessAt; // the smallest excess time of each possible destination intersection
+    std::vector<int> destinationStamp; // the stamp of the last search that had each intersection as a destination
+    int stamp; // the stamp of the current search
+    IndexMinPQ pq; // the intersections that have been reached but not visited
     int shortestPathSourceID;
     int shortestPathDestinationID;
     double shortestTime;
     std::vector<RoadSegment*> shortestPath;
 
-    void dijkstra(WeightedDigraph *G, std::vector<int> &sourceIDs, std::vector<double> &initialTime);
+    void prepare(int V);
+    void relax(int v, double time, int road);
 
 public:
+    DijkstraDirectedSP();
     DijkstraDirectedSP(WeightedDigraph *G, std::vector<int> &sourceIDs, std::vector<double> &initialTime, std::vector<int> &destinationIDs, std::vector<double> &excessTime);
+    void search(WeightedDigraph *G, std::vector<int> &sourceIDs, std::vector<double> &initialTime, std::vector<int> &destinationIDs, std::vector<double> &excessTime);
     ~DijkstraDirectedSP();
     bool hasPath() const;
     double getShortestTime() const;
@@ -0,0 +1,37 @@
+#include "DijkstraRouter.h"
+#include "DijkstraDirectedSP.h"
+
+using namespace std;
+
+/**
+ * Initializes the DijkstraRouter given a Weighted Directed Graph.
+ * @param G the Weighted Directed Graph that the router will find paths in
+ */
+DijkstraRouter::DijkstraRouter(WeightedDigraph *G) : Router(G) {}
+
+/**
+ * Deconstructs the DijkstraRouter.
+ */
+DijkstraRouter::~DijkstraRouter() {}
+
+/**
+ * Returns the name of the router.
+ */
+const char *DijkstraRouter::getName() const { return "dijkstra"; }
+
+/**
+ * Finds the fastest path from one of the sources to one of the destinations.
+ * @param sourceIDs the intersection IDs of the sources
+ * @param initialTime the initial times to each of the sources
+ * @param destinationIDs the intersection IDs of the possible destinations
+ * @param excessTime the extra time required for each of the possible destinations
+ * @param path the path that is found
+ */
+void DijkstraRouter::route(vector<int> &sourceIDs, vector<double> &initialTime, vector<int> &destinationIDs, vector<double> &excessTime, ShortestPath &path) {
+    static thread_local DijkstraDirectedSP search; // reused by every search on this thread
+    search.search(G, sourceIDs, initialTime, destinationIDs, excessTime);
+    path.time = search.getShortestTime();
+    path.sourceID = search.getSourceID();
+    path.destinationID = search.getDestinationID();
+    path.roads.assign(search.getShortestPath().begin(), search.getShortestPath().end());
+}
@@ -0,0 +1,18 @@
+#ifndef DIJKSTRAROUTER_H_
+#define DIJKSTRAROUTER_H_
+
+#include "Router.h"
+
+/**
+ * Routes cars with Dijkstra's algorithm.
+ */
+struct DijkstraRouter : public Router {
+public:
+    DijkstraRouter(WeightedDigraph *G);
+    ~DijkstraRouter();
+    const char *getName() const;
+    void route(std::vector<int> &sourceIDs, std::vector<double> &initialTime, std::vector<int> &destinationIDs,
+            std::vector<double> &excessTime, ShortestPath &path);
+};
+
+#endif
@@ -9,5 +9,28 @@ struct Intersection;
 struct WeightedDigraph;
 struct DijkstraDirectedSP;
 struct Car;
+struct CarStore;
+struct CarPool;
+struct CarHandle;
+struct RouteTable;
+struct GraphView;
+struct Router;
+struct ShortestPath;
+struct ContractionHierarchy;
+struct CHEdge;
+struct CHTriangle;
+struct CachedRouter;
+struct CachedRoute;
+struct SpawnWave;
+struct SpawnTrip;
+struct RerouteService;
+struct Landmarks;
+struct TravelTimeMatrix;
+struct CityFile;
+struct OSMReader;
+struct OSMEdge;
+struct OSMImporter;
+struct SpatialCell;
+struct SpatialIndex;
 
 #endif
\ No newline at end of file
@@ -7,7 +7,28 @@
 #include "TrafficLight.h"
 #include "Intersection.h"
 #include "WeightedDigraph.h"
+#include "GraphView.h"
 #include "DijkstraDirectedSP.h"
+#include "AStarDirectedSP.h"
+#include "Router.h"
+#include "DijkstraRouter.h"
+#include "AStarRouter.h"
+#include "Landmarks.h"
+#include "ALTRouter.h"
+#include "ContractionHierarchy.h"
+#include "ContractionHierarchySP.h"
+#include "ContractionHierarchyRouter.h"
+#include "CustomizableHierarchyRouter.h"
+#include "CachedRouter.h"
 #include "Car.h"
+#include "CarStore.h"
+#include "CarPool.h"
+#include "RouteTable.h"
+#include "SpawnWave.h"
+#include "RerouteService.h"
+#include "TravelTimeMatrix.h"
+#include "CityFile.h"
+#include "OSMImporter.h"
+#include "SpatialIndex.h"
 
 #endif
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <assert.h>
+#include "GraphView.h"
+#include "WeightedDigraph.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty snapshot that has not been taken.
+ */
+GraphView::GraphView() {
+    epoch = -1;
+    maxSpeedLimit = 0.0;
+}
+
+/**
+ * Deconstructs the snapshot.
+ */
+GraphView::~GraphView() {}
+
+/**
+ * Returns the position of a point along a Hilbert curve that fills a square grid. Points that are close on the curve
+ * are close in the grid.
+ * @param x the column of the point
+ * @param y the row of the point
+ */
+static unsigned long long hilbertIndex(unsigned x, unsigned y) {
+    const unsigned n = 1u << GRAPH_VIEW_HILBERT_ORDER;
+    unsigned long long d = 0;
+    for (unsigned s = n / 2; s > 0; s /= 2) {
+        unsigned rx = (x & s) > 0, ry = (y & s) > 0;
+        d += (unsigned long long) s * s * ((3 * rx) ^ ry);
+        // rotates the quadrant so the curve inside it starts where the last quadrant ended
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            swap(x, y);
+        }
+    }
+    return d;
+}
+
+/**
+ * Takes a snapshot of a graph and assigns the index of every intersection and road segment in it. Intersections
+ * are numbered in the order of their locations along a Hilbert curve, so intersections that are near each other
+ * have nearby indices, and road segments are numbered in the order of their source and then destination. The road
+ * segments leaving an intersection are then next to each other, and next to the road segments of its neighbours,
+ * which keeps the arrays read by a search and by an iteration in the cache.
+ * @param G the Weighted Directed Graph
+ * @param epoch the current epoch of the graph
+ */
+void GraphView::build(WeightedDigraph *G, long long epoch) {
+    this->epoch = epoch;
+    intersections.clear();
+    double minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+    for (pair<int, Intersection*> i : G->getIntersections()) {
+        intersections.push_back(i.second);
+        minX = min(minX, i.second->getLocation().x);
+        minY = min(minY, i.second->getLocation().y);
+        maxX = max(maxX, i.second->getLocation().x);
+        maxY = max(maxY, i.second->getLocation().y);
+    }
+    double cells = (1u << GRAPH_VIEW_HILBERT_ORDER) - 1;
+    double scale = cells / max(max(maxX - minX, maxY - minY), EPS);
+    vector<pair<unsigned long long, Intersection*>> order;
+    order.reserve(intersections.size());
+    for (Intersection *i : intersections) {
+        unsigned x = (unsigned) ((i->getLocation().x - minX) * scale);
+        unsigned y = (unsigned) ((i->getLocation().y - minY) * scale);
+        order.push_back(make_pair(hilbertIndex(x, y), i));
+    }
+    // ties are broken by ID, so the numbering does not depend on the order of the hash table
+    sort(order.begin(), order.end(), [] (const pair<unsigned long long, Intersection*> &a, const pair<unsigned long long, Intersection*> &b) {
+        return a.first != b.first ? a.first < b.first : a.second->getID() < b.second->getID();
+    });
+    xs.resize(intersections.size());
+    ys.resize(intersections.size());
+    for (int v = 0; v < (int) intersections.size(); v++) {
+        intersections[v] = order[v].second;
+        intersections[v]->setIndex(v);
+        xs[v] = intersections[v]->getLocation().x;
+        ys[v] = intersections[v]->getLocation().y;
+    }
+    int V = intersections.size(), E = G->countRoadSegments();
+    roads.resize(E);
+    roadSources.resize(E);
+    roadTargets.resize(E);
+    outStart.assign(V + 1, 0);
+    inStart.assign(V + 1, 0);
+    maxSpeedLimit = 0.0;
+    for (int e = 0; e < E; e++) {
+        roads[e] = G->getRoadSegment(G->getRoadSegmentID(e));
+    }
+    stable_sort(roads.begin(), roads.end(), [] (RoadSegment *a, RoadSegment *b) {
+        int u = a->getSource()->getIndex(), v = b->getSource()->getIndex();
+        return u != v ? u < v : a->getDestination()->getIndex() < b->getDestination()->getIndex();
+    });
+    for (int e = 0; e < E; e++) {
+        maxSpeedLimit = max(maxSpeedLimit, roads[e]->getSpeedLimit());
+        roads[e]->setIndex(e);
+        roadSources[e] = roads[e]->getSource()->getIndex();
+        roadTargets[e] = roads[e]->getDestination()->getIndex();
+        outStart[roadSources[e] + 1]++;
+        inStart[roadTargets[e] + 1]++;
+    }
+    for (int v = 0; v < V; v++) {
+        outStart[v + 1] += outStart[v];
+        inStart[v + 1] += inStart[v];
+    }
+    // counting sort of the road segments by source and by destination, which keeps them in index order
+    vector<int> outNext(outStart.begin(), outStart.end() - 1), inNext(inStart.begin(), inStart.end() - 1);
+    outRoads.resize(E);
+    outTargets.resize(E);
+    outWeights.resize(E);
+    inRoads.resize(E);
+    for (int e = 0; e < E; e++) {
+        int o = outNext[roadSources[e]]++;
+        outRoads[o] = e;
+        outTargets[o] = roadTargets[e];
+        outWeights[o] = roads[e]->getExpectedTime();
+        inRoads[inNext[roadTargets[e]]++] = e;
+    }
+}
+
+/**
+ * Returns the epoch of the graph when the snapshot was taken, or -1 if it has not been taken.
+ */
+long long GraphView::getEpoch() const { return epoch; }
+
+/**
+ * Returns the number of intersections in the snapshot.
+ */
+int GraphView::countIntersections() const { return intersections.size(); }
+
+/**
+ * Returns the number of road segments in the snapshot.
+ */
+int GraphView::countRoadSegments() const { return roads.size(); }
+
+/**
+ * Returns the intersection with an index.
+ */
+Intersection *GraphView::getIntersection(int index) const { return intersections[index]; }
+
+/**
+ * Returns the road segment with an index.
+ */
+RoadSegment *GraphView::getRoadSegment(int index) const { return roads[index]; }
+
+/**
+ * Returns the road segments in order of their index.
+ */
+const vector<RoadSegment*> &GraphView::getRoadSegments() const { return roads; }
+
+/**
+ * Returns the array of the x-coordinate of each intersection.
+ */
+const double *GraphView::getXs() const { return xs.data(); }
+
+/**
+ * Returns the array of the y-coordinate of each intersection.
+ */
+const double *GraphView::getYs() const { return ys.data(); }
+
+/**
+ * Returns the largest speed limit of any road segment, which bounds how fast a car can travel in a straight line.
+ */
+double GraphView::getMaxSpeedLimit() const { return maxSpeedLimit; }
+
+/**
+ * Returns the index of the source intersection of a road segment.
+ * @param road the index of the road segment
+ */
+int GraphView::getSource(int road) const { return roadSources[road]; }
+
+/**
+ * Returns the index of the destination intersection of a road segment.
+ * @param road the index of the road segment
+ */
+int GraphView::getTarget(int road) const { return roadTargets[road]; }
+
+/**
+ * Returns the first out edge of an intersection.
+ * @param v the index of the intersection
+ */
+int GraphView::outBegin(int v) const { return outStart[v]; }
+
+/**
+ * Returns one past the last out edge of an intersection.
+ * @param v the index of the intersection
+ */
+int GraphView::outEnd(int v) const { return outStart[v + 1]; }
+
+/**
+ * Returns the first in edge of an intersection.
+ * @param v the index of the intersection
+ */
+int GraphView::inBegin(int v) const { return inStart[v]; }
+
+/**
+ * Returns one past the last in edge of an intersection.
+ * @param v the index of the intersection
+ */
+int GraphView::inEnd(int v) const { return inStart[v + 1]; }
+
+/**
+ * Returns the array of the road segment index of each out edge.
+ */
+const int *GraphView::getOutRoads() const { return outRoads.data(); }
+
+/**
+ * Returns the array of the destination intersection index of each out edge.
+ */
+const int *GraphView::getOutTargets() const { return outTargets.data(); }
+
+/**
+ * Returns the array of the expected time of each out edge.
+ */
+const double *GraphView::getOutWeights() const { return outWeights.data(); }
+
+/**
+ * Returns the array of the road segment index of each in edge.
+ */
+const int *GraphView::getInRoads() const { return inRoads.data(); }
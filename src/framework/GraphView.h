@@ -0,0 +1,58 @@
+#ifndef GRAPHVIEW_H_
+#define GRAPHVIEW_H_
+
+#include <vector>
+#include "Forward.h"
+
+#define GRAPH_VIEW_HILBERT_ORDER 16 // the Hilbert curve that orders the intersections fills a grid of 2^16 by 2^16 cells
+
+/**
+ * An immutable compressed sparse row snapshot of a weighted directed graph. Intersections and road segments are
+ * numbered with contiguous indices, and the road segments leaving (or entering) each intersection are stored
+ * contiguously, so walking the graph does not need any hashing. Both are numbered by their location in the city
+ * rather than by when they were created. The snapshot is only valid until the graph is changed, which is tracked
+ * by the epoch of the graph.
+ */
+struct GraphView {
+private:
+    long long epoch; // the epoch of the graph when the snapshot was taken, -1 if it has not been taken
+    std::vector<Intersection*> intersections; // the intersection with each index
+    std::vector<RoadSegment*> roads; // the road segment with each index
+    std::vector<double> xs; // the x-coordinate of each intersection
+    std::vector<double> ys; // the y-coordinate of each intersection
+    double maxSpeedLimit; // the largest speed limit of any road segment
+    std::vector<int> roadSources; // the index of the source intersection of each road segment
+    std::vector<int> roadTargets; // the index of the destination intersection of each road segment
+    std::vector<int> outStart; // the edges leaving intersection v are [outStart[v], outStart[v + 1])
+    std::vector<int> outRoads; // the index of the road segment of each out edge
+    std::vector<int> outTargets; // the index of the destination intersection of each out edge
+    std::vector<double> outWeights; // the expected time of each out edge
+    std::vector<int> inStart; // the edges entering intersection v are [inStart[v], inStart[v + 1])
+    std::vector<int> inRoads; // the index of the road segment of each in edge
+
+public:
+    GraphView();
+    ~GraphView();
+    void build(WeightedDigraph *G, long long epoch);
+    long long getEpoch() const;
+    int countIntersections() const;
+    int countRoadSegments() const;
+    Intersection *getIntersection(int index) const;
+    RoadSegment *getRoadSegment(int index) const;
+    const std::vector<RoadSegment*> &getRoadSegments() const;
+    const double *getXs() const;
+    const double *getYs() const;
+    double getMaxSpeedLimit() const;
+    int getSource(int road) const;
+    int getTarget(int road) const;
+    int outBegin(int v) const;
+    int outEnd(int v) const;
+    int inBegin(int v) const;
+    int inEnd(int v) const;
+    const int *getOutRoads() const;
+    const int *getOutTargets() const;
+    const double *getOutWeights() const;
+    const int *getInRoads() const;
+};
+
+#endif
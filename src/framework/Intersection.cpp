@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <algorithm>
 #include "Intersection.h"
+#include "../misc/CarKernel.h"
 
 #define PI 3.14159265358979323846
 #define EPS 1e-9
@@ -17,11 +18,19 @@ int Intersection::counter = 0; // counter starts at 0
 Intersection::Intersection(double x, double y) {
     this->location = Point2D(x, y);
     id = Intersection::counter++; // assigns an id and increments the counter
+    index = -1;
     currentCycleNumber = 0;
     numberOfCycles = 0;
     leftTurn = true;
     scheduledTime = -1.0;
     timeOfLastCycle = 0.0;
+    compiled = false;
+    exits = 0;
+    words = 0;
+    totalFlow = 0;
+    flowLog = nullptr;
+    flowLogged = false;
+    tablesBuilt = true;
 }
 
 /**
@@ -31,11 +40,19 @@ Intersection::Intersection(double x, double y) {
 Intersection::Intersection(Point2D &location) {
     this->location = Point2D(location.x, location.y);
     id = Intersection::counter++; // assigns an id and increments the counter
+    index = -1;
     currentCycleNumber = 0;
     numberOfCycles = 0;
     leftTurn = true;
     scheduledTime = -1.0;
     timeOfLastCycle = 0.0;
+    compiled = false;
+    exits = 0;
+    words = 0;
+    totalFlow = 0;
+    flowLog = nullptr;
+    flowLogged = false;
+    tablesBuilt = true;
 }
 
 /**
@@ -48,11 +65,22 @@ Intersection::~Intersection() {}
  */
 int Intersection::getID() const { return id; }
 
+/**
+ * Returns the index of the intersection in the frozen view of the graph.
+ */
+int Intersection::getIndex() const { return index; }
+
+/**
+ * Sets the index of the intersection in the frozen view of the graph.
+ */
+void Intersection::setIndex(int index) { this->index = index; }
+
 /**
  * Adds a RoadSegment to the intersection
  * @return false if the road segment is already in the intersection, true otherwise
  */
 bool Intersection::add(RoadSegment *r) {
+    buildTables();
     if (inboundRoads.count(r->getID()) || outboundRoads.count(r->getID()) ) return false;
     if (r->getDestination()->getID() == this->id) {
         inboundRoads[r->getID()] = r;
@@ -67,6 +95,7 @@ bool Intersection::add(RoadSegment *r) {
     if (r->getDestination()->getID() != this->id && r->getSource()->getID() != this->id) {
         assert(false && "this road segment does not start or end at this intersection");
     }
+    compiled = false;
     return true;
 }
 
@@ -75,95 +104,89 @@ bool Intersection::add(RoadSegment *r) {
  * @return false if the road segment was not in the intersection, true otherwise
  */
 bool Intersection::remove(RoadSegment *r) {
+    buildTables();
     if (inboundRoads.count(r->getID()) == 0 && outboundRoads.count(r->getID()) == 0) return false;
     if (inboundRoads.count(r->getID())) {
         inboundRoads.erase(r->getID());
         inboundIntersections.erase(r->getSource()->getID());
         roadFrom.erase(r->getSource()->getID());
         for (int to : adjacentOut[r->getID()]) { // removing all paths that lead out from the road segment
-            // removing the linked traffic lights
-            int lightID = lights[make_pair(r->getID(), to)]->getID();
-            for (int link : linksLeft[lightID]) {
-                linksStraight[link].erase(lightID);
-            }
-            linksLeft.erase(lightID);
-            for (int link : linksStraight[lightID]) {
-                linksStraight[link].erase(lightID);
-            }
-            linksStraight.erase(lightID);
-            for (int link : linksRight[lightID]) {
-                linksStraight[link].erase(lightID);
-            }
-            linksRight.erase(lightID);
-            // removing the traffic light
-            lightFromID.erase(lightID);
-            int cycleNum = cycleNumber[lightID];
-            cycleToLight[cycleNum].erase(lightID);
-            if (cycleToLight[cycleNum].size() == 0) {
-                for (int light : cycleToLight.back()) {
-                    cycleToLight[cycleNum].insert(light);
-                    cycleNumber[light] = cycleNum;
-                }
-                cycleToLight[cycleNum].erase(lightID);
-                numberOfCycles--;
-            }
-            cycleNumber.erase(lightID);
-            delete lights[make_pair(r->getID(), to)];
+            removeLight(lights[make_pair(r->getID(), to)]);
             lights.erase(make_pair(r->getID(), to));
             adjacentIn[to].erase(r->getID());
         }
         adjacentOut.erase(r->getID());
     }
-    if (outboundRoads.count(r->getID())) { // removing all paths that lead into the road segment
+    if (outboundRoads.count(r->getID())) {
         outboundRoads.erase(r->getID());
         outboundIntersections.erase(r->getDestination()->getID());
         roadTo.erase(r->getDestination()->getID());
-        for (int from : adjacentIn[r->getID()]) {
-            // removing the linked traffic lights
-            int lightID = lights[make_pair(from, r->getID())]->getID();
-            for (int link : linksLeft[lightID]) {
-                linksStraight[link].erase(lightID);
-            }
-            linksLeft.erase(lightID);
-            for (int link : linksStraight[lightID]) {
-                linksStraight[link].erase(lightID);
-            }
-            linksStraight.erase(lightID);
-            for (int link : linksRight[lightID]) {
-                linksStraight[link].erase(lightID);
-            }
-            linksRight.erase(lightID);
-            // removing the traffic light
-            lightFromID.erase(lightID);
-            int cycleNum = cycleNumber[lightID];
-            cycleToLight[cycleNum].erase(lightID);
-            if (cycleToLight[cycleNum].size() == 0) {
-                for (int light : cycleToLight.back()) {
-                    cycleToLight[cycleNum].insert(light);
-                    cycleNumber[light] = cycleNum;
-                }
-                cycleToLight[cycleNum].erase(lightID);
-                numberOfCycles--;
-            }
-            cycleNumber.erase(lightID);
-            delete lights[make_pair(from, r->getID())];
+        for (int from : adjacentIn[r->getID()]) { // removing all paths that lead into the road segment
+            removeLight(lights[make_pair(from, r->getID())]);
             lights.erase(make_pair(from, r->getID()));
             adjacentOut[from].erase(r->getID());
         }
         adjacentIn.erase(r->getID());
     }
+    compiled = false;
     return true;
 }
 
+/**
+ * Removes a traffic light with its links, and deletes it. If its cycle is left without lights, the last cycle takes
+ * its number.
+ * @param t the traffic light
+ */
+void Intersection::removeLight(TrafficLight *t) {
+    int lightID = t->getID();
+    // a straight light keeps its links to other lights in the three maps, and every light it is linked to keeps the
+    // link back to it in linksStraight
+    for (int link : linksLeft[lightID]) linksStraight[link].erase(lightID);
+    for (int link : linksRight[lightID]) linksStraight[link].erase(lightID);
+    for (int link : linksStraight[lightID]) {
+        linksStraight[link].erase(lightID);
+        auto left = linksLeft.find(link);
+        if (left != linksLeft.end()) left->second.erase(lightID);
+        auto right = linksRight.find(link);
+        if (right != linksRight.end()) right->second.erase(lightID);
+    }
+    linksLeft.erase(lightID);
+    linksStraight.erase(lightID);
+    linksRight.erase(lightID);
+    lightFromID.erase(lightID);
+    auto cycle = cycleNumber.find(lightID);
+    if (cycle != cycleNumber.end()) {
+        int cycleNum = cycle->second;
+        cycleNumber.erase(cycle);
+        cycleToLight[cycleNum].erase(lightID);
+        if (cycleToLight[cycleNum].empty()) {
+            int last = numberOfCycles - 1;
+            if (cycleNum != last) {
+                for (int light : cycleToLight[last]) {
+                    cycleToLight[cycleNum].insert(light);
+                    cycleNumber[light] = cycleNum;
+                }
+            }
+            cycleToLight.pop_back();
+            numberOfCycles--;
+            if (currentCycleNumber >= numberOfCycles) currentCycleNumber = 0;
+        }
+    }
+    delete t;
+}
+
 /**
  * Connects two roads with a traffic light with a specified type
  * @param from the ID of the source road segment
  * @param to the ID of the destination road segment
  * @param type the type of turn the traffic light controls (0 for left, 1 for straight, 2 for right, 3 for u turn)
+ * @return the new traffic light
  */
-void Intersection::connect(int from, int to, int type) {
+TrafficLight *Intersection::connect(int from, int to, int type) {
+    buildTables();
     assert(inboundRoads.count(from) && "no inbound road exists in the intersection");
     assert(outboundRoads.count(to) && "no outbound road exists in the intersection");
+    compiled = false;
     adjacentOut[from].insert(to);
     adjacentIn[to].insert(from);
     TrafficLight *t = new TrafficLight(inboundRoads[from], outboundRoads[to], type);
@@ -175,6 +198,7 @@ void Intersection::connect(int from, int to, int type) {
         cycleToLight[numberOfCycles].insert(t->getID());
         numberOfCycles++;
     }
+    return t;
 }
 
 /**
@@ -184,6 +208,8 @@ void Intersection::connect(int from, int to, int type) {
  * @param B the ID of the other traffic light
  */
 void Intersection::link(int A, int B) {
+    buildTables();
+    compiled = false;
     int AType = lightFromID[A]->getType();
     assert(AType == STRAIGHT && "light A must be of type straight");
     int BType = lightFromID[B]->getType();
@@ -217,9 +243,11 @@ void Intersection::link(int A, int B) {
 }
 
 /**
- * Iterates through all the road segements connected to this intersection and connects and links corresponding traffic lights;
+ * Iterates through all the road segements connected to this intersection and connects and links corresponding traffic lights,
+ * and compiles the phase table of the lights.
  */
 void Intersection::autoConnectAndLink() {
+    buildTables();
     unordered_map<int, int> outTypes;
     vector<RoadSegment*> outSorted;
     vector<pair<int, int>> straightLights;
@@ -282,8 +310,195 @@ void Intersection::autoConnectAndLink() {
             }
         }
     }
+    compile();
+}
+
+/**
+ * Adds a link between two lights to the maps of the links, without changing the cycles of the lights or the phase
+ * table.
+ * @param A the ID of one traffic light, which must be of type straight
+ * @param B the ID of the other traffic light
+ */
+void Intersection::addLink(int A, int B) {
+    assert(lightFromID.count(A) && lightFromID.count(B) && "there is no light in this intersection with the specified ID");
+    assert(lightFromID[A]->getType() == STRAIGHT && "light A must be of type straight");
+    int BType = lightFromID[B]->getType();
+    if (BType == LEFT || BType == UTURN) {
+        linksLeft[A].insert(B);
+        linksStraight[B].insert(A);
+    } else if (BType == STRAIGHT) {
+        linksStraight[A].insert(B);
+        linksStraight[B].insert(A);
+    } else {
+        linksRight[A].insert(B);
+        linksStraight[B].insert(A);
+    }
+}
+
+/**
+ * Takes a phase table that was compiled before, such as one saved in a city file, instead of compiling it from the
+ * lights, links and cycles. The intersection must not have any roads, and its roads and lights are not added to the
+ * maps by ID, which are only built when something needs them, such as changing the intersection or drawing its
+ * lights. The lights take the states in the green mask.
+ * @param entering the roads entering the intersection, in the order of their entry slots
+ * @param leaving the roads leaving the intersection, in the order of their exit slots
+ * @param turns the light of each pair of entry and exit slots, at entry * exits + exit, nullptr if there is none
+ * @param masks the green mask, followed by the mask of the straight lights and then the left lights of each cycle
+ * @param cycles the number of cycles
+ * @param links the links between the lights, as returned by getLinks()
+ */
+void Intersection::adopt(const vector<RoadSegment*> &entering, const vector<RoadSegment*> &leaving, const vector<TrafficLight*> &turns,
+                         const vector<uint64_t> &masks, int cycles, const vector<pair<int, int>> &links) {
+    assert(inboundRoads.empty() && outboundRoads.empty() && slotRoads.empty() && "the intersection already has roads");
+    exits = leaving.size();
+    int bits = entering.size() * exits;
+    words = getMaskWords(bits);
+    assert((int) turns.size() == bits && (int) masks.size() == (1 + 2 * cycles) * words && "the phase table does not match its roads");
+    slotRoads.reserve(entering.size() + leaving.size());
+    for (int i = 0; i < (int) entering.size(); i++) {
+        entering[i]->setEntrySlot(i);
+        slotRoads.push_back(entering[i]);
+    }
+    for (int j = 0; j < exits; j++) {
+        leaving[j]->setExitSlot(j);
+        slotRoads.push_back(leaving[j]);
+    }
+    turnLights = turns;
+    greenMask.assign(masks.begin(), masks.begin() + words);
+    phaseMasks.assign(masks.begin() + words, masks.end());
+    for (int bit = 0; bit < bits; bit++) {
+        if (turnLights[bit] != nullptr) turnLights[bit]->setState((greenMask[bit / MASK_BITS] >> (bit % MASK_BITS) & 1) ? GREEN : RED);
+    }
+    numberOfCycles = cycles;
+    currentCycleNumber = 0;
+    entryCycles.assign(entering.size(), vector<int>());
+    cycleFlow.assign(numberOfCycles, 0);
+    totalFlow = 0;
+    for (int c = 0; c < numberOfCycles; c++) {
+        const uint64_t *straights = &phaseMasks[c * 2 * words];
+        for (int w = 0; w < words; w++) {
+            for (uint64_t m = straights[w]; m != 0; m &= m - 1) {
+                RoadSegment *from = turnLights[w * MASK_BITS + getLowestBit(m)]->getFrom();
+                entryCycles[from->getEntrySlot()].push_back(c);
+                cycleFlow[c] += from->getFlow();
+                totalFlow += from->getFlow();
+            }
+        }
+    }
+    adoptedLinks = links;
+    tablesBuilt = false;
+    compiled = true;
 }
 
+/**
+ * Returns the phase table of the intersection in the form adopt() takes, compiling it if it is out of date.
+ * @param entering set to the roads entering the intersection, in the order of their entry slots
+ * @param leaving set to the roads leaving the intersection, in the order of their exit slots
+ * @param turns set to the light of each pair of entry and exit slots, nullptr if there is none
+ * @param masks set to the green mask, followed by the mask of the straight lights and then the left lights of each cycle
+ */
+void Intersection::getPhaseTable(vector<RoadSegment*> &entering, vector<RoadSegment*> &leaving, vector<TrafficLight*> &turns,
+                                 vector<uint64_t> &masks) {
+    if (!compiled) compile();
+    entering.assign(indegree(), nullptr);
+    leaving.assign(exits, nullptr);
+    if (tablesBuilt) {
+        for (pair<int, RoadSegment*> in : inboundRoads) entering[in.second->getEntrySlot()] = in.second;
+        for (pair<int, RoadSegment*> out : outboundRoads) leaving[out.second->getExitSlot()] = out.second;
+    } else {
+        entering.assign(slotRoads.begin(), slotRoads.end() - exits);
+        leaving.assign(slotRoads.end() - exits, slotRoads.end());
+    }
+    turns = turnLights;
+    masks = greenMask;
+    masks.insert(masks.end(), phaseMasks.begin(), phaseMasks.end());
+}
+
+/**
+ * Builds the maps of the roads, lights, links and cycles by ID from an adopted phase table, if they have not been
+ * built. The phase table stays compiled, since it already matches them.
+ */
+void Intersection::buildTables() {
+    if (tablesBuilt) return;
+    tablesBuilt = true;
+    int entries = slotRoads.size() - exits;
+    for (int i = 0; i < (int) slotRoads.size(); i++) {
+        RoadSegment *r = slotRoads[i];
+        if (i < entries) {
+            inboundRoads[r->getID()] = r;
+            inboundIntersections[r->getSource()->getID()] = r->getSource();
+            roadFrom[r->getSource()->getID()] = r;
+        } else {
+            outboundRoads[r->getID()] = r;
+            outboundIntersections[r->getDestination()->getID()] = r->getDestination();
+            roadTo[r->getDestination()->getID()] = r;
+        }
+    }
+    for (TrafficLight *t : turnLights) {
+        if (t == nullptr) continue;
+        int from = t->getFrom()->getID(), to = t->getTo()->getID();
+        adjacentOut[from].insert(to);
+        adjacentIn[to].insert(from);
+        lights[make_pair(from, to)] = t;
+        lightFromID[t->getID()] = t;
+    }
+    cycleToLight.assign(numberOfCycles, unordered_set<int>());
+    for (int c = 0; c < numberOfCycles; c++) {
+        const uint64_t *straights = &phaseMasks[c * 2 * words];
+        for (int w = 0; w < words; w++) {
+            for (uint64_t m = straights[w]; m != 0; m &= m - 1) {
+                int light = turnLights[w * MASK_BITS + getLowestBit(m)]->getID();
+                cycleNumber[light] = c;
+                cycleToLight[c].insert(light);
+            }
+        }
+    }
+    for (pair<int, int> l : adoptedLinks) {
+        addLink(l.first, l.second);
+    }
+    slotRoads = vector<RoadSegment*>();
+    adoptedLinks = vector<pair<int, int>>();
+}
+
+/**
+ * Returns every link between the lights of the intersection as a pair of light IDs. The first light of each pair is
+ * straight, and links between two straight lights are only returned once, so calling restoreLink() with each pair
+ * restores the links.
+ * @param links the links that are returned
+ */
+void Intersection::getLinks(vector<pair<int, int>> &links) {
+    buildTables();
+    links.clear();
+    for (const pair<const int, unordered_set<int>> &l : linksLeft) {
+        for (int B : l.second) links.push_back(make_pair(l.first, B));
+    }
+    for (const pair<const int, unordered_set<int>> &l : linksRight) {
+        for (int B : l.second) links.push_back(make_pair(l.first, B));
+    }
+    for (const pair<const int, unordered_set<int>> &l : linksStraight) {
+        if (lightFromID.at(l.first)->getType() != STRAIGHT) continue;
+        for (int B : l.second) {
+            if (lightFromID.at(B)->getType() == STRAIGHT && l.first < B) links.push_back(make_pair(l.first, B));
+        }
+    }
+    sort(links.begin(), links.end());
+}
+
+/**
+ * Returns the cycle number of a straight light, or -1 if the light is not straight.
+ * @param light the ID of the light
+ */
+int Intersection::getCycleNumber(int light) {
+    buildTables();
+    auto it = cycleNumber.find(light);
+    return it == cycleNumber.end() ? -1 : it->second;
+}
+
+/**
+ * Returns the number of cycles in the intersection.
+ */
+int Intersection::countCycles() const { return numberOfCycles; }
+
 /**
  * Helper function for assign. Ensures that all linked lights get assigned the same cycle number.
  */
@@ -313,51 +528,88 @@ void Intersection::autoConnectAndLink() {
 }*/
 
 /**
- * Cycles the traffic lights in the intersection.
+ * Compiles the lights, links and cycles into the phase table, which cycle() and getLightBetween() read instead of the
+ * maps. Each road entering and leaving the intersection is given a slot, and the light of each pair of slots is given
+ * the bit entry * exits + exit in the masks. Each cycle has a mask of its straight lights and a mask of the left
+ * lights linked to them, so changing the lights is a few operations on words instead of walking sets of IDs. The
+ * flow into the straight lights of each cycle is counted here and then kept up to date by addInboundFlow().
+ */
+void Intersection::compile() {
+    assert(tablesBuilt && "an adopted phase table is only replaced after the maps are built");
+    vector<RoadSegment*> entering, leaving;
+    for (pair<int, RoadSegment*> in : inboundRoads) entering.push_back(in.second);
+    for (pair<int, RoadSegment*> out : outboundRoads) leaving.push_back(out.second);
+    auto byID = [] (RoadSegment *a, RoadSegment *b) { return a->getID() < b->getID(); };
+    sort(entering.begin(), entering.end(), byID);
+    sort(leaving.begin(), leaving.end(), byID);
+    for (int i = 0; i < (int) entering.size(); i++) entering[i]->setEntrySlot(i);
+    for (int j = 0; j < (int) leaving.size(); j++) leaving[j]->setExitSlot(j);
+    exits = leaving.size();
+    int bits = entering.size() * exits;
+    words = getMaskWords(bits);
+    auto bitOf = [&] (TrafficLight *t) { return t->getFrom()->getEntrySlot() * exits + t->getTo()->getExitSlot(); };
+    auto set = [] (uint64_t *mask, int bit) { mask[bit / MASK_BITS] |= (uint64_t) 1 << (bit % MASK_BITS); };
+    turnLights.assign(bits, nullptr);
+    greenMask.assign(words, 0);
+    for (pair<int, TrafficLight*> t : lightFromID) {
+        turnLights[bitOf(t.second)] = t.second;
+        if (t.second->getState() == GREEN) set(greenMask.data(), bitOf(t.second));
+    }
+    phaseMasks.assign(numberOfCycles * 2 * words, 0);
+    entryCycles.assign(entering.size(), vector<int>());
+    cycleFlow.assign(numberOfCycles, 0);
+    totalFlow = 0;
+    for (int c = 0; c < numberOfCycles; c++) {
+        uint64_t *straights = &phaseMasks[c * 2 * words];
+        for (int light : cycleToLight[c]) {
+            RoadSegment *from = lightFromID[light]->getFrom();
+            entryCycles[from->getEntrySlot()].push_back(c);
+            cycleFlow[c] += from->getFlow();
+            totalFlow += from->getFlow();
+            set(straights, bitOf(lightFromID[light]));
+            auto left = linksLeft.find(light);
+            if (left == linksLeft.end()) continue;
+            for (int l : left->second) set(straights + words, bitOf(lightFromID[l]));
+        }
+    }
+    compiled = true;
+}
+
+/**
+ * Cycles the traffic lights in the intersection. The lights of the previous and the current cycle are set to red,
+ * and then either the left lights of the current cycle are set to green, if they have not just been, or its straight
+ * lights are set to green and the next cycle becomes the current cycle. Only the lights that change are written.
  */
 void Intersection::cycle(double time) {
     resetScheduledTime();
     timeOfLastCycle = time;
-    unordered_set<int> greens;
-    unordered_set<int> lefts;
-    // sets previous cycle to red
-    for (int light : cycleToLight[(currentCycleNumber + numberOfCycles - 1) % numberOfCycles]) {
-        if (lightFromID[light])
-        lightFromID[light]->setState(RED);
-        for (int left : linksLeft[light]) {
-            lightFromID[left]->setState(RED);
-        }
+    if (!compiled) compile();
+    if (numberOfCycles == 0) return; // the intersection has no straight lights, such as after its roads are removed
+    const uint64_t *previous = &phaseMasks[((currentCycleNumber + numberOfCycles - 1) % numberOfCycles) * 2 * words];
+    const uint64_t *current = &phaseMasks[currentCycleNumber * 2 * words];
+    bool lefts = false, greens = false;
+    for (int w = 0; w < words; w++) {
+        if (!leftTurn && current[words + w] != 0) lefts = true;
+        if (current[w] != 0) greens = true;
     }
-    // sets current cycle to red (to start)
-    for (int light : cycleToLight[currentCycleNumber]) {
-        lightFromID[light]->setState(RED);
-        for (int left : linksLeft[light]) {
-            lightFromID[left]->setState(RED);
+    assert(greens);
+    const uint64_t *next = lefts ? current + words : current;
+    for (int w = 0; w < words; w++) {
+        uint64_t red = previous[w] | previous[words + w] | current[w] | current[words + w];
+        uint64_t green = (greenMask[w] & ~red) | next[w];
+        for (uint64_t changed = green ^ greenMask[w]; changed != 0; changed &= changed - 1) {
+            int bit = getLowestBit(changed);
+            turnLights[w * MASK_BITS + bit]->setState((green >> bit & 1) ? GREEN : RED);
         }
+        greenMask[w] = green;
     }
-    // determins which lights might need to be set to green
-    for (int light : cycleToLight[currentCycleNumber]) {
-        if (lightFromID[light]->getType() == STRAIGHT) greens.insert(light);
-        if (!leftTurn) {
-            for (int left : linksLeft[light]) {
-                lefts.insert(left);
-            }
-        }
-    }
-    assert(greens.size() > 0);
     // if there are left turns that need to be set to green, then all the left turn lights are set to green
     // otherwise, only the straight lights are set to green
-    if (lefts.size() == 0) {
+    if (lefts) {
+        leftTurn = true;
+    } else {
         leftTurn = false;
-        for (int light : greens) {
-            lightFromID[light]->setState(GREEN);
-        }
         currentCycleNumber = (currentCycleNumber + 1) % numberOfCycles;
-    } else {
-        leftTurn = true;
-        for (int light : lefts) {
-            lightFromID[light]->setState(GREEN);
-        }
     }
 }
 
@@ -391,29 +643,50 @@ void Intersection::setScheduledTime(double time) { scheduledTime = time; }
  */
 void Intersection::resetScheduledTime() { scheduledTime = -1.0; } 
 
+/**
+ * Counts a change in the flow of a road entering the intersection towards the cycles of its straight lights. Called
+ * by the road whenever its flow changes. The change is not counted if the phase table is out of date, since the
+ * flows are counted again when it is compiled. The change is recorded in the flow log either way, if there is one.
+ * @param r the road segment entering the intersection
+ * @param value the change in the flow of the road
+ */
+void Intersection::addInboundFlow(const RoadSegment *r, int value) {
+    if (flowLog != nullptr && !flowLogged) {
+        flowLogged = true;
+        flowLog->push_back(id);
+    }
+    if (!compiled) return;
+    for (int c : entryCycles[r->getEntrySlot()]) {
+        cycleFlow[c] += value;
+        totalFlow += value;
+    }
+}
+
+/**
+ * Records the ID of the intersection in a log the next time the flow of one of its inbound roads changes, so the
+ * intersection is only recorded once however many times its flows change. Called again once the ID has been taken
+ * from the log to watch for the next change.
+ * @param log the log to record the ID in, or nullptr to stop recording changes
+ */
+void Intersection::watchFlows(vector<int> *log) {
+    flowLog = log;
+    flowLogged = false;
+}
+
 /**
  * Returns the flow of vehicles in incoming roads that are green.
  */
 int Intersection::getCurrentFlow() {
-    int flow = 0;
-    for (int t : cycleToLight[currentCycleNumber]) {
-        flow += lightFromID[t]->getFrom()->getFlow();
-    }
-    return flow;
+    if (!compiled) compile();
+    return numberOfCycles > 0 ? cycleFlow[currentCycleNumber] : 0;
 }
 
 /**
  * Returns the flow of vehicles in incoming roads that are red.
  */
 int Intersection::getOppositeFlow() {
-    int flow = 0;
-    for (int i = 0; i < numberOfCycles; i++) {
-        if (i == currentCycleNumber) continue;
-        for (int t : cycleToLight[i]) {
-            flow += lightFromID[t]->getFrom()->getFlow();
-        }
-    }
-    return flow;
+    if (!compiled) compile();
+    return numberOfCycles > 0 ? totalFlow - cycleFlow[currentCycleNumber] : 0;
 }
 
 /**
@@ -424,37 +697,50 @@ double Intersection::getTimeOfLastCycle() const { return timeOfLastCycle; }
 /**
  * Returns the number of outbound road segments in this intersection.
  */
-int Intersection::outdegree() const { return outboundRoads.size(); }
+int Intersection::outdegree() const { return tablesBuilt ? outboundRoads.size() : exits; }
 
 /**
  * Returns the number of inbound road segments in this intersection.
  */
-int Intersection::indegree() const { return inboundRoads.size(); }
+int Intersection::indegree() const { return tablesBuilt ? inboundRoads.size() : slotRoads.size() - exits; }
 
 /**
  * Returns an immutable reference to the road segments (and their IDs) coming into the interesection.
  */
-const unordered_map<int, RoadSegment*> &Intersection::getInboundRoads() const { return inboundRoads; }
+const unordered_map<int, RoadSegment*> &Intersection::getInboundRoads() {
+    buildTables();
+    return inboundRoads;
+}
 
 /**
  * Returns an immutable reference to the road segments (and their IDs) going out from the intersection.
  */
-const unordered_map<int, RoadSegment*> &Intersection::getOutboundRoads() const { return outboundRoads; }
+const unordered_map<int, RoadSegment*> &Intersection::getOutboundRoads() {
+    buildTables();
+    return outboundRoads;
+}
 
 /**
  * Returns an immutable reference to the adjacent intersections (and their IDs) that have a road leading into this interesection.
  */
-const unordered_map<int, Intersection*> &Intersection::getInboundIntersections() const { return inboundIntersections; }
+const unordered_map<int, Intersection*> &Intersection::getInboundIntersections() {
+    buildTables();
+    return inboundIntersections;
+}
 
 /**
  * Returns an immutable reference to the adjacent intersections (and their IDs) that have a road leading out from this intersection.
  */
-const unordered_map<int, Intersection*> &Intersection::getOutboundIntersections() const { return outboundIntersections; }
+const unordered_map<int, Intersection*> &Intersection::getOutboundIntersections() {
+    buildTables();
+    return outboundIntersections;
+}
 
 /**
  * Returns true if there is a traffic light between the two road segmetns given their IDs, false otherwise.
  */
 bool Intersection::isConnected(int from, int to) {
+    buildTables();
     assert(inboundRoads.count(from) && outboundRoads.count(to) && "one of the roads is not in the intersection");
     pair<int, int> p = make_pair(from, to);  
     return lights.count(p) > 0;
@@ -464,21 +750,40 @@ bool Intersection::isConnected(int from, int to) {
  * Returns a pointer to the traffic light between the two road segments given their IDs.
  */
 TrafficLight *Intersection::getLightBetween(int from, int to) {
+    buildTables();
     assert(inboundRoads.count(from) && outboundRoads.count(to) && "one of the roads is not in the intersection");
-    pair<int, int> p = make_pair(from, to);
-    assert(lights.count(p) && "there is no light between the two roads");
-    return lights[p];
+    auto it = lights.find(make_pair(from, to)); // does not modify the map, so it is safe to call concurrently
+    assert(it != lights.end() && "there is no light between the two roads");
+    return it->second;
+}
+
+/**
+ * Returns a pointer to the traffic light between two road segments, by looking up their slots in the phase table
+ * when it is compiled. Safe to call concurrently.
+ * @param from the road segment entering the intersection
+ * @param to the road segment leaving the intersection
+ */
+TrafficLight *Intersection::getLightBetween(const RoadSegment *from, const RoadSegment *to) {
+    assert(from->getDestination() == this && to->getSource() == this && "one of the roads is not in the intersection");
+    if (!compiled) return getLightBetween(from->getID(), to->getID());
+    TrafficLight *t = turnLights[from->getEntrySlot() * exits + to->getExitSlot()];
+    assert(t != nullptr && "there is no light between the two roads");
+    return t;
 }
 
 /**
  * Returns an immutable reference to the traffic lights (and their IDs) in this intersection.
  */
-const unordered_map<int, TrafficLight*> &Intersection::getTrafficLights() const { return lightFromID; }
+const unordered_map<int, TrafficLight*> &Intersection::getTrafficLights() {
+    buildTables();
+    return lightFromID;
+}
 
 /**
  * Returns a pointer to the traffic light given an id.
  */
 TrafficLight *Intersection::getLightFromID(int id) {
+    buildTables();
     assert(lightFromID.count(id) && "there is no light in this intersection with the specified ID");
     return lightFromID[id];
 }
@@ -487,6 +792,7 @@ TrafficLight *Intersection::getLightFromID(int id) {
  * Returns a pointer to the road that leads from the intersection with the specified ID.
  */
 RoadSegment *Intersection::getRoadFrom(int id) {
+    buildTables();
     assert(inboundIntersections.count(id) && "there is no road leading from this intersection");
     return roadFrom[id];
 }
@@ -495,6 +801,7 @@ RoadSegment *Intersection::getRoadFrom(int id) {
  * Returns a pointer to the road that leads to the intersection with the specified ID.
  */
 RoadSegment *Intersection::getRoadTo(int id) {
+    buildTables();
     assert(outboundIntersections.count(id) && "there is no road leading from this intersection");
     return roadTo[id];
 }
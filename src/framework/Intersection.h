@@ -1,6 +1,7 @@
 #ifndef INTERSECTION_H_
 #define INTERSECTION_H_
 
+#include <cstdint>
 #include <vector>
 #include <cmath>
 #include <unordered_set>
@@ -15,6 +16,7 @@ struct Intersection {
 private:
     static int counter; // number of intersections that have been created
     int id; // each intersection has a unique id number
+    int index; // the index of the intersection in the frozen view of the graph
     bool leftTurn; // whether there is a left turn signal on
     double scheduledTime; // the next time the intersection is scheduled to be cycled, -1.0 if there is no time scheduled
     std::unordered_map<int, RoadSegment*> inboundRoads; // inbound road segments
@@ -36,23 +38,52 @@ private:
     std::vector<std::unordered_set<int>> cycleToLight; // the set of lights associated with the cycle number
     std::unordered_map<int, int> cycleNumber; // cycle number of a light
     double timeOfLastCycle;
+    bool compiled; // whether the phase table matches the lights, links and cycles
+    int exits; // the number of roads leaving the intersection in the phase table
+    int words; // the number of words in each mask of the phase table
+    std::vector<TrafficLight*> turnLights; // the light of each pair of entry and exit slots, nullptr if there is none
+    std::vector<uint64_t> phaseMasks; // the straight lights and then the left lights of each cycle
+    std::vector<uint64_t> greenMask; // the lights that are green
+    std::vector<std::vector<int>> entryCycles; // the cycle of each straight light of each entry slot
+    std::vector<int> cycleFlow; // the flow of the roads into the straight lights of each cycle
+    int totalFlow; // the flow of the roads into the straight lights of every cycle
+    std::vector<int> *flowLog; // where the ID of the intersection is recorded when its flows change, nullptr if no log
+    bool flowLogged; // whether the ID of the intersection is in the flow log
+    bool tablesBuilt; // whether the maps of the roads, lights, links and cycles are built, false after adopt() until they are needed
+    std::vector<RoadSegment*> slotRoads; // the roads entering and then leaving in the order of their slots, until the maps are built
+    std::vector<std::pair<int, int>> adoptedLinks; // the links between the lights as returned by getLinks(), until the maps are built
 
     // void dfs(int light, int cur);
+    void compile();
+    void buildTables();
+    void addLink(int A, int B);
+    void removeLight(TrafficLight *t);
 
 public:
     Intersection(double x, double y);
     Intersection(Point2D &location);
     ~Intersection();
     int getID() const;
+    int getIndex() const;
+    void setIndex(int index);
     bool add(RoadSegment *r);
     bool remove(RoadSegment *r);
-    void connect(int from, int to, int type);
+    TrafficLight *connect(int from, int to, int type);
     void link(int A, int B);
     void autoConnectAndLink();
+    void adopt(const std::vector<RoadSegment*> &entering, const std::vector<RoadSegment*> &leaving, const std::vector<TrafficLight*> &turns,
+               const std::vector<uint64_t> &masks, int cycles, const std::vector<std::pair<int, int>> &links);
+    void getPhaseTable(std::vector<RoadSegment*> &entering, std::vector<RoadSegment*> &leaving, std::vector<TrafficLight*> &turns,
+                       std::vector<uint64_t> &masks);
+    void getLinks(std::vector<std::pair<int, int>> &links);
+    int getCycleNumber(int light);
+    int countCycles() const;
     // void assign();
     void cycle(double time);
     int getCurrentCycle() const;
     bool leftTurnSignalOn() const;
+    void addInboundFlow(const RoadSegment *r, int value);
+    void watchFlows(std::vector<int> *log);
     int getCurrentFlow();
     int getOppositeFlow();
     double getTimeOfLastCycle() const;
@@ -62,13 +93,14 @@ public:
     void resetScheduledTime();
     int outdegree() const;
     int indegree() const;
-    const std::unordered_map<int, RoadSegment*> &getInboundRoads() const;
-    const std::unordered_map<int, RoadSegment*> &getOutboundRoads() const;
-    const std::unordered_map<int, Intersection*> &getInboundIntersections() const;
-    const std::unordered_map<int, Intersection*> &getOutboundIntersections() const;
+    const std::unordered_map<int, RoadSegment*> &getInboundRoads();
+    const std::unordered_map<int, RoadSegment*> &getOutboundRoads();
+    const std::unordered_map<int, Intersection*> &getInboundIntersections();
+    const std::unordered_map<int, Intersection*> &getOutboundIntersections();
     bool isConnected(int from, int to);
     TrafficLight *getLightBetween(int from, int to);
-    const std::unordered_map<int, TrafficLight*> &getTrafficLights() const;
+    TrafficLight *getLightBetween(const RoadSegment *from, const RoadSegment *to);
+    const std::unordered_map<int, TrafficLight*> &getTrafficLights();
     TrafficLight *getLightFromID(int id);
     RoadSegment *getRoadFrom(int id);
     RoadSegment *getRoadTo(int id);
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <limits>
+#include <assert.h>
+#include "Landmarks.h"
+#include "RoadSegment.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty set of landmarks, which must be built before it gives any bounds.
+ */
+Landmarks::Landmarks() {
+    epoch = -1;
+    V = 0;
+    L = 0;
+}
+
+/**
+ * Deconstructs the landmarks.
+ */
+Landmarks::~Landmarks() {}
+
+/**
+ * Chooses the landmarks in the frozen view of the graph and finds the times between them and every intersection,
+ * using the speed limits of the road segments. Each landmark takes one search in each direction, plus one more
+ * search if the landmark is chosen by avoid selection.
+ * @param view the frozen view of the graph
+ * @param count the number of landmarks, which is reduced to the number of intersections if there are fewer
+ * @param selection LANDMARK_FARTHEST or LANDMARK_AVOID
+ */
+void Landmarks::build(const GraphView &view, int count, int selection) {
+    assert(count > 0 && "there must be at least one landmark");
+    assert((selection == LANDMARK_FARTHEST || selection == LANDMARK_AVOID) && "unknown landmark selection");
+    V = view.countIntersections();
+    L = min(count, V);
+    landmarks.clear();
+    fromLandmark.assign((size_t) V * L, numeric_limits<float>::infinity());
+    toLandmark.assign((size_t) V * L, numeric_limits<float>::infinity());
+    timeTo.resize(V);
+    roadTo.resize(V);
+    pq.reserve(V);
+    for (int i = 0; i < L; i++) {
+        int landmark;
+        if (i == 0) {
+            sweep(view, 0, true); // the first landmark is the intersection farthest from an arbitrary one
+            landmark = settled.back();
+        } else if (selection == LANDMARK_FARTHEST) {
+            landmark = chooseFarthest(i);
+        } else {
+            landmark = chooseAvoid(view, i);
+        }
+        landmarks.push_back(landmark);
+        sweep(view, landmark, true);
+        store(i, true);
+        sweep(view, landmark, false);
+        store(i, false);
+    }
+    timeTo = vector<double>();
+    roadTo = vector<int>();
+    settled = vector<int>();
+    epoch = view.getEpoch();
+}
+
+/**
+ * Finds the times from the source to every intersection, or from every intersection to the source, with Dijkstra's
+ * algorithm. The intersections that are reached are recorded in the order they are settled.
+ * @param view the frozen view of the graph
+ * @param source the index of the intersection the search starts from
+ * @param forward true to search along the road segments, false to search against them
+ */
+void Landmarks::sweep(const GraphView &view, int source, bool forward) {
+    fill(timeTo.begin(), timeTo.end(), numeric_limits<double>::infinity());
+    settled.clear();
+    pq.clear();
+    timeTo[source] = 0.0;
+    roadTo[source] = -1;
+    pq.push(source, 0.0);
+    const int *outRoads = view.getOutRoads();
+    const int *outTargets = view.getOutTargets();
+    const double *outWeights = view.getOutWeights();
+    const int *inRoads = view.getInRoads();
+    while (!pq.isEmpty()) {
+        int v = pq.pop();
+        settled.push_back(v);
+        int begin = forward ? view.outBegin(v) : view.inBegin(v);
+        int end = forward ? view.outEnd(v) : view.inEnd(v);
+        for (int e = begin; e < end; e++) {
+            int road = forward ? outRoads[e] : inRoads[e];
+            int w = forward ? outTargets[e] : view.getSource(road);
+            double time = timeTo[v] + (forward ? outWeights[e] : view.getRoadSegment(road)->getExpectedTime());
+            if (time >= timeTo[w]) continue;
+            bool queued = timeTo[w] != numeric_limits<double>::infinity();
+            timeTo[w] = time;
+            roadTo[w] = road;
+            if (queued) pq.decreaseKey(w, time);
+            else pq.push(w, time);
+        }
+    }
+}
+
+/**
+ * Stores the times found by the last sweep as the times from or to a landmark.
+ * @param i the landmark the sweep started from
+ * @param forward true if the sweep went along the road segments
+ */
+void Landmarks::store(int i, bool forward) {
+    vector<float> &times = forward ? fromLandmark : toLandmark;
+    for (int v = 0; v < V; v++) {
+        times[(size_t) v * L + i] = (float) timeTo[v];
+    }
+}
+
+/**
+ * Returns the intersection whose shortest round trip to any of the landmarks chosen so far is the longest.
+ * @param count the number of landmarks chosen so far
+ */
+int Landmarks::chooseFarthest(int count) const {
+    int best = -1;
+    double bestTime = -1.0;
+    for (int v = 0; v < V; v++) {
+        double time = numeric_limits<double>::infinity();
+        for (int i = 0; i < count; i++) {
+            time = min(time, (double) fromLandmark[(size_t) v * L + i] + toLandmark[(size_t) v * L + i]);
+        }
+        if (time == 0.0) continue; // v is a landmark
+        if (time == numeric_limits<double>::infinity()) return v; // nothing bounds the times to v yet
+        if (time > bestTime) {
+            bestTime = time;
+            best = v;
+        }
+    }
+    assert(best != -1 && "every intersection is already a landmark");
+    return best;
+}
+
+/**
+ * Returns the landmark chosen by avoid selection. A shortest path tree is grown from the intersection farthest from
+ * the landmarks, and each intersection is weighted by how much the landmarks chosen so far underestimate the time to
+ * reach it. The size of a subtree is the total weight in it, or zero if it has a landmark, since that landmark
+ * already bounds it well. Following the largest subtree down to a leaf then gives a landmark behind the intersections
+ * that are bounded worst.
+ * @param view the frozen view of the graph
+ * @param count the number of landmarks chosen so far
+ */
+int Landmarks::chooseAvoid(const GraphView &view, int count) {
+    int root = chooseFarthest(count);
+    sweep(view, root, true);
+    vector<double> size(V, 0.0);
+    vector<char> covered(V, 0); // whether the subtree of each intersection has a landmark
+    for (int i = 0; i < count; i++) {
+        covered[landmarks[i]] = 1;
+    }
+    for (int k = (int) settled.size() - 1; k >= 0; k--) { // children are settled after their parents
+        int v = settled[k];
+        if (covered[v]) size[v] = 0.0;
+        else size[v] += timeTo[v] - getLowerBound(root, v);
+        if (roadTo[v] == -1) continue;
+        int parent = view.getSource(roadTo[v]);
+        if (covered[v]) covered[parent] = 1;
+        else size[parent] += size[v];
+    }
+    // follows the child with the largest subtree from the root until there are no children left
+    vector<int> best(V, -1); // the child of each intersection with the largest subtree
+    for (int k = 1; k < (int) settled.size(); k++) {
+        int v = settled[k];
+        int parent = view.getSource(roadTo[v]);
+        if (!covered[v] && (best[parent] == -1 || size[v] > size[best[parent]])) best[parent] = v;
+    }
+    int v = root;
+    while (best[v] != -1) v = best[v];
+    return v;
+}
+
+/**
+ * Returns the epoch of the graph the landmarks were chosen in, or -1 if they have not been chosen.
+ */
+long long Landmarks::getEpoch() const { return epoch; }
+
+/**
+ * Returns the number of landmarks.
+ */
+int Landmarks::countLandmarks() const { return L; }
+
+/**
+ * Returns the index of a landmark intersection.
+ * @param i the landmark
+ */
+int Landmarks::getLandmark(int i) const {
+    assert(i >= 0 && i < L && "landmark is out of range");
+    return landmarks[i];
+}
+
+/**
+ * Returns a lower bound on the time from one intersection to another at the speed limits, which is infinity if
+ * there is no path. The bound is reduced slightly so the rounding of the stored times never makes it too large.
+ * @param s the index of the intersection the path starts at
+ * @param t the index of the intersection the path ends at
+ */
+double Landmarks::getLowerBound(int s, int t) const {
+    const float *fromS = &fromLandmark[(size_t) s * L], *fromT = &fromLandmark[(size_t) t * L];
+    const float *toS = &toLandmark[(size_t) s * L], *toT = &toLandmark[(size_t) t * L];
+    double best = 0.0;
+    double scale = 0.0; // the largest time the bound was found from
+    for (int i = 0; i < L; i++) {
+        // a difference of two infinite times is not a number and never compares greater
+        double forward = (double) fromT[i] - fromS[i];
+        double backward = (double) toS[i] - toT[i];
+        if (forward > best) {
+            best = forward;
+            scale = fromT[i];
+        }
+        if (backward > best) {
+            best = backward;
+            scale = toS[i];
+        }
+    }
+    if (best == numeric_limits<double>::infinity()) return best;
+    return max(0.0, best - scale * LANDMARK_ROUNDING);
+}
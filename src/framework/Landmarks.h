@@ -0,0 +1,53 @@
+#ifndef LANDMARKS_H_
+#define LANDMARKS_H_
+
+#include <vector>
+#include "Forward.h"
+#include "GraphView.h"
+#include "../misc/IndexMinPQ.h"
+
+#define LANDMARK_COUNT 8 // the default number of landmarks
+#define LANDMARK_FARTHEST 0 // each landmark is the intersection farthest from the landmarks already chosen
+#define LANDMARK_AVOID 1 // each landmark is at the end of the part of a shortest path tree the landmarks cover worst
+#define LANDMARK_ROUNDING 1e-6 // the relative error allowed for by the lower bounds, since the times are stored as floats
+
+/**
+ * The times between every intersection and a few landmark intersections, which give a lower bound on the time
+ * between any two intersections by the triangle inequality: the time from s to t is at least the time from s to a
+ * landmark minus the time from t to it, and at least the time from a landmark to t minus the time from it to s. A
+ * bound only takes one pass over the landmarks, and guides A* search far better than the straight line distance
+ * when the landmarks are on the edges of the city behind the source or the destination.
+ *
+ * The times are stored as floats, with the landmarks of each intersection next to each other.
+ */
+struct Landmarks {
+private:
+    long long epoch; // the epoch of the graph the landmarks were chosen in, -1 if they have not been chosen
+    int V; // the number of intersections
+    int L; // the number of landmarks
+    std::vector<int> landmarks; // the index of each landmark intersection
+    std::vector<float> fromLandmark; // the time from landmark i to intersection v is fromLandmark[v * L + i]
+    std::vector<float> toLandmark; // the time from intersection v to landmark i is toLandmark[v * L + i]
+
+    // the state that is only used while choosing
+    std::vector<double> timeTo; // the time to each intersection in the current sweep
+    std::vector<int> roadTo; // the last road on the shortest path to each intersection in the current sweep
+    std::vector<int> settled; // the intersections in the order the current sweep reached them
+    IndexMinPQ pq; // the priority queue of the sweep
+
+    void sweep(const GraphView &view, int source, bool forward);
+    void store(int i, bool forward);
+    int chooseFarthest(int count) const;
+    int chooseAvoid(const GraphView &view, int count);
+
+public:
+    Landmarks();
+    ~Landmarks();
+    void build(const GraphView &view, int count, int selection);
+    long long getEpoch() const;
+    int countLandmarks() const;
+    int getLandmark(int i) const;
+    double getLowerBound(int s, int t) const;
+};
+
+#endif
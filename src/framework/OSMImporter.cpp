@@ -0,0 +1,622 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <assert.h>
+#include "OSMImporter.h"
+#include "Intersection.h"
+#include "Point2D.h"
+#include "RoadSegment.h"
+#include "WeightedDigraph.h"
+
+#define OSM_TAG_HIGHWAY 0
+#define OSM_TAG_ONEWAY 1
+#define OSM_TAG_JUNCTION 2
+#define OSM_TAG_MAXSPEED 3
+#define OSM_TAG_LANES 4
+#define OSM_TAG_LANES_FORWARD 5
+#define OSM_TAG_LANES_BACKWARD 6
+#define OSM_TAG_AREA 7
+
+using namespace std;
+
+/**
+ * The keys of the way tags read by the importer, in the order of the OSM_TAG indices.
+ */
+static const char *osmTags[OSM_TAGS] = {"highway", "oneway", "junction", "maxspeed", "lanes", "lanes:forward", "lanes:backward", "area"};
+
+/**
+ * The kinds of highway that are imported as roads, with the speed limit in kilometres per hour and the number of
+ * lanes in each direction used when the way has no tags for them, and whether the road is one way unless it is
+ * tagged otherwise.
+ */
+static const struct {
+    const char *highway;
+    double speedLimit;
+    int lanes;
+    bool oneway;
+} osmRoadClasses[] = {
+    {"motorway", 110.0, 2, true},
+    {"motorway_link", 60.0, 1, true},
+    {"trunk", 90.0, 2, false},
+    {"trunk_link", 50.0, 1, false},
+    {"primary", 70.0, 1, false},
+    {"primary_link", 50.0, 1, false},
+    {"secondary", 60.0, 1, false},
+    {"secondary_link", 40.0, 1, false},
+    {"tertiary", 50.0, 1, false},
+    {"tertiary_link", 40.0, 1, false},
+    {"unclassified", 40.0, 1, false},
+    {"residential", 30.0, 1, false},
+    {"living_street", 10.0, 1, false},
+    {"service", 20.0, 1, false},
+    {"road", 40.0, 1, false}
+};
+
+/**
+ * Returns the index of the kind of highway in osmRoadClasses, -1 if the way is not imported as a road.
+ * @param tags the tags of the way
+ */
+static int getRoadClass(const string *tags[OSM_TAGS]) {
+    if (tags[OSM_TAG_HIGHWAY] == nullptr) return -1;
+    if (tags[OSM_TAG_AREA] != nullptr && *tags[OSM_TAG_AREA] == "yes") return -1;
+    for (int i = 0; i < (int) (sizeof(osmRoadClasses) / sizeof(osmRoadClasses[0])); i++) {
+        if (*tags[OSM_TAG_HIGHWAY] == osmRoadClasses[i].highway) return i;
+    }
+    return -1;
+}
+
+/**
+ * Opens an XML file to read its tags.
+ * @param fileName the name of the file
+ */
+OSMReader::OSMReader(string fileName) {
+    in = fopen(fileName.c_str(), "rb");
+    assert(in != nullptr && "could not open the OSM file");
+    buffer.resize(OSM_READ_BUFFER);
+    position = 0;
+    filled = 0;
+    used = 0;
+    closing = false;
+    empty = false;
+}
+
+/**
+ * Deconstructs the OSMReader and closes the file.
+ */
+OSMReader::~OSMReader() {
+    fclose(in);
+}
+
+/**
+ * Returns the next character of the file, EOF if the whole file has been read.
+ */
+int OSMReader::read() {
+    if (position == filled) {
+        filled = fread(buffer.data(), 1, buffer.size(), in);
+        position = 0;
+        if (filled == 0) return EOF;
+    }
+    return (unsigned char) buffer[position++];
+}
+
+/**
+ * Reads the next opening or closing tag of an element.
+ * @return true if a tag was read, false if the end of the file was reached
+ */
+bool OSMReader::next() {
+    while (true) {
+        int c;
+        while ((c = read()) != EOF && c != '<');
+        if (c == EOF) return false;
+        tag.clear();
+        char quote = 0;
+        bool comment = false;
+        while ((c = read()) != EOF) {
+            if (comment) {
+                // a comment may hold quotes and brackets, so it only ends at the first -->
+                if (c == '>' && tag.size() >= 5 && tag.compare(tag.size() - 2, 2, "--") == 0) break;
+            } else if (quote != 0) {
+                if (c == quote) quote = 0;
+            } else if (c == '"' || c == '\'') {
+                quote = (char) c;
+            } else if (c == '>') {
+                break;
+            }
+            tag.push_back((char) c);
+            if (tag.size() == 3 && tag == "!--") comment = true;
+        }
+        if (c == EOF) return false;
+        if (tag.empty() || tag[0] == '?' || tag[0] == '!') continue;
+        parse();
+        return true;
+    }
+}
+
+/**
+ * Splits the current tag into the name of the element and its attributes.
+ */
+void OSMReader::parse() {
+    closing = tag[0] == '/';
+    empty = !closing && tag.back() == '/';
+    size_t end = empty ? tag.size() - 1 : tag.size();
+    size_t p = closing ? 1 : 0;
+    size_t start = p;
+    while (p < end && !isspace((unsigned char) tag[p])) p++;
+    name.assign(tag, start, p - start);
+    used = 0;
+    while (true) {
+        while (p < end && isspace((unsigned char) tag[p])) p++;
+        if (p >= end) break;
+        start = p;
+        while (p < end && tag[p] != '=' && !isspace((unsigned char) tag[p])) p++;
+        if (used == (int) attributes.size()) attributes.emplace_back();
+        pair<string, string> &attribute = attributes[used++];
+        attribute.first.assign(tag, start, p - start);
+        while (p < end && (tag[p] == '=' || isspace((unsigned char) tag[p]))) p++;
+        if (p < end && (tag[p] == '"' || tag[p] == '\'')) {
+            char quote = tag[p++];
+            start = p;
+            while (p < end && tag[p] != quote) p++;
+            attribute.second.assign(tag, start, p - start);
+            p++;
+        } else {
+            start = p;
+            while (p < end && !isspace((unsigned char) tag[p])) p++;
+            attribute.second.assign(tag, start, p - start);
+        }
+        decode(attribute.second);
+    }
+}
+
+/**
+ * Replaces the predefined XML entities in an attribute value with the characters they stand for.
+ * @param value the attribute value
+ */
+void OSMReader::decode(string &value) {
+    if (value.find('&') == string::npos) return;
+    static const char *entities[][2] = {{"&amp;", "&"}, {"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""}, {"&apos;", "'"}};
+    string decoded;
+    for (size_t i = 0; i < value.size(); i++) {
+        bool replaced = false;
+        if (value[i] == '&') {
+            for (auto &entity : entities) {
+                size_t length = strlen(entity[0]);
+                if (value.compare(i, length, entity[0]) == 0) {
+                    decoded += entity[1];
+                    i += length - 1;
+                    replaced = true;
+                    break;
+                }
+            }
+        }
+        if (!replaced) decoded.push_back(value[i]);
+    }
+    value.swap(decoded);
+}
+
+/**
+ * Returns the name of the element of the current tag.
+ */
+const string &OSMReader::getName() const { return name; }
+
+/**
+ * Returns true if the current tag closes an element, false otherwise.
+ */
+bool OSMReader::isClosing() const { return closing; }
+
+/**
+ * Returns true if the current tag opens an element and closes it again, false otherwise.
+ */
+bool OSMReader::isEmpty() const { return empty; }
+
+/**
+ * Returns the value of an attribute of the current tag, nullptr if the tag does not have the attribute.
+ * @param key the name of the attribute
+ */
+const string *OSMReader::get(const char *key) const {
+    for (int i = 0; i < used; i++) {
+        if (attributes[i].first == key) return &attributes[i].second;
+    }
+    return nullptr;
+}
+
+/**
+ * Initializes an OSMImporter.
+ */
+OSMImporter::OSMImporter() {
+    ways = 0;
+    collapsed = 0;
+    dropped = 0;
+}
+
+/**
+ * Deconstructs the OSMImporter.
+ */
+OSMImporter::~OSMImporter() {}
+
+/**
+ * Returns true if the file is an OpenStreetMap XML file, false otherwise.
+ * @param fileName the name of the file
+ */
+bool OSMImporter::isOSMFile(string fileName) {
+    FILE *in = fopen(fileName.c_str(), "rb");
+    if (in == nullptr) return false;
+    char start[512] = {};
+    size_t read = fread(start, 1, sizeof(start) - 1, in);
+    fclose(in);
+    return read > 0 && strstr(start, "<osm") != nullptr;
+}
+
+/**
+ * Imports the roads of an OpenStreetMap XML file into an empty graph. The traffic lights are not connected.
+ * @param fileName the name of the file
+ * @param G the Weighted Directed Graph
+ * @param created the intersections in the order they were created
+ */
+void OSMImporter::import(string fileName, WeightedDigraph *G, vector<Intersection*> &created) {
+    scanWays(fileName, false);
+    latitude.assign(uses.size(), NAN);
+    longitude.assign(uses.size(), NAN);
+    scanNodes(fileName);
+    outEdges.assign(uses.size(), vector<int>());
+    inEdges.assign(uses.size(), vector<int>());
+    ways = 0;
+    scanWays(fileName, true);
+    for (int v = 0; v < (int) uses.size(); v++) {
+        if (collapse(v)) collapsed++;
+    }
+    keepLargestComponent();
+    build(G, created);
+    // only the graph is kept once it is built
+    nodeIndex.clear();
+    uses.clear();
+    latitude.clear();
+    longitude.clear();
+    edges.clear();
+    outEdges.clear();
+    inEdges.clear();
+}
+
+/**
+ * Returns the distance in metres between two nodes along the surface of the earth.
+ * @param a the index of the first node
+ * @param b the index of the second node
+ */
+double OSMImporter::distance(int a, int b) const {
+    double radians = M_PI / 180.0;
+    double x = (longitude[b] - longitude[a]) * radians * cos((latitude[a] + latitude[b]) / 2.0 * radians);
+    double y = (latitude[b] - latitude[a]) * radians;
+    return sqrt(x * x + y * y) * OSM_EARTH_RADIUS;
+}
+
+/**
+ * Reads the ways that are roads. The first time the file is read, the nodes the roads use are counted; the second
+ * time, the roads are cut at the shared nodes.
+ * @param fileName the name of the file
+ * @param cut true to cut the roads into edges, false to count the nodes
+ */
+void OSMImporter::scanWays(string fileName, bool cut) {
+    OSMReader reader(fileName);
+    bool inWay = false;
+    vector<long long> refs;
+    string values[OSM_TAGS];
+    const string *tags[OSM_TAGS];
+    while (reader.next()) {
+        const string &name = reader.getName();
+        if (name == "way") {
+            if (reader.isClosing() || reader.isEmpty()) {
+                if (!inWay) continue;
+                inWay = false;
+                if (getRoadClass(tags) < 0 || refs.size() < 2) continue;
+                ways++;
+                if (cut) {
+                    cutWay(refs, tags);
+                    continue;
+                }
+                for (int i = 0; i < (int) refs.size(); i++) {
+                    auto it = nodeIndex.find(refs[i]);
+                    if (it == nodeIndex.end()) {
+                        it = nodeIndex.emplace(refs[i], (int) uses.size()).first;
+                        uses.push_back(0);
+                    }
+                    uses[it->second] += (i == 0 || i == (int) refs.size() - 1) ? 3 : 1;
+                }
+            } else {
+                inWay = true;
+                refs.clear();
+                for (int i = 0; i < OSM_TAGS; i++) tags[i] = nullptr;
+            }
+        } else if (inWay && name == "nd" && !reader.isClosing()) {
+            const string *ref = reader.get("ref");
+            if (ref != nullptr) refs.push_back(atoll(ref->c_str()));
+        } else if (inWay && name == "tag" && !reader.isClosing()) {
+            const string *key = reader.get("k");
+            const string *value = reader.get("v");
+            if (key == nullptr || value == nullptr) continue;
+            for (int i = 0; i < OSM_TAGS; i++) {
+                if (*key == osmTags[i]) {
+                    values[i] = *value;
+                    tags[i] = &values[i];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Reads the locations of the nodes used by the roads.
+ * @param fileName the name of the file
+ */
+void OSMImporter::scanNodes(string fileName) {
+    OSMReader reader(fileName);
+    while (reader.next()) {
+        if (reader.isClosing() || reader.getName() != "node") continue;
+        const string *id = reader.get("id");
+        const string *lat = reader.get("lat");
+        const string *lon = reader.get("lon");
+        if (id == nullptr || lat == nullptr || lon == nullptr) continue;
+        auto it = nodeIndex.find(atoll(id->c_str()));
+        if (it == nodeIndex.end()) continue;
+        latitude[it->second] = atof(lat->c_str());
+        longitude[it->second] = atof(lon->c_str());
+    }
+}
+
+/**
+ * Cuts a way into edges at the nodes it shares with other ways and at its ends. The nodes that are not in the file
+ * are left out, which ends the way there. A way that comes back to the node it started from is also cut at the
+ * middle of its shape.
+ * @param refs the IDs of the nodes of the way in order
+ * @param tags the tags of the way
+ */
+void OSMImporter::cutWay(const vector<long long> &refs, const string *tags[OSM_TAGS]) {
+    const auto &roadClass = osmRoadClasses[getRoadClass(tags)];
+    bool forward = true, backward = !roadClass.oneway;
+    if (tags[OSM_TAG_JUNCTION] != nullptr && (*tags[OSM_TAG_JUNCTION] == "roundabout" || *tags[OSM_TAG_JUNCTION] == "circular")) backward = false;
+    if (tags[OSM_TAG_ONEWAY] != nullptr) {
+        const string &oneway = *tags[OSM_TAG_ONEWAY];
+        if (oneway == "yes" || oneway == "true" || oneway == "1") {
+            backward = false;
+        } else if (oneway == "-1" || oneway == "reverse") {
+            forward = false;
+            backward = true;
+        } else if (oneway == "no" || oneway == "false" || oneway == "0") {
+            backward = true;
+        }
+    }
+    double speedLimit = roadClass.speedLimit;
+    if (tags[OSM_TAG_MAXSPEED] != nullptr) {
+        double tagged = atof(tags[OSM_TAG_MAXSPEED]->c_str());
+        if (tags[OSM_TAG_MAXSPEED]->find("mph") != string::npos) tagged *= OSM_MPH;
+        if (tagged > 0.0) speedLimit = tagged;
+    }
+    speedLimit /= OSM_KMH;
+    int lanes = tags[OSM_TAG_LANES] != nullptr ? atoi(tags[OSM_TAG_LANES]->c_str()) : 0;
+    int forwardLanes = roadClass.lanes, backwardLanes = roadClass.lanes;
+    if (lanes > 0) {
+        forwardLanes = forward && backward ? max(1, lanes / 2) : lanes;
+        backwardLanes = forwardLanes;
+    }
+    if (tags[OSM_TAG_LANES_FORWARD] != nullptr && atoi(tags[OSM_TAG_LANES_FORWARD]->c_str()) > 0) forwardLanes = atoi(tags[OSM_TAG_LANES_FORWARD]->c_str());
+    if (tags[OSM_TAG_LANES_BACKWARD] != nullptr && atoi(tags[OSM_TAG_LANES_BACKWARD]->c_str()) > 0) backwardLanes = atoi(tags[OSM_TAG_LANES_BACKWARD]->c_str());
+    auto emit = [&] (int a, int b, double length) {
+        if (forward) addEdge(a, b, length / speedLimit, length * forwardLanes);
+        if (backward) addEdge(b, a, length / speedLimit, length * backwardLanes);
+    };
+    static thread_local vector<pair<int, double>> shape; // the nodes since the last cut and their distance along the way
+    shape.clear();
+    int start = -1, previous = -1;
+    double length = 0.0;
+    for (int i = 0; i < (int) refs.size(); i++) {
+        int v = nodeIndex[refs[i]];
+        if (std::isnan(latitude[v])) {
+            start = -1;
+            continue;
+        }
+        if (start == -1) {
+            start = previous = v;
+            length = 0.0;
+            shape.clear();
+            continue;
+        }
+        if (v == previous) continue;
+        length += distance(previous, v);
+        previous = v;
+        bool last = i == (int) refs.size() - 1 || std::isnan(latitude[nodeIndex[refs[i + 1]]]);
+        if (uses[v] < 2 && !last) {
+            shape.push_back(make_pair(v, length));
+            continue;
+        }
+        if (v == start) {
+            if (!shape.empty()) {
+                pair<int, double> middle = shape[shape.size() / 2];
+                emit(start, middle.first, middle.second);
+                emit(middle.first, v, length - middle.second);
+            }
+        } else {
+            emit(start, v, length);
+        }
+        start = v;
+        length = 0.0;
+        shape.clear();
+    }
+}
+
+/**
+ * Adds an edge between two nodes. When there already is an edge between them, only the faster edge is kept, and
+ * edges between nodes that are too close together are left out.
+ * @param from the index of the node the edge leaves
+ * @param to the index of the node the edge enters
+ * @param time the time to drive the edge in seconds
+ * @param space the length of each lane of the edge added together in metres
+ */
+void OSMImporter::addEdge(int from, int to, double time, double space) {
+    if (from == to || distance(from, to) < OSM_MIN_LENGTH) return;
+    for (int e : outEdges[from]) {
+        if (edges[e].removed || edges[e].to != to) continue;
+        if (time < edges[e].time) {
+            edges[e].time = time;
+            edges[e].space = space;
+        }
+        return;
+    }
+    outEdges[from].push_back((int) edges.size());
+    inEdges[to].push_back((int) edges.size());
+    edges.push_back({from, to, time, space, false});
+}
+
+/**
+ * Removes a node that only joins two roads, and replaces the roads with a road between the nodes at their other
+ * ends, either in one direction or in both.
+ * @param v the index of the node
+ * @return true if the node was removed, false otherwise
+ */
+bool OSMImporter::collapse(int v) {
+    int in[3], out[3];
+    int cntIn = 0, cntOut = 0;
+    for (int e : inEdges[v]) {
+        if (edges[e].removed) continue;
+        if (cntIn == 2) return false;
+        in[cntIn++] = e;
+    }
+    for (int e : outEdges[v]) {
+        if (edges[e].removed) continue;
+        if (cntOut == 2) return false;
+        out[cntOut++] = e;
+    }
+    if (cntIn != cntOut || cntIn == 0) return false;
+    if (cntIn == 2 && edges[out[0]].to == edges[in[0]].from) swap(out[0], out[1]);
+    // each road into the node continues along a road out of the node that does not turn back
+    for (int i = 0; i < cntIn; i++) {
+        int a = edges[in[i]].from, b = edges[out[i]].to;
+        if (a == b || distance(a, b) < OSM_MIN_LENGTH) return false;
+        if (cntIn == 2 && b != edges[in[1 - i]].from) return false;
+        for (int e : outEdges[a]) {
+            if (!edges[e].removed && edges[e].to == b) return false;
+        }
+    }
+    for (int i = 0; i < cntIn; i++) {
+        OSMEdge &first = edges[in[i]], &second = edges[out[i]];
+        first.removed = second.removed = true;
+        addEdge(first.from, second.to, first.time + second.time, first.space + second.space);
+    }
+    return true;
+}
+
+/**
+ * Drops the edges that are not in the largest strongly connected component, so that every trip has a path.
+ */
+void OSMImporter::keepLargestComponent() {
+    int V = (int) uses.size();
+    // orders the nodes by when a depth first search along the edges finishes them
+    vector<int> order;
+    vector<char> visited(V, 0);
+    vector<pair<int, int>> stack;
+    for (int s = 0; s < V; s++) {
+        if (visited[s]) continue;
+        visited[s] = 1;
+        stack.push_back(make_pair(s, 0));
+        while (!stack.empty()) {
+            int v = stack.back().first;
+            int &i = stack.back().second;
+            if (i == (int) outEdges[v].size()) {
+                order.push_back(v);
+                stack.pop_back();
+                continue;
+            }
+            const OSMEdge &e = edges[outEdges[v][i++]];
+            if (e.removed || visited[e.to]) continue;
+            visited[e.to] = 1;
+            stack.push_back(make_pair(e.to, 0));
+        }
+    }
+    // the nodes reached against the edges in the reverse of that order form the components
+    vector<int> component(V, -1), sizes;
+    for (int k = V - 1; k >= 0; k--) {
+        int s = order[k];
+        if (component[s] != -1) continue;
+        int c = (int) sizes.size();
+        sizes.push_back(0);
+        component[s] = c;
+        stack.push_back(make_pair(s, 0));
+        while (!stack.empty()) {
+            int v = stack.back().first;
+            stack.pop_back();
+            sizes[c]++;
+            for (int e : inEdges[v]) {
+                if (edges[e].removed || component[edges[e].from] != -1) continue;
+                component[edges[e].from] = c;
+                stack.push_back(make_pair(edges[e].from, 0));
+            }
+        }
+    }
+    if (sizes.empty()) return;
+    int largest = (int) (max_element(sizes.begin(), sizes.end()) - sizes.begin());
+    for (OSMEdge &e : edges) {
+        if (e.removed || (component[e.from] == largest && component[e.to] == largest)) continue;
+        e.removed = true;
+        dropped++;
+    }
+}
+
+/**
+ * Creates the intersections and road segments of the edges that were kept. The nodes are projected onto a plane
+ * with the north at the top, and moved so the city starts at OSM_MARGIN from both axes.
+ * @param G the Weighted Directed Graph
+ * @param created the intersections in the order they were created
+ */
+void OSMImporter::build(WeightedDigraph *G, vector<Intersection*> &created) {
+    double minLatitude = INFINITY, maxLatitude = -INFINITY, minLongitude = INFINITY;
+    int cntIntersections = 0, cntRoadSegments = 0;
+    vector<int> index(uses.size(), -1);
+    for (const OSMEdge &e : edges) {
+        if (e.removed) continue;
+        cntRoadSegments++;
+        for (int v : {e.from, e.to}) {
+            if (index[v] != -1) continue;
+            index[v] = cntIntersections++;
+            minLatitude = min(minLatitude, latitude[v]);
+            maxLatitude = max(maxLatitude, latitude[v]);
+            minLongitude = min(minLongitude, longitude[v]);
+        }
+    }
+    if (cntRoadSegments == 0) return;
+    double radians = M_PI / 180.0;
+    double scale = radians * OSM_EARTH_RADIUS;
+    double shrink = cos((minLatitude + maxLatitude) / 2.0 * radians); // the length of a degree of longitude relative to latitude
+    G->reserve(G->countIntersections() + cntIntersections, G->countRoadSegments() + cntRoadSegments);
+    size_t first = created.size();
+    created.resize(first + cntIntersections, nullptr);
+    auto intersection = [&] (int v) {
+        Intersection *&intxn = created[first + index[v]];
+        if (intxn == nullptr) {
+            intxn = new Intersection(OSM_MARGIN + (longitude[v] - minLongitude) * shrink * scale, OSM_MARGIN + (maxLatitude - latitude[v]) * scale);
+        }
+        return intxn;
+    };
+    for (const OSMEdge &e : edges) {
+        if (e.removed) continue;
+        Intersection *source = intersection(e.from);
+        Intersection *destination = intersection(e.to);
+        double length = source->getLocation().distanceTo(destination->getLocation());
+        int capacity = max(1, (int) ceil(e.space / OSM_VEHICLE_SPACING));
+        G->addRoadSegment(new RoadSegment(source, destination, length / e.time, capacity));
+    }
+}
+
+/**
+ * Returns the number of ways that were imported as roads.
+ */
+int OSMImporter::countWays() const { return ways; }
+
+/**
+ * Returns the number of nodes that were removed because they only joined two roads.
+ */
+int OSMImporter::countCollapsed() const { return collapsed; }
+
+/**
+ * Returns the number of edges that were dropped because they were not in the largest connected part of the city.
+ */
+int OSMImporter::countDropped() const { return dropped; }
@@ -0,0 +1,105 @@
+#ifndef OSMIMPORTER_H_
+#define OSMIMPORTER_H_
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unordered_map>
+#include "Forward.h"
+
+#define OSM_READ_BUFFER 65536 // the number of bytes read from the file at a time
+#define OSM_EARTH_RADIUS 6371000.0 // the mean radius of the earth in metres
+#define OSM_MARGIN 50.0 // the distance in metres between the imported city and the axes
+#define OSM_VEHICLE_SPACING 7.5 // the length of road in metres taken by one vehicle in one lane
+#define OSM_MIN_LENGTH 1.0 // the shortest road segment in metres that is imported
+#define OSM_KMH 3.6 // the number of kilometres per hour in one metre per second
+#define OSM_MPH 1.609344 // the number of kilometres per hour in one mile per hour
+#define OSM_TAGS 8 // the number of way tags read by the importer
+
+/**
+ * Reads the tags of an XML file one at a time without holding more than a small buffer of the file in memory.
+ * Text between the tags, comments, and the declaration are skipped.
+ */
+struct OSMReader {
+private:
+    FILE *in; // the file being read
+    std::vector<char> buffer; // the part of the file that has been read but not scanned
+    size_t position; // the next character of the buffer to scan
+    size_t filled; // the number of characters in the buffer
+    std::string tag; // the text between the brackets of the current tag
+    std::string name; // the name of the current element
+    std::vector<std::pair<std::string, std::string>> attributes; // the attributes of the current tag
+    int used; // the number of attributes of the current tag, the rest are reused for later tags
+    bool closing; // whether the current tag closes an element
+    bool empty; // whether the current tag closes the element it opens
+
+    int read();
+    void parse();
+    static void decode(std::string &value);
+
+public:
+    OSMReader(std::string fileName);
+    ~OSMReader();
+    bool next();
+    const std::string &getName() const;
+    bool isClosing() const;
+    bool isEmpty() const;
+    const std::string *get(const char *key) const;
+};
+
+/**
+ * A road between two intersections of the imported city while it is being simplified.
+ */
+struct OSMEdge {
+    int from; // the index of the node the road leaves
+    int to; // the index of the node the road enters
+    double time; // the time to drive the road at its speed limit in seconds
+    double space; // the length of each lane of the road added together in metres
+    bool removed; // whether the road was merged into another road or dropped
+};
+
+/**
+ * Imports the roads of an OpenStreetMap XML extract. The file is read as a stream three times, first for the ways
+ * that are roads, then for the locations of the nodes those ways use, and then for the ways again to cut them into
+ * road segments, so the memory used grows with the number of road nodes and not with the size of the file.
+ *
+ * A way is only cut at the nodes shared with other ways and at its ends, and a node between exactly two roads is
+ * removed afterwards, so the nodes that only give the shape of a road do not become intersections. A road keeps the
+ * time it takes to drive along its shape, so its speed limit is lowered by how much longer the shape is than the
+ * straight road segment. Only the largest part of the city in which every intersection can reach every other one is
+ * kept. Locations are in metres and speed limits in metres per second.
+ */
+struct OSMImporter {
+private:
+    std::unordered_map<long long, int> nodeIndex; // maps the ID of every node used by a road to its index
+    std::vector<int> uses; // the number of times each node is used by the roads, two more for the ends of a way
+    std::vector<double> latitude; // the latitude of each node, NAN if the node is not in the file
+    std::vector<double> longitude; // the longitude of each node, NAN if the node is not in the file
+    std::vector<OSMEdge> edges; // the roads between the nodes
+    std::vector<std::vector<int>> outEdges; // the roads leaving each node
+    std::vector<std::vector<int>> inEdges; // the roads entering each node
+    int ways; // the number of ways that were imported as roads
+    int collapsed; // the number of nodes removed between two roads
+    int dropped; // the number of roads that were not in the largest connected part of the city
+
+    double distance(int a, int b) const;
+    void scanWays(std::string fileName, bool cut);
+    void scanNodes(std::string fileName);
+    void cutWay(const std::vector<long long> &refs, const std::string *tags[OSM_TAGS]);
+    void addEdge(int from, int to, double time, double space);
+    bool collapse(int v);
+    void keepLargestComponent();
+    void build(WeightedDigraph *G, std::vector<Intersection*> &created);
+
+public:
+    OSMImporter();
+    ~OSMImporter();
+    static bool isOSMFile(std::string fileName);
+    void import(std::string fileName, WeightedDigraph *G, std::vector<Intersection*> &created);
+    int countWays() const;
+    int countCollapsed() const;
+    int countDropped() const;
+};
+
+#endif
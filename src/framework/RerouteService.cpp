@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+#include "RerouteService.h"
+#include "Car.h"
+#include "RoadSegment.h"
+#include "Intersection.h"
+#include "WeightedDigraph.h"
+#include "GraphView.h"
+
+using namespace std;
+
+/**
+ * Initializes the RerouteService.
+ * @param G the Weighted Directed Graph
+ * @param router the router that finds the new paths, which the service takes ownership of, or nullptr to use the
+ *        router of the graph
+ * @param checkBudget the number of cars whose paths are checked after each iteration (must be non-negative)
+ * @param searchBudget the number of paths found again after each iteration (must be non-negative)
+ */
+RerouteService::RerouteService(WeightedDigraph *G, Router *router, int checkBudget, int searchBudget) {
+    assert(checkBudget >= 0 && searchBudget >= 0 && "budgets must be non-negative");
+    assert((router == nullptr || router->getGraph() == G) && "router must route in this graph");
+    this->G = G;
+    this->router = router == nullptr ? G->getRouter() : router;
+    this->owned = router != nullptr;
+    this->checkBudget = checkBudget;
+    this->searchBudget = searchBudget;
+    timeLimit = 0.0;
+    cursor = 0;
+    carCursor = 0;
+    checked = 0;
+    searched = 0;
+    rerouted = 0;
+}
+
+/**
+ * Deconstructs the RerouteService and the router if the service owns it.
+ */
+RerouteService::~RerouteService() {
+    if (owned) delete router;
+}
+
+/**
+ * Returns the expected time to cross the road segment at its projected speed after the cars in its queue leave.
+ * @param r the road segment
+ */
+double RerouteService::getCongestedTime(RoadSegment *r) const {
+    return r->getLength() / r->getProjectedSpeed() + r->countCarsInQueue() * REROUTE_QUEUE_DELAY;
+}
+
+/**
+ * Returns the expected time to travel the roads after the current road of the car, up to the final road.
+ * @param c the car
+ * @param congested true to count the projected speeds and the queues of the roads, false to use their speed limits
+ */
+double RerouteService::getRemainingTime(Car *c, bool congested) const {
+    const vector<RoadSegment*> &path = c->getPath();
+    double time = 0.0;
+    for (int i = c->getPathIndex() + 1; i + 1 < (int) path.size(); i++) {
+        time += congested ? getCongestedTime(path[i]) : path[i]->getExpectedTime();
+    }
+    return time;
+}
+
+/**
+ * Returns true if the rest of the path of the car should be found again, false otherwise.
+ * @param c the car
+ * @param currentTime the current time in the simulation
+ */
+bool RerouteService::isDegraded(Car *c, double currentTime) const {
+    if (!c->hasNextRoad() || c->getRouteTime() + REROUTE_COOLDOWN > currentTime) return false;
+    if (c->getCurrentRoad()->getDestination() == c->getFinalRoad()->getSource()) return false; // there is nothing to change
+    RoadSegment *next = c->peekNextRoad();
+    if (next->getCapacity() - next->getFlow() < 1) return true;
+    return getRemainingTime(c, true) > REROUTE_THRESHOLD * getRemainingTime(c, false);
+}
+
+/**
+ * Finds the rest of the path of the car again, and replaces it if the new path is faster.
+ * Returns true if the path was replaced, false otherwise.
+ * @param c the car
+ * @param currentTime the current time in the simulation
+ */
+bool RerouteService::reroute(Car *c, double currentTime) {
+    static thread_local vector<int> sourceIDs(1), destinationIDs(1);
+    static thread_local vector<double> zero(1, 0.0);
+    static thread_local ShortestPath search;
+    sourceIDs[0] = c->getCurrentRoad()->getDestination()->getID();
+    destinationIDs[0] = c->getFinalRoad()->getSource()->getID();
+    router->route(sourceIDs, zero, destinationIDs, zero, search);
+    searched++;
+    c->setRouteTime(currentTime); // the path is not checked again until the cooldown has passed
+    const vector<RoadSegment*> &path = c->getPath();
+    int start = c->getPathIndex() + 1;
+    int length = (int) path.size() - 1 - start; // the number of roads between the current and final roads
+    bool same = (int) search.roads.size() == length && equal(search.roads.begin(), search.roads.end(), path.begin() + start);
+    if (!search.exists() || same) {
+        return false;
+    }
+    double time = 0.0;
+    for (RoadSegment *r : search.roads) {
+        time += getCongestedTime(r);
+    }
+    RoadSegment *next = c->peekNextRoad();
+    bool blocked = next->getCapacity() - next->getFlow() < 1;
+    bool free = search.roads.empty() || search.roads[0]->getCapacity() - search.roads[0]->getFlow() >= 1;
+    if (!(time < getRemainingTime(c, true) - EPS || (blocked && free))) {
+        return false;
+    }
+    c->reroute(search, currentTime);
+    rerouted++;
+    return true;
+}
+
+/**
+ * Checks the cars on the road segments in turn until the budgets or the time limit run out, and finds new paths for
+ * the cars whose paths have become congested. Each car is checked at most once. Must be called between iterations
+ * of the simulation.
+ * @param currentTime the current time in the simulation
+ */
+void RerouteService::run(double currentTime) {
+    if (owned) router->refresh(currentTime); // the router of the graph is refreshed by the simulation
+    router->prepare();
+    const GraphView &view = G->freeze();
+    int roadCount = view.countRoadSegments();
+    if (roadCount == 0) return;
+    if (cursor >= roadCount) {
+        cursor = 0;
+        carCursor = 0;
+    }
+    auto start = chrono::steady_clock::now();
+    int checks = 0, searches = 0;
+    int firstCar = carCursor;
+    // the road segment the run starts on is visited again at the end, up to the car the run started at
+    for (int visited = 0; visited <= roadCount; visited++) {
+        CarStore &cars = view.getRoadSegment(cursor)->getCars();
+        int end = visited == roadCount ? min(firstCar, cars.size()) : cars.size();
+        for (; carCursor < end; carCursor++) {
+            if (checks == checkBudget || searches == searchBudget) return;
+            if (timeLimit > 0.0 && chrono::duration<double>(chrono::steady_clock::now() - start).count() >= timeLimit) return;
+            Car *c = cars.getCar(carCursor);
+            checks++;
+            checked++;
+            if (isDegraded(c, currentTime)) {
+                searches++;
+                reroute(c, currentTime);
+            }
+        }
+        cursor = cursor + 1 == roadCount ? 0 : cursor + 1;
+        carCursor = 0;
+    }
+}
+
+/**
+ * Returns the router that finds the new paths.
+ */
+Router *RerouteService::getRouter() const { return router; }
+
+/**
+ * Returns the number of cars whose paths are checked after each iteration.
+ */
+int RerouteService::getCheckBudget() const { return checkBudget; }
+
+/**
+ * Returns the number of paths found again after each iteration.
+ */
+int RerouteService::getSearchBudget() const { return searchBudget; }
+
+/**
+ * Returns the number of seconds of wall time spent rerouting after each iteration, 0 if there is no limit.
+ */
+double RerouteService::getTimeLimit() const { return timeLimit; }
+
+/**
+ * Limits the wall time spent rerouting after each iteration, on top of the budgets. Results then depend on the
+ * speed of the machine.
+ * @param timeLimit the number of seconds, 0 for no limit (must be non-negative)
+ */
+void RerouteService::setTimeLimit(double timeLimit) {
+    assert(timeLimit >= 0.0 && "timeLimit must be non-negative");
+    this->timeLimit = timeLimit;
+}
+
+/**
+ * Returns the number of cars whose paths were checked.
+ */
+long long RerouteService::countChecked() const { return checked; }
+
+/**
+ * Returns the number of paths that were found again.
+ */
+long long RerouteService::countSearched() const { return searched; }
+
+/**
+ * Returns the number of paths that were replaced.
+ */
+long long RerouteService::countRerouted() const { return rerouted; }
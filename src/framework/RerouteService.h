@@ -0,0 +1,61 @@
+#ifndef REROUTESERVICE_H_
+#define REROUTESERVICE_H_
+
+#include <vector>
+#include "Forward.h"
+#include "Router.h"
+
+#define REROUTE_CHECKS 4096 // the default number of cars whose paths are checked after each iteration
+#define REROUTE_SEARCHES 16 // the default number of paths found again after each iteration
+#define REROUTE_THRESHOLD 1.5 // how many times slower than at the speed limits the rest of a path is before it is found again
+#define REROUTE_COOLDOWN 5.0 // the number of simulated seconds before the path of a car is checked again
+#define REROUTE_QUEUE_DELAY 0.2 // the number of seconds each car waiting at the end of a road adds to the time to cross it
+#define REROUTE_CUSTOMIZATION_INTERVAL 2.0 // the number of seconds between customizations of a router made for rerouting
+
+/**
+ * Finds new paths for cars whose paths have become congested. After each iteration, the service looks at the cars
+ * on the road segments in turn, starting where it stopped after the last iteration, until it has checked a number of
+ * cars or found a number of paths again. The budgets count work rather than time, so the cars that are rerouted do
+ * not depend on the speed of the machine, and a wall time limit can be added on top of them if needed. The
+ * rest of the path of a car is found again from the end of its current road when the next road is full, or when the
+ * rest of the path is much slower than at the speed limits, counting the projected speeds and the cars waiting at
+ * the end of each road. The new path only replaces the old one if it is faster.
+ *
+ * The router should route with the current state of the road segments, such as a CustomizableHierarchyRouter with a
+ * queue delay, since a router that only uses the speed limits finds the same path again. Only the fixed iteration simulation
+ * supports rerouting, since the event simulation schedules the moves of each car ahead of time.
+ */
+struct RerouteService {
+private:
+    WeightedDigraph *G; // the city the cars are in
+    Router *router; // the router that finds the new paths
+    bool owned; // whether the service deletes the router
+    int checkBudget; // the number of cars checked after each iteration
+    int searchBudget; // the number of paths found again after each iteration
+    double timeLimit; // the number of seconds of wall time spent after each iteration, 0 if there is no limit
+    int cursor; // the index of the road segment to look at first after the next iteration
+    int carCursor; // the index of the car on that road segment to look at first
+    long long checked; // the number of cars whose paths were checked
+    long long searched; // the number of paths that were found again
+    long long rerouted; // the number of paths that were replaced
+
+    double getCongestedTime(RoadSegment *r) const;
+    double getRemainingTime(Car *c, bool congested) const;
+    bool isDegraded(Car *c, double currentTime) const;
+    bool reroute(Car *c, double currentTime);
+
+public:
+    RerouteService(WeightedDigraph *G, Router *router, int checkBudget, int searchBudget);
+    ~RerouteService();
+    void run(double currentTime);
+    Router *getRouter() const;
+    int getCheckBudget() const;
+    int getSearchBudget() const;
+    double getTimeLimit() const;
+    void setTimeLimit(double timeLimit);
+    long long countChecked() const;
+    long long countSearched() const;
+    long long countRerouted() const;
+};
+
+#endif
@@ -1,12 +1,13 @@
 #include <assert.h>
 #include <cmath>
-#include <ctime>
+#include <limits>
 #include <random>
 #include "RoadSegment.h"
 
 using namespace std;
 
 int RoadSegment::counter = 0; // counter starts at 0
+mt19937 RoadSegment::generator;
 
 /**
  * Initalizes the RoadSegment with values
@@ -21,8 +22,15 @@ RoadSegment::RoadSegment(Intersection *source, Intersection *destination, double
     this->source = source; // the intersections sould be pointers, not copies
     this->destination = destination;
     id = counter++; // assigns an id and increments the counter
+    index = -1;
+    entrySlot = -1;
+    exitSlot = -1;
     Point2D srcLoc = source->getLocation(), destLoc = destination->getLocation();
     this->length = srcLoc.distanceTo(destLoc);
+    // the geometry is fixed, so the direction is computed once instead of every time a car moves
+    if (length > 0.0) unit = Point2D((destLoc.x - srcLoc.x) / length, (destLoc.y - srcLoc.y) / length);
+    else unit = Point2D(0.0, 0.0);
+    direction = srcLoc.angleTo(destLoc);
     this->speedLimit = speedLimit;
     this->flow = 0;
     this->capacity = capacity;
@@ -42,6 +50,38 @@ RoadSegment::~RoadSegment() {
  */
 int RoadSegment::getID() const { return id; }
 
+/**
+ * Returns the index of the road segment in the frozen view of the graph.
+ */
+int RoadSegment::getIndex() const { return index; }
+
+/**
+ * Sets the index of the road segment in the frozen view of the graph.
+ */
+void RoadSegment::setIndex(int index) { this->index = index; }
+
+/**
+ * Returns the position of the road segment among the roads entering its destination in the phase table of the
+ * destination, -1 if the table has not been compiled.
+ */
+int RoadSegment::getEntrySlot() const { return entrySlot; }
+
+/**
+ * Sets the position of the road segment among the roads entering its destination in the phase table.
+ */
+void RoadSegment::setEntrySlot(int slot) { entrySlot = slot; }
+
+/**
+ * Returns the position of the road segment among the roads leaving its source in the phase table of the source, -1
+ * if the table has not been compiled.
+ */
+int RoadSegment::getExitSlot() const { return exitSlot; }
+
+/**
+ * Sets the position of the road segment among the roads leaving its source in the phase table.
+ */
+void RoadSegment::setExitSlot(int slot) { exitSlot = slot; }
+
 /**
  * Returns the source intersection of the road segment.
  */
@@ -88,9 +128,9 @@ double RoadSegment::getProjectedSpeed() const {
 
 /**
  * Returns a random speed of cars on this road with a mean equal to the projected speed and standard deviation of 20% of the projected speed.
+ * The speed is drawn from the generator shared by every road segment, so a simulation seeded the same way draws the same speeds.
  */
 double RoadSegment::getRandomSpeed() const {
-    default_random_engine generator(time(0));
     double proj = getProjectedSpeed();
     normal_distribution<double> distribution(proj, proj * 0.2);
     return min(max(MIN_SPEED, distribution(generator)), speedLimit);
@@ -98,22 +138,26 @@ double RoadSegment::getRandomSpeed() const {
 
 /**
  * Adds the specified amount of flow to the road segment. The value added must be non-negative and the flow cannot exceed the capacity.
+ * The destination intersection is told of the change.
  * @param value the amount of flow to be added (a positve value)
  */
 void RoadSegment::addFlow(int value) {
     assert(value >= 0 && "value must be non-negative");
     assert(flow + value <= capacity && "flow cannot exceed capacity");
     flow += value;
+    destination->addInboundFlow(this, value);
 }
 
 /**
  * Subtracts the specified amount of flow to the road segment. The value substracted must be non-negative and the flow cannot become negative.
+ * The destination intersection is told of the change.
  * @param value the amount of flow to be subtracted (a positive value)
  */
 void RoadSegment::subtractFlow(int value) {
     assert(value >= 0 && "value must be non-negative");
     assert(flow - value >= 0 && "flow cannot become negative");
     flow -= value;
+    destination->addInboundFlow(this, -value);
 }
 
 /**
@@ -123,12 +167,12 @@ void RoadSegment::subtractFlow(int value) {
  */
 bool RoadSegment::addCar(Car *c) {
     assert(incoming.count(c->getID()) > 0 && "car is not scheduled to be on this road");
-    if (cars.count(c->getID()) > 0 || flow + 1 > capacity) return false;
+    if (c->getCurrentRoad() == this || flow + 1 > capacity) return false;
     addFlow(1);
-    cars[c->getID()] = c;
     incoming.erase(c->getID());
+    double destinationOffset = c->getFinalRoad() == this ? getOffsetOf(c->getDestination()) : numeric_limits<double>::infinity();
+    cars.add(c, getOffsetOf(c->getCurrentLocation()), getRandomSpeed(), destinationOffset);
     c->setRoad(this);
-    c->setSpeed(getRandomSpeed());
     if (c->hasNextRoad()) c->peekNextRoad()->addIncoming(c);
     return true;
 }
@@ -139,12 +183,15 @@ bool RoadSegment::addCar(Car *c) {
  * @param c the pointer to the car
  */
 bool RoadSegment::removeCar(Car *c) {
-    assert(inQueue.count(c->getID()) == 0);
     assert(incoming.count(c->getID()) == 0);
-    if (cars.count(c->getID()) == 0 || flow - 1 < 0) return false;
+    if (c->getCurrentRoad() != this || flow - 1 < 0) return false;
     subtractFlow(1);
-    cars.erase(c->getID());
+    Point2D location = c->getCurrentLocation();
+    double speed = c->getCurrentSpeed();
+    cars.remove(c->getSlot());
     c->setRoad(nullptr);
+    c->setLocation(location); // the car keeps its own copy of its state while it is not on a road
+    c->setSpeed(speed);
     return true;
 }
 
@@ -153,19 +200,19 @@ bool RoadSegment::removeCar(Car *c) {
  * @param c the pointer to the car
  */
 bool RoadSegment::carOnRoad(Car *c) {
-    return cars.count(c->getID()) > 0;
+    return c->getCurrentRoad() == this;
 }
 
 /**
  * Stops the car and adds it to the waiting queue. Returns true if the car was added,
  * false otherwise (car is already in the queue).
- * @param id the ID of the car
+ * @param c the pointer to the car
  */
-bool RoadSegment::stop(int id) {
-    assert(cars.count(id) > 0 && "no car with this id exists");
-    if (inQueue.count(id) > 0) return false;
-    waiting.push(id);
-    inQueue.insert(id);
+bool RoadSegment::stop(Car *c) {
+    assert(carOnRoad(c) && "car is not on road");
+    if (cars.isStopped(c->getSlot())) return false;
+    cars.stop(c->getSlot());
+    waiting.push(c);
     return true;
 }
 
@@ -173,9 +220,8 @@ bool RoadSegment::stop(int id) {
  * Returns the next car in the waiting queue.
  */
 Car *RoadSegment::getNextCarFromQueue() {
-    assert(inQueue.size() > 0 && "there are no cars in the waiting queue");
-    Car *next = cars[waiting.front()];
-    return next;
+    assert(waiting.size() > 0 && "there are no cars in the waiting queue");
+    return waiting.front();
 }
 
 /**
@@ -183,10 +229,8 @@ Car *RoadSegment::getNextCarFromQueue() {
  * @param currentTime the current time in the simulation
  */
 void RoadSegment::removeNextCarFromQueue(double currentTime) {
-    assert(inQueue.size() > 0 && "there are no cars in the waiting queue");
-    Car *next = cars[waiting.front()];
+    assert(waiting.size() > 0 && "there are no cars in the waiting queue");
     waiting.pop();
-    inQueue.erase(next->getID());
     latestTime = currentTime;
 }
 
@@ -194,23 +238,22 @@ void RoadSegment::removeNextCarFromQueue(double currentTime) {
  * Returns the last car in the waiting queue.
  */
 Car *RoadSegment::getLastCarInQueue() {
-    assert(inQueue.size() > 0 && "there are no cars in the waiting queue");
-    Car *last = cars[waiting.back()];
-    return last;
+    assert(waiting.size() > 0 && "there are no cars in the waiting queue");
+    return waiting.back();
 }
 
 /**
  * Returns the number of cars in the waiting queue.
  */
-int RoadSegment::countCarsInQueue() const { return inQueue.size(); };
+int RoadSegment::countCarsInQueue() const { return waiting.size(); };
 
 /**
- * Returns true if the car with the specified ID is in the waiting queue, false otherwise.
- * @param id the ID of the car
+ * Returns true if the car is stopped in the waiting queue, false otherwise.
+ * @param c the pointer to the car
  */
-bool RoadSegment::isStopped(int id) const {
-    assert(cars.count(id) > 0 && "car is not in road");
-    return inQueue.count(id) > 0;
+bool RoadSegment::isStopped(Car *c) const {
+    assert(c->getCurrentRoad() == this && "car is not in road");
+    return cars.isStopped(c->getSlot());
 }
 
 /**
@@ -221,32 +264,55 @@ void RoadSegment::addIncoming(Car *c) {
     incoming.insert(c->getID());
 }
 
+/**
+ * Unschedules the car from going on this road next, when the car changes its path.
+ */
+void RoadSegment::removeIncoming(Car *c) {
+    assert(incoming.count(c->getID()) > 0 && "car is not scheduled to go on this road");
+    incoming.erase(c->getID());
+}
+
 /**
  * Returns the latest time a car left the waiting queue.
  */
 double RoadSegment::getLatestTime() const { return latestTime; }
 
 /**
- * Returns a pointer to a car given its ID.
- * @param id the ID of the car
+ * Returns a reference to the store of the cars on this road segment.
  */
-Car *RoadSegment::getCar(int id) {
-    assert(cars.count(id) > 0 && "car is not in road");
-    return cars[id];
-}
+CarStore &RoadSegment::getCars() { return cars; }
 
 /**
- * Returns an immutable reference to the cars (and their IDs) on this road segment.
+ * Returns an immutable reference to the store of the cars on this road segment.
  */
-const unordered_map<int, Car*> &RoadSegment::getCars() const { return cars; }
+const CarStore &RoadSegment::getCars() const { return cars; }
 
 /**
  * Returns the direction of this road as an angle (between -pi and pi).
  */
-double RoadSegment::getDirection() const {
-    Point2D sourceLoc = source->getLocation();
-    Point2D destLoc = destination->getLocation();
-    return sourceLoc.angleTo(destLoc);
+double RoadSegment::getDirection() const { return direction; }
+
+/**
+ * Returns the unit vector pointing from the source to the destination of this road.
+ */
+Point2D RoadSegment::getUnitVector() const { return unit; }
+
+/**
+ * Returns the point on this road at a distance from the source.
+ * @param offset the distance from the source of the road
+ */
+Point2D RoadSegment::getPointAt(double offset) const {
+    Point2D srcLoc = source->getLocation();
+    return Point2D(srcLoc.x + offset * unit.x, srcLoc.y + offset * unit.y);
+}
+
+/**
+ * Returns the distance from the source of this road to the projection of a location on to the road.
+ * @param location the location
+ */
+double RoadSegment::getOffsetOf(const Point2D &location) const {
+    Point2D srcLoc = source->getLocation();
+    return (location.x - srcLoc.x) * unit.x + (location.y - srcLoc.y) * unit.y;
 }
 
 /**
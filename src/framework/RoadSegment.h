@@ -2,11 +2,12 @@
 #define ROADSEGMENT_H_
 
 #include <queue>
+#include <random>
 #include <unordered_set>
-#include <unordered_map>
 #include "Forward.h"
 #include "Intersection.h"
 #include "Car.h"
+#include "CarStore.h"
 
 #define MIN_SPEED 0.001
 #define EPS 1e-9
@@ -15,16 +16,20 @@ struct RoadSegment {
 private:
     static int counter; // number of road segments that have been created
     int id; // each road segment has a unique id number
+    int index; // the index of the road segment in the frozen view of the graph
+    int entrySlot; // the position of the road segment among the roads entering its destination in the phase table
+    int exitSlot; // the position of the road segment among the roads leaving its source in the phase table
     Intersection *source; // the source intersection
     Intersection *destination; // the destination intersection
     double length; // the length of the road segment
+    Point2D unit; // the unit vector from the source to the destination
+    double direction; // the direction of the road segment as an angle (between -pi and pi)
     double speedLimit; // the speed limit of the road segment
     int flow; // the current amount of traffic on the road segment
     int capacity; // the maximum number of vehicles on the road segment
-    std::unordered_map<int, Car*> cars; // the cars on this road segement
-    std::queue<int> waiting; // the queue of cars waiting on this intersection
+    CarStore cars; // the cars on this road segement
+    std::queue<Car*> waiting; // the queue of cars waiting on this intersection
     double latestTime; // the latest time a car left the waiting queue
-    std::unordered_set<int> inQueue; // the IDs of the cars in the queue
     std::unordered_set<int> incoming; // the IDs of the next cars scheduled to be on this road
 
     void addFlow(int value);
@@ -34,6 +39,12 @@ public:
     RoadSegment(Intersection *source, Intersection *destination, double speedLimit, int capacity);
     ~RoadSegment();
     int getID() const;
+    int getIndex() const;
+    void setIndex(int index);
+    int getEntrySlot() const;
+    void setEntrySlot(int slot);
+    int getExitSlot() const;
+    void setExitSlot(int slot);
     Intersection *getSource() const;
     Intersection *getDestination() const;
     double getLength() const;
@@ -46,19 +57,24 @@ public:
     bool addCar(Car *c);
     bool removeCar(Car *c);
     bool carOnRoad(Car *c);
-    bool stop(int id);
+    bool stop(Car *c);
     Car *getNextCarFromQueue();
     void removeNextCarFromQueue(double currentTime);
     Car *getLastCarInQueue();
     int countCarsInQueue() const;
-    bool isStopped(int id) const;
+    bool isStopped(Car *c) const;
     void addIncoming(Car *c);
+    void removeIncoming(Car *c);
     double getLatestTime() const;
-    Car *getCar(int id);
-    const std::unordered_map<int, Car*> &getCars() const;
+    CarStore &getCars();
+    const CarStore &getCars() const;
     double getDirection() const;
+    Point2D getUnitVector() const;
+    Point2D getPointAt(double offset) const;
+    double getOffsetOf(const Point2D &location) const;
     bool operator == (const RoadSegment &r) const;
     bool operator != (const RoadSegment &r) const;
+    static std::mt19937 generator; // draws the speeds of the cars entering every road segment
     static bool RoadSegmentPtrPolarOrderCmpLt(const RoadSegment *r, const RoadSegment *s);
     static bool RoadSegmentPtrPolarOrderCmpLe(const RoadSegment *r, const RoadSegment *s);
     static bool RoadSegmentPtrPolarOrderCmpGt(const RoadSegment *r, const RoadSegment *s);
@@ -0,0 +1,135 @@
+#include <assert.h>
+#include "RouteTable.h"
+#include "Intersection.h"
+#include "RoadSegment.h"
+#include "WeightedDigraph.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty route table.
+ */
+RouteTable::RouteTable() {
+    roadCount = 0;
+    epoch = -1;
+}
+
+/**
+ * Deconstructs the route table.
+ */
+RouteTable::~RouteTable() {}
+
+/**
+ * Looks up the traffic light at the end of each road of a route but the last.
+ * @param roads the roads on the route
+ * @param lights set to the lights
+ * @param G the graph the roads must be in, or nullptr if they are known to be in it; the light between two roads is
+ *        nullptr if either road is not in the graph
+ */
+void RouteTable::findLights(const vector<RoadSegment*> &roads, vector<TrafficLight*> &lights, const WeightedDigraph *G) {
+    lights.resize(roads.size() - 1);
+    for (size_t i = 0; i + 1 < roads.size(); i++) {
+        bool removed = G != nullptr && (G->getRoadSegments().count(roads[i]->getID()) == 0
+                                        || G->getRoadSegments().count(roads[i + 1]->getID()) == 0);
+        lights[i] = removed ? nullptr : roads[i]->getDestination()->getLightBetween(roads[i], roads[i + 1]);
+    }
+}
+
+/**
+ * Returns the ID of a route, adding the route and looking up the lights between its roads if no car is using it, and
+ * counts one more car using it. The intersections on the route must have their lights connected.
+ * @param roads the roads on the route (must not be empty)
+ * @return the ID of the route
+ */
+int RouteTable::intern(const vector<RoadSegment*> &roads) {
+    assert(!roads.empty() && "a route must have at least one road");
+    auto it = ids.find(roads);
+    if (it != ids.end()) {
+        references[it->second.id]++;
+        return it->second.id;
+    }
+    int id;
+    if (freeIDs.empty()) {
+        id = routes.size();
+        routes.push_back(nullptr);
+        lights.push_back(nullptr);
+        references.push_back(0);
+    } else {
+        id = freeIDs.back();
+        freeIDs.pop_back();
+    }
+    it = ids.insert({roads, RouteEntry()}).first;
+    RouteEntry &entry = it->second;
+    entry.id = id;
+    findLights(roads, entry.lights, nullptr);
+    routes[id] = &it->first; // entries in the map do not move, so the roads and lights can be referred to directly
+    lights[id] = &entry.lights;
+    references[id] = 1;
+    roadCount += roads.size();
+    return id;
+}
+
+/**
+ * Counts one less car using a route, and removes the route if no car is using it.
+ * @param id the ID of the route
+ */
+void RouteTable::release(int id) {
+    assert(id >= 0 && id < (int) routes.size() && routes[id] != nullptr && "route is not in use");
+    if (--references[id] > 0) return;
+    roadCount -= routes[id]->size();
+    ids.erase(ids.find(*routes[id]));
+    routes[id] = nullptr;
+    lights[id] = nullptr;
+    freeIDs.push_back(id);
+}
+
+/**
+ * Returns the roads on a route. The reference is valid until the route is removed.
+ * @param id the ID of the route
+ */
+const vector<RoadSegment*> &RouteTable::getRoute(int id) const {
+    assert(id >= 0 && id < (int) routes.size() && routes[id] != nullptr && "route is not in use");
+    return *routes[id];
+}
+
+/**
+ * Returns the traffic light at the end of each road of a route but the last. The reference is valid until the route
+ * is removed.
+ * @param id the ID of the route
+ */
+const vector<TrafficLight*> &RouteTable::getLights(int id) const {
+    assert(id >= 0 && id < (int) lights.size() && lights[id] != nullptr && "route is not in use");
+    return *lights[id];
+}
+
+/**
+ * Looks up the lights of every route again if the graph has changed since they were looked up, since removing a
+ * road segment deletes the lights that lead into and out of it. The lights are replaced in place, so the references
+ * returned by getLights() stay valid. The light next to a road segment that was removed becomes nullptr, so a car
+ * that still has such a road ahead of it fails the check in Car::peekNextLight() instead of reading a deleted light.
+ * Must be called after the graph changes and before the cars move again.
+ * @param G the graph the routes are in
+ */
+void RouteTable::refresh(const WeightedDigraph *G) {
+    if (G->getEpoch() == epoch) return;
+    epoch = G->getEpoch();
+    for (pair<const vector<RoadSegment*>, RouteEntry> &route : ids) {
+        findLights(route.first, route.second.lights, G);
+    }
+}
+
+/**
+ * Returns the number of cars using a route.
+ * @param id the ID of the route
+ */
+int RouteTable::countReferences(int id) const { return references[id]; }
+
+/**
+ * Returns the number of distinct routes in use.
+ */
+int RouteTable::size() const { return ids.size(); }
+
+/**
+ * Returns the total number of roads stored in all routes.
+ */
+long long RouteTable::countRoads() const { return roadCount; }
@@ -0,0 +1,49 @@
+#ifndef ROUTETABLE_H_
+#define ROUTETABLE_H_
+
+#include <vector>
+#include <unordered_map>
+#include "Forward.h"
+#include "../misc/vector_hash.h"
+
+/**
+ * The ID of a route in a route table, and the traffic light that lets a car from each road of the route onto the next.
+ */
+struct RouteEntry {
+    int id; // the ID of the route
+    std::vector<TrafficLight*> lights; // the light at the end of each road of the route but the last
+};
+
+/**
+ * Stores each distinct route once, so that cars with identical routes share the same array of roads. A route is
+ * every road a car travels on, from the road it starts on to the road its destination is on. The traffic lights
+ * between the roads are looked up once when a route is added, so cars do not look them up at every intersection,
+ * and again for every route when the graph changes, since removing a road segment deletes the lights it leads to.
+ * Routes are counted by the number of cars using them and are removed when no car uses them.
+ */
+struct RouteTable {
+private:
+    std::unordered_map<std::vector<RoadSegment*>, RouteEntry, vector_hash<RoadSegment*>> ids; // maps each route to its ID and lights
+    std::vector<const std::vector<RoadSegment*>*> routes; // the roads of each route, nullptr if the ID is not in use
+    std::vector<const std::vector<TrafficLight*>*> lights; // the lights of each route, nullptr if the ID is not in use
+    std::vector<int> references; // the number of cars using each route
+    std::vector<int> freeIDs; // the IDs that are not in use
+    long long roadCount; // the total number of roads stored in all routes
+    long long epoch; // the epoch of the graph the lights of the routes were looked up in, -1 if it is not known
+
+    static void findLights(const std::vector<RoadSegment*> &roads, std::vector<TrafficLight*> &lights, const WeightedDigraph *G);
+
+public:
+    RouteTable();
+    ~RouteTable();
+    int intern(const std::vector<RoadSegment*> &roads);
+    void release(int id);
+    const std::vector<RoadSegment*> &getRoute(int id) const;
+    const std::vector<TrafficLight*> &getLights(int id) const;
+    void refresh(const WeightedDigraph *G);
+    int countReferences(int id) const;
+    int size() const;
+    long long countRoads() const;
+};
+
+#endif
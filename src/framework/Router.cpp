@@ -0,0 +1,65 @@
+#include <limits>
+#include "Router.h"
+#include "WeightedDigraph.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty path.
+ */
+ShortestPath::ShortestPath() {
+    clear();
+}
+
+/**
+ * Returns true if a path was found, false otherwise.
+ */
+bool ShortestPath::exists() const { return time != numeric_limits<double>::infinity(); }
+
+/**
+ * Clears the path, keeping the memory of the roads.
+ */
+void ShortestPath::clear() {
+    time = numeric_limits<double>::infinity();
+    sourceID = destinationID = -1;
+    roads.clear();
+}
+
+/**
+ * Initializes the Router given a Weighted Directed Graph.
+ * @param G the Weighted Directed Graph that the router will find paths in
+ */
+Router::Router(WeightedDigraph *G) {
+    this->G = G;
+}
+
+/**
+ * Deconstructs the Router.
+ */
+Router::~Router() {}
+
+/**
+ * Returns a pointer to the weighted directed graph.
+ */
+WeightedDigraph *Router::getGraph() const { return G; }
+
+/**
+ * Brings the data of the router up to date with the graph. Must be called from a single thread before cars are routed
+ * from multiple threads. Routing from a single thread prepares the router as needed.
+ */
+void Router::prepare() {
+    G->freeze();
+}
+
+/**
+ * Lets the router update its weights from the current state of the city. Called from a single thread between
+ * iterations of the simulation, before new cars are routed. Does nothing by default.
+ * @param currentTime the current time of the simulation
+ */
+void Router::refresh(double /*currentTime*/) {}
+
+/**
+ * Returns a number that changes every time the weights used by the router change, so paths found with older
+ * weights can be told apart. Routers that only use the expected times of the road segments always return 0.
+ */
+long long Router::getWeightEpoch() const { return 0; }
@@ -0,0 +1,42 @@
+#ifndef ROUTER_H_
+#define ROUTER_H_
+
+#include <vector>
+#include "Forward.h"
+
+/**
+ * The result of routing a car: the fastest path from one of the possible sources to one of the possible destinations.
+ */
+struct ShortestPath {
+    double time; // the expected time of the path including the initial and excess times, infinity if there is no path
+    int sourceID; // the ID of the intersection the path starts at, -1 if there is no path
+    int destinationID; // the ID of the intersection the path ends at, -1 if there is no path
+    std::vector<RoadSegment*> roads; // the roads on the path
+
+    ShortestPath();
+    bool exists() const;
+    void clear();
+};
+
+/**
+ * Finds the paths that cars take through the city. A router may keep data built from the graph, but it only reads
+ * that data while routing, and keeps its search memory per thread, so cars can be routed from multiple threads once
+ * the router has been prepared.
+ */
+struct Router {
+protected:
+    WeightedDigraph *G; // the weighted directed graph, representing the city
+
+public:
+    Router(WeightedDigraph *G);
+    virtual ~Router();
+    WeightedDigraph *getGraph() const;
+    virtual const char *getName() const = 0;
+    virtual void prepare();
+    virtual void refresh(double currentTime);
+    virtual long long getWeightEpoch() const;
+    virtual void route(std::vector<int> &sourceIDs, std::vector<double> &initialTime, std::vector<int> &destinationIDs,
+            std::vector<double> &excessTime, ShortestPath &path) = 0;
+};
+
+#endif
@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <assert.h>
+#include "SpatialIndex.h"
+#include "Intersection.h"
+#include "RoadSegment.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty spatial index.
+ * @param cellSize the width and height of a cell
+ */
+SpatialIndex::SpatialIndex(double cellSize) {
+    assert(cellSize > 0.0 && "cellSize must be a positive value");
+    this->cellSize = cellSize;
+    clear();
+}
+
+/**
+ * Deconstructs the SpatialIndex.
+ */
+SpatialIndex::~SpatialIndex() {}
+
+/**
+ * Returns the column of the cells that hold an x coordinate.
+ * @param x the x coordinate
+ */
+int SpatialIndex::column(double x) const { return (int) floor(x / cellSize); }
+
+/**
+ * Returns the row of the cells that hold a y coordinate.
+ * @param y the y coordinate
+ */
+int SpatialIndex::row(double y) const { return (int) floor(y / cellSize); }
+
+/**
+ * Returns the key of a cell in the map of cells. The column and row are packed into one number, since hashing them
+ * as a pair gives the same hash to many cells of a grid.
+ * @param c the column of the cell
+ * @param r the row of the cell
+ */
+long long SpatialIndex::key(int c, int r) { return (long long) c << 32 | (unsigned int) r; }
+
+/**
+ * Grows the range of cells that have held something to include a cell.
+ * @param c the column of the cell
+ * @param r the row of the cell
+ */
+void SpatialIndex::cover(int c, int r) {
+    minColumn = min(minColumn, c);
+    maxColumn = max(maxColumn, c);
+    minRow = min(minRow, r);
+    maxRow = max(maxRow, r);
+}
+
+/**
+ * Finds the range of cells the bounding box of a road segment overlaps.
+ * @param r the road segment
+ * @param c0 set to the first column
+ * @param r0 set to the first row
+ * @param c1 set to the last column
+ * @param r1 set to the last row
+ */
+void SpatialIndex::getCells(RoadSegment *r, int &c0, int &r0, int &c1, int &r1) const {
+    Point2D a = r->getSource()->getLocation(), b = r->getDestination()->getLocation();
+    c0 = column(min(a.x, b.x));
+    c1 = column(max(a.x, b.x));
+    r0 = row(min(a.y, b.y));
+    r1 = row(max(a.y, b.y));
+}
+
+/**
+ * Returns the distance from a point to the closest point on a road segment.
+ * @param r the road segment
+ * @param p the point
+ */
+double SpatialIndex::distanceTo(RoadSegment *r, const Point2D &p) {
+    double offset = max(0.0, min(r->getLength(), r->getOffsetOf(p)));
+    return r->getPointAt(offset).distanceTo(p);
+}
+
+/**
+ * Returns true if a road segment has a point inside or on the edge of a box, false otherwise.
+ * @param r the road segment
+ * @param minX the left of the box
+ * @param minY the top of the box
+ * @param maxX the right of the box
+ * @param maxY the bottom of the box
+ */
+bool SpatialIndex::crosses(RoadSegment *r, double minX, double minY, double maxX, double maxY) {
+    Point2D a = r->getSource()->getLocation(), b = r->getDestination()->getLocation();
+    double dx = b.x - a.x, dy = b.y - a.y;
+    // clips the road segment to each side of the box in turn, and checks that some of it is left
+    double p[4] = {-dx, dx, -dy, dy};
+    double q[4] = {a.x - minX, maxX - a.x, a.y - minY, maxY - a.y};
+    double t0 = 0.0, t1 = 1.0;
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) return false;
+            continue;
+        }
+        double t = q[i] / p[i];
+        if (p[i] < 0.0) {
+            if (t > t1) return false;
+            t0 = max(t0, t);
+        } else {
+            if (t < t0) return false;
+            t1 = min(t1, t);
+        }
+    }
+    return true;
+}
+
+/**
+ * Adds an intersection to the index.
+ * @param intxn the intersection
+ */
+void SpatialIndex::add(Intersection *intxn) {
+    int c = column(intxn->getLocation().x), r = row(intxn->getLocation().y);
+    cells[key(c, r)].intersections.push_back(intxn);
+    cover(c, r);
+    intersections++;
+}
+
+/**
+ * Removes an intersection from the index.
+ * @param intxn the intersection
+ */
+void SpatialIndex::remove(Intersection *intxn) {
+    auto it = cells.find(key(column(intxn->getLocation().x), row(intxn->getLocation().y)));
+    assert(it != cells.end() && "the intersection is not in the index");
+    vector<Intersection*> &list = it->second.intersections;
+    auto found = find(list.begin(), list.end(), intxn);
+    assert(found != list.end() && "the intersection is not in the index");
+    *found = list.back();
+    list.pop_back();
+    if (list.empty() && it->second.roads.empty()) cells.erase(it);
+    intersections--;
+}
+
+/**
+ * Adds a road segment to the index.
+ * @param r the road segment
+ */
+void SpatialIndex::add(RoadSegment *r) {
+    int c0, r0, c1, r1;
+    getCells(r, c0, r0, c1, r1);
+    for (int c = c0; c <= c1; c++) {
+        for (int w = r0; w <= r1; w++) {
+            cells[key(c, w)].roads.push_back(r);
+        }
+    }
+    cover(c0, r0);
+    cover(c1, r1);
+    roads++;
+}
+
+/**
+ * Removes a road segment from the index.
+ * @param r the road segment
+ */
+void SpatialIndex::remove(RoadSegment *r) {
+    int c0, r0, c1, r1;
+    getCells(r, c0, r0, c1, r1);
+    for (int c = c0; c <= c1; c++) {
+        for (int w = r0; w <= r1; w++) {
+            auto it = cells.find(key(c, w));
+            assert(it != cells.end() && "the road segment is not in the index");
+            vector<RoadSegment*> &list = it->second.roads;
+            auto found = find(list.begin(), list.end(), r);
+            assert(found != list.end() && "the road segment is not in the index");
+            *found = list.back();
+            list.pop_back();
+            if (list.empty() && it->second.intersections.empty()) cells.erase(it);
+        }
+    }
+    roads--;
+}
+
+/**
+ * Removes every intersection and road segment from the index.
+ */
+void SpatialIndex::clear() {
+    cells.clear();
+    minColumn = minRow = INT_MAX;
+    maxColumn = maxRow = INT_MIN;
+    intersections = 0;
+    roads = 0;
+}
+
+/**
+ * Returns the width and height of a cell.
+ */
+double SpatialIndex::getCellSize() const { return cellSize; }
+
+/**
+ * Returns the number of intersections in the index.
+ */
+int SpatialIndex::countIntersections() const { return intersections; }
+
+/**
+ * Returns the number of road segments in the index.
+ */
+int SpatialIndex::countRoadSegments() const { return roads; }
+
+/**
+ * Calls a function with the cells around a point in rings of growing Chebyshev distance from the cell of the point,
+ * starting at the first ring that reaches the cells that have held something. After the ring at distance k, every
+ * cell that was not visited is at least k cells from the point, so the search stops once the function has found
+ * something closer than that.
+ * @param p the point
+ * @param visit called with each cell, returns the distance to the closest thing found so far
+ */
+template<typename Visit> void SpatialIndex::searchRings(const Point2D &p, Visit visit) const {
+    if (minColumn > maxColumn) return;
+    int pc = column(p.x), pr = row(p.y);
+    int k = max(max(0, max(minColumn - pc, pc - maxColumn)), max(minRow - pr, pr - maxRow));
+    double best = numeric_limits<double>::infinity();
+    auto look = [&] (int c, int r) {
+        auto it = cells.find(key(c, r));
+        if (it != cells.end()) best = visit(it->second);
+    };
+    for (;; k++) {
+        for (int r : {pr - k, pr + k}) {
+            if (r >= minRow && r <= maxRow) {
+                for (int c = max(pc - k, minColumn); c <= min(pc + k, maxColumn); c++) look(c, r);
+            }
+            if (k == 0) break;
+        }
+        for (int c : {pc - k, pc + k}) {
+            if (k == 0 || c < minColumn || c > maxColumn) continue;
+            for (int r = max(pr - k + 1, minRow); r <= min(pr + k - 1, maxRow); r++) look(c, r);
+        }
+        if (best <= k * cellSize) return;
+        if (pc - k <= minColumn && pc + k >= maxColumn && pr - k <= minRow && pr + k >= maxRow) return;
+    }
+}
+
+/**
+ * Returns the intersection closest to a point, nullptr if the index has no intersections.
+ * @param p the point
+ */
+Intersection *SpatialIndex::nearestIntersection(const Point2D &p) const {
+    Intersection *nearest = nullptr;
+    double best = numeric_limits<double>::infinity();
+    if (intersections == 0) return nullptr;
+    searchRings(p, [&] (const SpatialCell &cell) {
+        for (Intersection *intxn : cell.intersections) {
+            double d = intxn->getLocation().distanceTo(p);
+            if (d < best || (d == best && intxn->getID() < nearest->getID())) {
+                best = d;
+                nearest = intxn;
+            }
+        }
+        return best;
+    });
+    return nearest;
+}
+
+/**
+ * Returns the road segment closest to a point, nullptr if the index has no road segments.
+ * @param p the point
+ */
+RoadSegment *SpatialIndex::nearestRoadSegment(const Point2D &p) const {
+    RoadSegment *nearest = nullptr;
+    double best = numeric_limits<double>::infinity();
+    if (roads == 0) return nullptr;
+    searchRings(p, [&] (const SpatialCell &cell) {
+        for (RoadSegment *r : cell.roads) {
+            double d = distanceTo(r, p);
+            if (d < best || (d == best && r->getID() < nearest->getID())) {
+                best = d;
+                nearest = r;
+            }
+        }
+        return best;
+    });
+    return nearest;
+}
+
+/**
+ * Finds the intersections inside a box, including its edges.
+ * @param topLeft the corner of the box with the smallest coordinates
+ * @param bottomRight the corner of the box with the largest coordinates
+ * @param found the vector the intersections are added to
+ */
+void SpatialIndex::findIntersections(const Point2D &topLeft, const Point2D &bottomRight, vector<Intersection*> &found) const {
+    for (int c = max(column(topLeft.x), minColumn); c <= min(column(bottomRight.x), maxColumn); c++) {
+        for (int r = max(row(topLeft.y), minRow); r <= min(row(bottomRight.y), maxRow); r++) {
+            auto it = cells.find(key(c, r));
+            if (it == cells.end()) continue;
+            for (Intersection *intxn : it->second.intersections) {
+                Point2D p = intxn->getLocation();
+                if (p.x >= topLeft.x && p.x <= bottomRight.x && p.y >= topLeft.y && p.y <= bottomRight.y) found.push_back(intxn);
+            }
+        }
+    }
+}
+
+/**
+ * Finds the road segments that pass through a box, including its edges.
+ * @param topLeft the corner of the box with the smallest coordinates
+ * @param bottomRight the corner of the box with the largest coordinates
+ * @param found the vector the road segments are added to
+ */
+void SpatialIndex::findRoadSegments(const Point2D &topLeft, const Point2D &bottomRight, vector<RoadSegment*> &found) const {
+    int qc = column(topLeft.x), qr = row(topLeft.y);
+    for (int c = max(qc, minColumn); c <= min(column(bottomRight.x), maxColumn); c++) {
+        for (int r = max(qr, minRow); r <= min(row(bottomRight.y), maxRow); r++) {
+            auto it = cells.find(key(c, r));
+            if (it == cells.end()) continue;
+            for (RoadSegment *road : it->second.roads) {
+                // a road segment is in several cells, so it is only reported from the first cell the box shares with it
+                int c0, r0, c1, r1;
+                getCells(road, c0, r0, c1, r1);
+                if (c != max(c0, qc) || r != max(r0, qr)) continue;
+                if (crosses(road, topLeft.x, topLeft.y, bottomRight.x, bottomRight.y)) found.push_back(road);
+            }
+        }
+    }
+}
+
+/**
+ * Finds the intersections within a distance of a point.
+ * @param center the point
+ * @param radius the distance
+ * @param found the vector the intersections are added to
+ */
+void SpatialIndex::findIntersections(const Point2D &center, double radius, vector<Intersection*> &found) const {
+    size_t first = found.size();
+    findIntersections(Point2D(center.x - radius, center.y - radius), Point2D(center.x + radius, center.y + radius), found);
+    found.erase(remove_if(found.begin() + first, found.end(), [&] (Intersection *intxn) {
+        return intxn->getLocation().distanceTo(center) > radius;
+    }), found.end());
+}
+
+/**
+ * Finds the road segments that pass within a distance of a point.
+ * @param center the point
+ * @param radius the distance
+ * @param found the vector the road segments are added to
+ */
+void SpatialIndex::findRoadSegments(const Point2D &center, double radius, vector<RoadSegment*> &found) const {
+    size_t first = found.size();
+    findRoadSegments(Point2D(center.x - radius, center.y - radius), Point2D(center.x + radius, center.y + radius), found);
+    found.erase(remove_if(found.begin() + first, found.end(), [&] (RoadSegment *r) {
+        return distanceTo(r, center) > radius;
+    }), found.end());
+}
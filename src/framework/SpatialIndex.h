@@ -0,0 +1,63 @@
+#ifndef SPATIALINDEX_H_
+#define SPATIALINDEX_H_
+
+#include <utility>
+#include <vector>
+#include <unordered_map>
+#include "Forward.h"
+#include "Point2D.h"
+
+#define SPATIAL_CELL_SIZE 100.0 // the width and height of a cell of the spatial index of a graph
+
+/**
+ * The intersections and road segments in one cell of a spatial index.
+ */
+struct SpatialCell {
+    std::vector<Intersection*> intersections; // the intersections located in the cell
+    std::vector<RoadSegment*> roads; // the road segments whose bounding box overlaps the cell
+};
+
+/**
+ * A uniform grid over the plane that finds the intersections and road segments near a point or inside a box without
+ * looking at the rest of the city. An intersection is stored in the cell it is located in, and a road segment in
+ * every cell its bounding box overlaps. Only the cells that hold something are stored, so the grid does not need to
+ * know the size of the city, and intersections and road segments are added and removed one at a time as the graph
+ * changes.
+ */
+struct SpatialIndex {
+private:
+    double cellSize; // the width and height of a cell
+    std::unordered_map<long long, SpatialCell> cells; // the cells that hold something, by the key of their column and row
+    int minColumn, maxColumn, minRow, maxRow; // the range of cells that have held something
+    int intersections; // the number of intersections in the index
+    int roads; // the number of road segments in the index
+
+    int column(double x) const;
+    int row(double y) const;
+    static long long key(int c, int r);
+    void cover(int c, int r);
+    void getCells(RoadSegment *r, int &c0, int &r0, int &c1, int &r1) const;
+    static double distanceTo(RoadSegment *r, const Point2D &p);
+    static bool crosses(RoadSegment *r, double minX, double minY, double maxX, double maxY);
+    template<typename Visit> void searchRings(const Point2D &p, Visit visit) const;
+
+public:
+    SpatialIndex(double cellSize);
+    ~SpatialIndex();
+    void add(Intersection *intxn);
+    void remove(Intersection *intxn);
+    void add(RoadSegment *r);
+    void remove(RoadSegment *r);
+    void clear();
+    double getCellSize() const;
+    int countIntersections() const;
+    int countRoadSegments() const;
+    Intersection *nearestIntersection(const Point2D &p) const;
+    RoadSegment *nearestRoadSegment(const Point2D &p) const;
+    void findIntersections(const Point2D &topLeft, const Point2D &bottomRight, std::vector<Intersection*> &found) const;
+    void findRoadSegments(const Point2D &topLeft, const Point2D &bottomRight, std::vector<RoadSegment*> &found) const;
+    void findIntersections(const Point2D &center, double radius, std::vector<Intersection*> &found) const;
+    void findRoadSegments(const Point2D &center, double radius, std::vector<RoadSegment*> &found) const;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include <assert.h>
+#include <random>
+#include "SpawnWave.h"
+#include "Car.h"
+#include "CarPool.h"
+#include "RoadSegment.h"
+#include "Intersection.h"
+#include "WeightedDigraph.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty wave.
+ */
+SpawnWave::SpawnWave() {
+    count = 0;
+    routed = false;
+}
+
+/**
+ * Returns a random road segment in the graph that has room for another car, counting the trips already drawn in
+ * this wave that start on it. Uses the same random numbers as getRandomRoadSegment().
+ * @param G the Weighted Directed Graph
+ * @param reserve true to reserve room for a car on the road segment
+ */
+RoadSegment *SpawnWave::getRandomRoadSegment(WeightedDigraph *G, bool reserve) {
+    uniform_int_distribution<int> intDistribution(0, G->countRoadSegments() - 1);
+    while (true) {
+        int randIndex = intDistribution(Car::generator);
+        assert(randIndex >= 0 && randIndex < G->countRoadSegments());
+        RoadSegment *r = G->getRoadSegment(G->getRoadSegmentID(randIndex));
+        if (r->getCapacity() - r->getFlow() - pending[randIndex] < 1) continue;
+        if (reserve) {
+            if (pending[randIndex]++ == 0) reserved.push_back(randIndex);
+        }
+        return r;
+    }
+}
+
+/**
+ * Draws the trips of the wave, in the same way as getRandomCar().
+ * MAKE SURE THAT RAND HAS A SEED
+ * @param G the Weighted Directed Graph
+ * @param cars the number of trips to draw
+ */
+void SpawnWave::draw(WeightedDigraph *G, int cars) {
+    assert(count == 0 && "the previous wave has not been inserted");
+    pending.resize(G->countRoadSegments(), 0);
+    if ((int) trips.size() < cars) trips.resize(cars);
+    for (count = 0; count < cars; count++) {
+        SpawnTrip &t = trips[count];
+        t.source = getRandomRoadSegment(G, true);
+        do {
+            t.destination = getRandomRoadSegment(G, false);
+        } while (t.source->getID() == t.destination->getID() || t.source->getDestination()->getID() == t.destination->getSource()->getID()
+                 || t.source->getSource()->getID() == t.destination->getDestination()->getID());
+        t.sourceLocation = getRandomLocation(t.source);
+        t.destinationLocation = getRandomLocation(t.destination);
+    }
+    routed = false;
+}
+
+/**
+ * Finds the paths of all trips in the wave in parallel. The graph and the road segments are only read, so this must
+ * not run at the same time as an iteration of the simulation.
+ * @param G the Weighted Directed Graph
+ * @param pool the threads that find the paths, nullptr to find them on the calling thread
+ */
+void SpawnWave::route(WeightedDigraph *G, ThreadPool *pool) {
+    G->getRouter()->prepare(); // builds the router data once before the threads read it
+    auto findPath = [&] (int i) {
+        static thread_local vector<RoadSegment*> sourceRoads(1), destinationRoads(1);
+        SpawnTrip &t = trips[i];
+        sourceRoads[0] = t.source;
+        destinationRoads[0] = t.destination;
+        Car::findPath(t.sourceLocation, t.destinationLocation, sourceRoads, destinationRoads, G, t.path);
+    };
+    if (pool == nullptr) {
+        for (int i = 0; i < count; i++) findPath(i);
+    } else {
+        pool->parallelFor(count, findPath);
+    }
+    routed = true;
+}
+
+/**
+ * Adds the cars of the wave to the city in the order their trips were drawn, and empties the wave.
+ * @param currentTime the current time in the simulation
+ * @param cars the cars that were added
+ */
+void SpawnWave::insert(double currentTime, vector<Car*> &cars) {
+    assert(routed && "the wave has not been routed");
+    cars.clear();
+    static thread_local vector<RoadSegment*> sourceRoads(1), destinationRoads(1);
+    for (int i = 0; i < count; i++) {
+        SpawnTrip &t = trips[i];
+        sourceRoads[0] = t.source;
+        destinationRoads[0] = t.destination;
+        Car *c = Car::pool.acquire();
+        c->init(t.sourceLocation, t.destinationLocation, sourceRoads, destinationRoads, t.path, currentTime);
+        cars.push_back(c);
+    }
+    clear();
+}
+
+/**
+ * Returns the number of trips in the wave.
+ */
+int SpawnWave::size() const { return count; }
+
+/**
+ * Returns whether the paths of the trips in the wave have been found.
+ */
+bool SpawnWave::isRouted() const { return routed; }
+
+/**
+ * Drops the trips of the wave and their reservations without adding any cars.
+ */
+void SpawnWave::clear() {
+    for (int i : reserved) pending[i] = 0;
+    reserved.clear();
+    count = 0;
+    routed = false;
+}
+
+/**
+ * Deconstructs the SpawnWave.
+ */
+SpawnWave::~SpawnWave() {}
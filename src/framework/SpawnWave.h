@@ -0,0 +1,48 @@
+#ifndef SPAWNWAVE_H_
+#define SPAWNWAVE_H_
+
+#include <vector>
+#include "Forward.h"
+#include "Point2D.h"
+#include "Router.h"
+#include "../misc/ThreadPool.h"
+
+/**
+ * A trip of a car that is waiting to be spawned.
+ */
+struct SpawnTrip {
+    RoadSegment *source; // the road segment the car starts on
+    RoadSegment *destination; // the road segment the car ends on
+    Point2D sourceLocation; // the exact location the car starts at
+    Point2D destinationLocation; // the exact location the car ends at
+    ShortestPath path; // the path of the car, found when the wave is routed
+};
+
+/**
+ * Spawns a wave of cars at once. The trips of the whole wave are drawn first, then all of their paths are found in
+ * parallel while the graph is only read, and then the cars are added to the city in the order their trips were
+ * drawn, so the result does not depend on the number of threads. Drawing a trip reserves room on its source road,
+ * so a wave never starts more cars on a road than fit on it.
+ */
+struct SpawnWave {
+private:
+    std::vector<SpawnTrip> trips; // the trips of the wave, only the first count of which are used
+    int count; // the number of trips in the wave
+    std::vector<int> pending; // the number of trips in the wave that start on each road segment, by index
+    std::vector<int> reserved; // the indices of the road segments with pending trips
+    bool routed; // whether the paths of the trips have been found
+
+    RoadSegment *getRandomRoadSegment(WeightedDigraph *G, bool reserve);
+
+public:
+    SpawnWave();
+    ~SpawnWave();
+    void draw(WeightedDigraph *G, int cars);
+    void route(WeightedDigraph *G, ThreadPool *pool);
+    void insert(double currentTime, std::vector<Car*> &cars);
+    int size() const;
+    bool isRouted() const;
+    void clear();
+};
+
+#endif
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <limits>
+#include <assert.h>
+#include "TravelTimeMatrix.h"
+#include "Intersection.h"
+#include "WeightedDigraph.h"
+#include "../misc/IndexMinPQ.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty matrix.
+ */
+TravelTimeMatrix::TravelTimeMatrix() {
+    rows = 0;
+    columns = 0;
+    targets = 0;
+}
+
+/**
+ * Deconstructs the matrix.
+ */
+TravelTimeMatrix::~TravelTimeMatrix() {}
+
+/**
+ * Computes the times from every source to every destination, replacing the previous matrix. The time is infinity
+ * if there is no path, and zero from an intersection to itself. The graph is only read while the searches run, so
+ * it must not change until this returns.
+ * @param G the Weighted Directed Graph
+ * @param sourceIDs the intersection IDs of the sources, one per row
+ * @param destinationIDs the intersection IDs of the destinations, one per column
+ * @param pool the threads that run the searches, nullptr to run them on the calling thread
+ */
+void TravelTimeMatrix::compute(WeightedDigraph *G, const vector<int> &sourceIDs, const vector<int> &destinationIDs, ThreadPool *pool) {
+    const GraphView &view = G->freeze();
+    rows = sourceIDs.size();
+    columns = destinationIDs.size();
+    times.assign((size_t) rows * columns, numeric_limits<double>::infinity());
+    sources.resize(rows);
+    for (int i = 0; i < rows; i++) {
+        sources[i] = G->getIntersection(sourceIDs[i])->getIndex();
+    }
+    firstColumn.assign(view.countIntersections(), -1);
+    nextColumn.assign(columns, -1);
+    targets = 0;
+    for (int j = columns - 1; j >= 0; j--) {
+        int v = G->getIntersection(destinationIDs[j])->getIndex();
+        if (firstColumn[v] == -1) targets++;
+        nextColumn[j] = firstColumn[v];
+        firstColumn[v] = j;
+    }
+    if (columns == 0) return;
+    if (pool == nullptr) {
+        for (int i = 0; i < rows; i++) sweep(view, i);
+    } else {
+        pool->parallelFor(rows, [&] (int i) { sweep(view, i); });
+    }
+}
+
+/**
+ * Fills one row of the matrix with Dijkstra's algorithm from its source, stopping once every destination has been
+ * visited. Only the row itself is written, so the rows can be filled concurrently.
+ * @param view the frozen view of the graph
+ * @param row the row of the source
+ */
+void TravelTimeMatrix::sweep(const GraphView &view, int row) {
+    // the scratch arrays are kept per thread, and an entry is only valid if its stamp matches the current sweep
+    static thread_local vector<double> timeTo;
+    static thread_local vector<int> reached;
+    static thread_local int stamp = 0;
+    static thread_local IndexMinPQ pq;
+    int V = view.countIntersections();
+    if ((int) reached.size() < V) {
+        timeTo.resize(V);
+        reached.resize(V, 0);
+        pq.reserve(V);
+    }
+    if (stamp == numeric_limits<int>::max()) { // the stamps wrapped around, so the old ones have to be cleared
+        fill(reached.begin(), reached.end(), 0);
+        stamp = 0;
+    }
+    stamp++;
+    pq.clear();
+    double *out = &times[(size_t) row * columns];
+    const int *outTargets = view.getOutTargets();
+    const double *outWeights = view.getOutWeights();
+    int s = sources[row];
+    reached[s] = stamp;
+    timeTo[s] = 0.0;
+    pq.push(s, 0.0);
+    int remaining = targets;
+    while (!pq.isEmpty()) {
+        int v = pq.pop();
+        if (firstColumn[v] != -1) {
+            for (int j = firstColumn[v]; j != -1; j = nextColumn[j]) out[j] = timeTo[v];
+            if (--remaining == 0) break;
+        }
+        for (int e = view.outBegin(v); e < view.outEnd(v); e++) {
+            int w = outTargets[e];
+            double time = timeTo[v] + outWeights[e];
+            if (reached[w] == stamp && timeTo[w] <= time) continue;
+            bool queued = reached[w] == stamp;
+            reached[w] = stamp;
+            timeTo[w] = time;
+            if (queued) pq.decreaseKey(w, time);
+            else pq.push(w, time);
+        }
+    }
+}
+
+/**
+ * Returns the number of sources, which is the number of rows.
+ */
+int TravelTimeMatrix::countSources() const { return rows; }
+
+/**
+ * Returns the number of destinations, which is the number of columns.
+ */
+int TravelTimeMatrix::countDestinations() const { return columns; }
+
+/**
+ * Returns the time from a source to a destination, or infinity if there is no path.
+ * @param source the row of the source
+ * @param destination the column of the destination
+ */
+double TravelTimeMatrix::getTime(int source, int destination) const {
+    assert(source >= 0 && source < rows && destination >= 0 && destination < columns && "entry is out of range");
+    return times[(size_t) source * columns + destination];
+}
+
+/**
+ * Returns the times from a source to every destination, in the order of the destinations.
+ * @param source the row of the source
+ */
+const double *TravelTimeMatrix::getRow(int source) const {
+    assert(source >= 0 && source < rows && "source is out of range");
+    return &times[(size_t) source * columns];
+}
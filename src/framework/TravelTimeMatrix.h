@@ -0,0 +1,37 @@
+#ifndef TRAVELTIMEMATRIX_H_
+#define TRAVELTIMEMATRIX_H_
+
+#include <vector>
+#include "Forward.h"
+#include "GraphView.h"
+#include "../misc/ThreadPool.h"
+
+/**
+ * The expected times between every pair of a set of source intersections and a set of destination intersections,
+ * at the speed limits of the road segments. Each source takes one search over the frozen view that stops once every
+ * destination has been reached, and the searches of different sources run in parallel, so a whole matrix costs
+ * about as much as one search per source divided by the number of threads.
+ */
+struct TravelTimeMatrix {
+private:
+    int rows; // the number of sources
+    int columns; // the number of destinations
+    std::vector<double> times; // the time from source i to destination j is times[i * columns + j]
+    std::vector<int> sources; // the index of each source intersection
+    std::vector<int> firstColumn; // the first column of each intersection, -1 if it is not a destination
+    std::vector<int> nextColumn; // the next column with the same destination intersection, -1 if there is none
+    int targets; // the number of distinct destination intersections
+
+    void sweep(const GraphView &view, int row);
+
+public:
+    TravelTimeMatrix();
+    ~TravelTimeMatrix();
+    void compute(WeightedDigraph *G, const std::vector<int> &sourceIDs, const std::vector<int> &destinationIDs, ThreadPool *pool);
+    int countSources() const;
+    int countDestinations() const;
+    double getTime(int source, int destination) const;
+    const double *getRow(int source) const;
+};
+
+#endif
@@ -1,21 +1,26 @@
 #include <assert.h>
 #include <cstdio>
 #include "WeightedDigraph.h"
+#include "DijkstraRouter.h"
 
 using namespace std;
 
 /**
  * Initializes a Weighted Directed Graph.
  */
-WeightedDigraph::WeightedDigraph() {
+WeightedDigraph::WeightedDigraph() : spatialIndex(SPATIAL_CELL_SIZE) {
     intersections = 0;
     roadSegments = 0;
+    epoch = 0;
+    router = new DijkstraRouter(this);
 }
 
 /**
- * Deconstructs the Weighted Directed Graph.
+ * Deconstructs the Weighted Directed Graph and its router.
  */
-WeightedDigraph::~WeightedDigraph() {}
+WeightedDigraph::~WeightedDigraph() {
+    delete router;
+}
 
 /**
  * Returns the number of intersections (vertices) in this graph.
@@ -27,6 +32,19 @@ int WeightedDigraph::countIntersections() const { return intersections; }
  */
 int WeightedDigraph::countRoadSegments() const { return roadSegments; }
 
+/**
+ * Makes room for the specified number of intersections and road segments, so that adding them to the graph does
+ * not have to grow the tables one step at a time.
+ * @param intersections the number of intersections
+ * @param roadSegments the number of road segments
+ */
+void WeightedDigraph::reserve(int intersections, int roadSegments) {
+    idToIntersection.reserve(intersections);
+    idToRoadSegment.reserve(roadSegments);
+    compressedIndex.reserve(roadSegments);
+    roadSegmentIDs.reserve(roadSegments);
+}
+
 /**
  * Adds a road segment to the graph.
  * @param r the Road Segment
@@ -34,11 +52,19 @@ int WeightedDigraph::countRoadSegments() const { return roadSegments; }
  */
 bool WeightedDigraph::addRoadSegment(RoadSegment *r) {
     if (idToRoadSegment.count(r->getID())) return false;
+    epoch++;
     idToRoadSegment[r->getID()] = r;
-    if (idToIntersection.count(r->getSource()->getID()) == 0) intersections++;
+    if (idToIntersection.count(r->getSource()->getID()) == 0) {
+        intersections++;
+        spatialIndex.add(r->getSource());
+    }
     idToIntersection[r->getSource()->getID()] = r->getSource();
-    if (idToIntersection.count(r->getDestination()->getID()) == 0) intersections++;
+    if (idToIntersection.count(r->getDestination()->getID()) == 0) {
+        intersections++;
+        spatialIndex.add(r->getDestination());
+    }
     idToIntersection[r->getDestination()->getID()] = r->getDestination();
+    spatialIndex.add(r);
     r->getSource()->add(r);
     r->getDestination()->add(r);
     compressedIndex[r->getID()] = roadSegments++;
@@ -46,6 +72,28 @@ bool WeightedDigraph::addRoadSegment(RoadSegment *r) {
     return true;
 }
 
+/**
+ * Adds road segments whose intersections already hold them in an adopted phase table (see Intersection::adopt()),
+ * so the intersections are not given the road segments one at a time. None of the road segments can be in the graph.
+ * @param roads the road segments
+ */
+void WeightedDigraph::addAdoptedRoadSegments(const vector<RoadSegment*> &roads) {
+    epoch++;
+    for (RoadSegment *r : roads) {
+        bool added = idToRoadSegment.insert({r->getID(), r}).second;
+        assert(added && "road segment is already in the graph");
+        for (Intersection *n : {r->getSource(), r->getDestination()}) {
+            if (idToIntersection.insert({n->getID(), n}).second) {
+                intersections++;
+                spatialIndex.add(n);
+            }
+        }
+        spatialIndex.add(r);
+        compressedIndex[r->getID()] = roadSegments++;
+        roadSegmentIDs.push_back(r->getID());
+    }
+}
+
 /**
  * Splits a road segment into two parts.
  * @param r the Road Segment to split
@@ -67,18 +115,22 @@ pair<RoadSegment*, RoadSegment*> WeightedDigraph::splitRoadSegment(RoadSegment *
  */
 bool WeightedDigraph::removeRoadSegment(int id) {
     if (idToRoadSegment.count(id) == 0) return false;
+    epoch++;
     RoadSegment *r = idToRoadSegment[id];
     Intersection *source = r->getSource(), *destination = r->getDestination();
+    spatialIndex.remove(r);
     source->remove(r);
     if (source->outdegree() == 0 && source->indegree() == 0) {
         idToIntersection.erase(source->getID());
         intersections--;
+        spatialIndex.remove(source);
         delete source;
     }
     r->getDestination()->remove(r);
     if (destination->outdegree() == 0 && destination->indegree() == 0) {
         idToIntersection.erase(destination->getID());
         intersections--;
+        spatialIndex.remove(destination);
         delete destination;
     }
     idToRoadSegment.erase(id);
@@ -166,3 +218,53 @@ int WeightedDigraph::getCompressedIndex(int id) {
  * Returns the efficiency of the city.
  */
 double WeightedDigraph::getEfficiency() { return Car::getEfficiency(); }
+
+/**
+ * Returns the epoch of the graph, which changes every time a road segment is added or removed.
+ */
+long long WeightedDigraph::getEpoch() const { return epoch; }
+
+/**
+ * Returns the frozen view of the graph, taking a new snapshot if the graph has changed since the last one.
+ * Taking a snapshot assigns the indices of the intersections and road segments, so this must not be called
+ * while other threads are using the view.
+ */
+const GraphView &WeightedDigraph::freeze() {
+    if (view.getEpoch() != epoch) view.build(this, epoch);
+    return view;
+}
+
+/**
+ * Returns true if the frozen view of the graph is up to date, false otherwise.
+ */
+bool WeightedDigraph::isFrozen() const { return view.getEpoch() == epoch; }
+
+/**
+ * Returns the frozen view of the graph, which must be up to date. Safe to call from multiple threads.
+ */
+const GraphView &WeightedDigraph::getView() const {
+    assert(isFrozen() && "the graph has changed since it was frozen");
+    return view;
+}
+
+/**
+ * Returns the spatial index of the intersections and road segments, which is kept up to date as road segments are
+ * added and removed.
+ */
+const SpatialIndex &WeightedDigraph::getSpatialIndex() const { return spatialIndex; }
+
+/**
+ * Returns the router that finds the paths of the cars.
+ */
+Router *WeightedDigraph::getRouter() const { return router; }
+
+/**
+ * Replaces the router that finds the paths of the cars. The graph takes ownership of the router.
+ * @param router the new router (must route in this graph)
+ */
+void WeightedDigraph::setRouter(Router *router) {
+    assert(router != nullptr && router->getGraph() == this && "router must route in this graph");
+    if (router == this->router) return;
+    delete this->router;
+    this->router = router;
+}
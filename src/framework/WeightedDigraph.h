@@ -6,6 +6,8 @@
 #include "Forward.h"
 #include "RoadSegment.h"
 #include "Intersection.h"
+#include "GraphView.h"
+#include "SpatialIndex.h"
 
 struct WeightedDigraph {
 private:
@@ -15,13 +17,19 @@ private:
     std::unordered_map<int, RoadSegment*> idToRoadSegment; // maps the road segment id numbers to the road segment
     std::vector<int> roadSegmentIDs; // compresses the road segment id numbers to a continuous indexed vector
     std::unordered_map<int, int> compressedIndex; // maps the road segment id to its compressed index
+    long long epoch; // incremented every time the structure of the graph changes
+    GraphView view; // the frozen view of the graph, valid if its epoch matches the epoch of the graph
+    SpatialIndex spatialIndex; // finds the intersections and road segments near a location
+    Router *router; // the router that finds the paths of the cars
 
 public:
     WeightedDigraph();
     ~WeightedDigraph();
     int countIntersections() const;
     int countRoadSegments() const;
+    void reserve(int intersections, int roadSegments);
     bool addRoadSegment(RoadSegment *r);
+    void addAdoptedRoadSegments(const std::vector<RoadSegment*> &roads);
     std::pair<RoadSegment*, RoadSegment*> splitRoadSegment(RoadSegment *r, Intersection *n);
     bool removeRoadSegment(int id);
     int outdegree(int id);
@@ -35,6 +43,13 @@ public:
     const std::unordered_map<int, int> &getCompressedIndices() const;
     int getCompressedIndex(int id);
     double getEfficiency();
+    long long getEpoch() const;
+    const GraphView &freeze();
+    bool isFrozen() const;
+    const GraphView &getView() const;
+    const SpatialIndex &getSpatialIndex() const;
+    Router *getRouter() const;
+    void setRouter(Router *router);
 };
 
 #endif
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <assert.h>
 #include <QBrush>
@@ -65,7 +66,9 @@ void GUI::renderImage() {
      ui->imageLabel->setPixmap(QPixmap::fromImage(image));
 }
 /**
- * Draws the Intersections, Road Segments, and Cars to the Window
+ * Draws the Intersections, Road Segments, and Cars to the Window. Only the part of the city that is scrolled into
+ * view is drawn, which is found with the spatial index of the graph, so a large city costs no more to draw than a
+ * small one. The rest of the image is drawn when it is scrolled into view.
  */
 void GUI::drawComponents() {
     char effLabelBuffer[8];
@@ -83,11 +86,24 @@ void GUI::drawComponents() {
     Intersection *intersection;
     RoadSegment *road;
     TrafficLight *light;
-    Car *car;
+
+    // finds what is in view, with enough room around it for the parts drawn outside the roads and intersections
+    double scrollBarX = ui->scrollArea->horizontalScrollBar()->value();
+    double scrollBarY = ui->scrollArea->verticalScrollBar()->value();
+    double margin = LABEL_DIST + max(LABEL_WIDTH, LABEL_HEIGHT);
+    Point2D topLeft(scrollBarX / SCALE_FACTOR - margin, scrollBarY / SCALE_FACTOR - margin);
+    Point2D bottomRight((scrollBarX + ui->scrollArea->viewport()->width()) / SCALE_FACTOR + margin,
+            (scrollBarY + ui->scrollArea->viewport()->height()) / SCALE_FACTOR + margin);
+    visibleIntersections.clear();
+    visibleRoads.clear();
+    graph->getSpatialIndex().findIntersections(topLeft, bottomRight, visibleIntersections);
+    graph->getSpatialIndex().findRoadSegments(topLeft, bottomRight, visibleRoads);
+    for (QLabel *label : shownLabels) label->hide();
+    shownLabels.clear();
 
     // draws circles to represent each intersection
-    for(pair<int, Intersection*> p: graph->getIntersections()) {
-        intersection = p.second;
+    for (Intersection *visible : visibleIntersections) {
+        intersection = visible;
         Point2D tempLoc = intersection->getLocation();
         QPoint location(tempLoc.x * SCALE_FACTOR, tempLoc.y * SCALE_FACTOR);
         painter.setPen(QPen(QColor(COLOR_BLACK.r, COLOR_BLACK.g, COLOR_BLACK.b))); // border colour
@@ -99,15 +115,13 @@ void GUI::drawComponents() {
     string s;
 
     // draws Lines to represent each road
-    for(pair<int, RoadSegment*> p: graph->getRoadSegments()) {
-        road = p.second;
+    for (RoadSegment *visible : visibleRoads) {
+        road = visible;
         Point2D tempSource = road->getSource()->getLocation();
         Point2D tempDest = road->getDestination()->getLocation();
         double angle = tempSource.angleTo(tempDest); // (-PI, PI]
         double labelPosX = LABEL_DIST * cos(angle + PI / 2) + ((tempSource.x + tempDest.x) / 2) - (LABEL_WIDTH / 2);
         double labelPosY = LABEL_DIST * sin(angle + PI / 2) + ((tempSource.y + tempDest.y) / 2) - (LABEL_HEIGHT / 2);
-        double scrollBarX = ui->scrollArea->horizontalScrollBar()->value();
-        double scrollBarY = ui->scrollArea->verticalScrollBar()->value();
         double adjX = (angle >= 0.0 ? -1.0 : 1.0) * ROAD_SEPARATION * abs(sin(angle));
         double adjY = (abs(angle) >= PI / 2 ? -1.0 : 1.0) * ROAD_SEPARATION * abs(cos(angle));
         QPoint source(tempSource.x * SCALE_FACTOR + adjX, tempSource.y * SCALE_FACTOR + adjY);
@@ -125,24 +139,28 @@ void GUI::drawComponents() {
         painter.drawLine(source, destination);
 
         // draws blue dots to represent cars
-        for (pair<int, Car*> c : road->getCars()) {
-            car = c.second;
-            QPoint location(car->getCurrentLocation().x * SCALE_FACTOR + adjX, car->getCurrentLocation().y * SCALE_FACTOR + adjY);
+        const CarStore &cars = road->getCars();
+        for (int i = 0; i < cars.size(); i++) {
+            Point2D carLoc = road->getPointAt(cars.getOffset(i));
+            QPoint location(carLoc.x * SCALE_FACTOR + adjX, carLoc.y * SCALE_FACTOR + adjY);
             painter.setPen(QPen(QColor(COLOR_BLUE.r, COLOR_BLUE.g, COLOR_BLUE.b))); // border colour is changed here
             painter.setBrush(QBrush(QColor(COLOR_BLUE.r, COLOR_BLUE.g, COLOR_BLUE.b))); // fill colour is changed here
             painter.drawEllipse(location, CAR_RADIUS, CAR_RADIUS); // change the constant to change the radius, DO NOT change this value here
         }
-        if (!labels.count(p.first)) labels[p.first] = new QLabel(this);
-        labels[p.first]->setAlignment(Qt::AlignCenter);
+        if (!labels.count(road->getID())) labels[road->getID()] = new QLabel(this);
+        QLabel *label = labels[road->getID()];
+        label->setAlignment(Qt::AlignCenter);
         sprintf(buffer,"%.1f\n%d / %d",road->getSpeedLimit(), road->getFlow(), road->getCapacity());
         s = string(buffer);
-        labels[p.first]->setText(QString::fromStdString(s));
-        labels[p.first]->setGeometry(SCALE_FACTOR * (labelPosX - scrollBarX), SCALE_FACTOR * (labelPosY - scrollBarY), LABEL_WIDTH, LABEL_HEIGHT);
+        label->setText(QString::fromStdString(s));
+        label->setGeometry(SCALE_FACTOR * (labelPosX - scrollBarX), SCALE_FACTOR * (labelPosY - scrollBarY), LABEL_WIDTH, LABEL_HEIGHT);
+        label->show();
+        shownLabels.push_back(label);
         delete pen;
     }
     // draws small coloured dots to represent traffic light
-    for(pair<int, Intersection*> p: graph->getIntersections()) {
-        intersection = p.second;
+    for (Intersection *visible : visibleIntersections) {
+        intersection = visible;
         Point2D tempLoc = intersection->getLocation();
         QPoint location(tempLoc.x * SCALE_FACTOR, tempLoc.y * SCALE_FACTOR);
         for (pair<int, TrafficLight*> t : intersection->getTrafficLights()) {
@@ -2,6 +2,7 @@
 #define GUI_H
 
 #include <unordered_map>
+#include <vector>
 #include <QMainWindow>
 #include <QImage>
 #include <QLabel>
@@ -35,5 +36,8 @@ private:
     QImage image;
     QLabel *efficiencyLabel;
     std::unordered_map<int, QLabel*> labels;
+    std::vector<QLabel*> shownLabels; // the labels of the road segments drawn in the last frame
+    std::vector<Intersection*> visibleIntersections; // the intersections in view, reused every frame
+    std::vector<RoadSegment*> visibleRoads; // the road segments in view, reused every frame
 };
 #endif // GUI_H
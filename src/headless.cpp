@@ -0,0 +1,82 @@
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include "HeadlessDriver.h"
+
+using namespace std;
+
+/**
+ * Prints how to run the program.
+ * @param program the name the program was run with
+ */
+static void usage(const char *program) {
+    fprintf(stderr, "usage: %s <city file | OSM file | grid | random> <seconds> [controller type] [iterations per second] [threads] [tick | event] [dijkstra | astar | alt | ch | cch] [nocache | cache] [noreroute | reroute]\n", program);
+}
+
+/**
+ * Parses a whole argument as a number, returning false if any of it is not part of the number.
+ * @param arg the argument
+ * @param value set to the number
+ */
+static bool parseNumber(const char *arg, double &value) {
+    char *end;
+    value = strtod(arg, &end);
+    return end != arg && *end == '\0';
+}
+
+/**
+ * Parses a whole argument as an integer, returning false if any of it is not part of the integer.
+ * @param arg the argument
+ * @param value set to the integer
+ */
+static bool parseInteger(const char *arg, int &value) {
+    char *end;
+    long v = strtol(arg, &end, 10);
+    value = (int) v;
+    return end != arg && *end == '\0' && v == value;
+}
+
+/**
+ * Runs a simulation without a display. Every argument is checked before the city is loaded, and the usage is
+ * printed if one is not valid.
+ * Usage: traffix-headless <city file | OSM file | grid | random> <seconds> [controller type] [iterations per second] [threads] [tick | event] [dijkstra | astar | alt | ch | cch] [nocache | cache] [noreroute | reroute]
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 3 || argc > 10) {
+        usage(argv[0]);
+        return 1;
+    }
+    string city = argv[1];
+    double seconds;
+    int controllerType = 1;
+    double iterationsPerSecond = 20.0;
+    int threadCount = 1;
+    string mode = argc > 6 ? argv[6] : "tick";
+    string router = argc > 7 ? argv[7] : "dijkstra";
+    string cache = argc > 8 ? argv[8] : "nocache";
+    string reroute = argc > 9 ? argv[9] : "noreroute";
+    bool valid = parseNumber(argv[2], seconds) && seconds >= 0.0;
+    if (argc > 3) valid = valid && parseInteger(argv[3], controllerType) && (controllerType == 0 || controllerType == 1);
+    if (argc > 4) valid = valid && parseNumber(argv[4], iterationsPerSecond) && iterationsPerSecond > 0.0;
+    if (argc > 5) valid = valid && parseInteger(argv[5], threadCount) && threadCount > 0;
+    valid = valid && (mode == "tick" || mode == "event");
+    valid = valid && (router == "dijkstra" || router == "astar" || router == "alt" || router == "ch" || router == "cch");
+    valid = valid && (cache == "nocache" || cache == "cache");
+    valid = valid && (reroute == "noreroute" || reroute == "reroute");
+    if (!valid) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (mode == "event" && reroute == "reroute") {
+        fprintf(stderr, "%s: cars cannot be rerouted in the event simulation\n", argv[0]);
+        usage(argv[0]);
+        return 1;
+    }
+    bool eventDriven = mode == "event";
+    bool cached = cache == "cache";
+    bool rerouting = reroute == "reroute";
+    HeadlessDriver *hd = new HeadlessDriver(city, controllerType, iterationsPerSecond, threadCount, eventDriven, router, cached, rerouting);
+    hd->run(seconds);
+    delete hd;
+    return 0;
+}
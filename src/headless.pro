@@ -0,0 +1,66 @@
+QT       -= core gui
+
+# Builds the headless batch runner, which runs a simulation as fast as possible without a display.
+TARGET = traffix-headless
+TEMPLATE = app
+CONFIG += console c++14
+CONFIG -= app_bundle qt
+LIBS += -pthread
+
+SOURCES += \
+        headless.cpp \
+        HeadlessDriver.cpp \
+        CityGenerator.cpp \
+        GridCityGenerator.cpp \
+        Simulation.cpp \
+        EventSimulation.cpp \
+        controller/Controller.cpp \
+        controller/PretimedController.cpp \
+        controller/BasicController.cpp \
+        misc/CarKernel.cpp \
+        misc/IndexMinPQ.cpp \
+        misc/ThreadPool.cpp \
+        framework/Car.cpp \
+        framework/CarStore.cpp \
+        framework/CarPool.cpp \
+        framework/RouteTable.cpp \
+        framework/DijkstraDirectedSP.cpp \
+        framework/AStarDirectedSP.cpp \
+        framework/Router.cpp \
+        framework/DijkstraRouter.cpp \
+        framework/AStarRouter.cpp \
+        framework/Landmarks.cpp \
+        framework/ALTRouter.cpp \
+        framework/ContractionHierarchy.cpp \
+        framework/ContractionHierarchySP.cpp \
+        framework/ContractionHierarchyRouter.cpp \
+        framework/CustomizableHierarchyRouter.cpp \
+        framework/CachedRouter.cpp \
+        framework/SpawnWave.cpp \
+        framework/RerouteService.cpp \
+        framework/TravelTimeMatrix.cpp \
+        framework/CityFile.cpp \
+        framework/OSMImporter.cpp \
+        framework/Intersection.cpp \
+        framework/GraphView.cpp \
+        framework/SpatialIndex.cpp \
+        framework/Point2D.cpp \
+        framework/RoadSegment.cpp \
+        framework/TrafficLight.cpp \
+        framework/WeightedDigraph.cpp
+
+HEADERS += \
+        HeadlessDriver.h \
+        CityGenerator.h \
+        GridCityGenerator.h \
+        Simulation.h \
+        EventSimulation.h \
+        controller/Controller.h \
+        controller/PretimedController.h \
+        controller/BasicController.h \
+        misc/pair_hash.h \
+        misc/vector_hash.h \
+        misc/CarKernel.h \
+        misc/IndexMinPQ.h \
+        misc/ThreadPool.h \
+        framework/Framework.h
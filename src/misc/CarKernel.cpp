@@ -0,0 +1,164 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "CarKernel.h"
+
+#ifdef CAR_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// the fraction of a step a car can be from a point and still be considered to have reached it
+#define STEP_TOLERANCE 0.51
+
+/**
+ * Returns the number of words in a mask of a number of cars.
+ */
+int getMaskWords(int size) { return (size + MASK_BITS - 1) / MASK_BITS; }
+
+/**
+ * Returns the index of the lowest set bit of a non-zero word.
+ */
+int getLowestBit(uint64_t word) {
+#ifdef __GNUC__
+    return __builtin_ctzll(word);
+#else
+    int i = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+/**
+ * Clears the masks of a batch. The masks of an empty batch have no words and may be null.
+ */
+static void clearMasks(CarBatch &batch) {
+    if (batch.size == 0) return;
+    size_t bytes = getMaskWords(batch.size) * sizeof(uint64_t);
+    memset(batch.reachedDestination, 0, bytes);
+    memset(batch.reachedEnd, 0, bytes);
+    memset(batch.nearTail, 0, bytes);
+}
+
+/**
+ * Returns the offset the cars are compared against for the waiting queue. NaN compares false with everything,
+ * so no car is near the tail when the queue is empty.
+ */
+static double getTail(const CarBatch &batch) {
+    return batch.hasTail ? batch.tail : numeric_limits<double>::quiet_NaN();
+}
+
+/**
+ * Advances the cars in the range [from, size) one at a time and sets their bits in the masks.
+ */
+static void advanceRemaining(CarBatch &batch, int from) {
+    double tail = getTail(batch);
+    for (int i = from; i < batch.size; i++) {
+        double step = batch.timeElapsed * batch.speeds[i];
+        batch.offsets[i] += step;
+        double eps_dist = step * STEP_TOLERANCE; // max distance between frames
+        uint64_t bit = (uint64_t) 1 << (i % MASK_BITS);
+        if (batch.destinations[i] - batch.offsets[i] <= eps_dist) batch.reachedDestination[i / MASK_BITS] |= bit;
+        if (batch.length - batch.offsets[i] <= eps_dist) batch.reachedEnd[i / MASK_BITS] |= bit;
+        if (fabs(tail - batch.offsets[i]) <= eps_dist) batch.nearTail[i / MASK_BITS] |= bit;
+    }
+}
+
+/**
+ * Advances the cars in a batch one at a time.
+ */
+void advanceCarsScalar(CarBatch &batch) {
+    clearMasks(batch);
+    advanceRemaining(batch, 0);
+}
+
+#ifdef CAR_KERNEL_X86
+/**
+ * Advances the cars in a batch two at a time with SSE2 instructions.
+ */
+__attribute__((target("sse2")))
+void advanceCarsSSE2(CarBatch &batch) {
+    clearMasks(batch);
+    __m128d dt = _mm_set1_pd(batch.timeElapsed);
+    __m128d tolerance = _mm_set1_pd(STEP_TOLERANCE);
+    __m128d length = _mm_set1_pd(batch.length);
+    __m128d tail = _mm_set1_pd(getTail(batch));
+    __m128d sign = _mm_set1_pd(-0.0);
+    int i = 0;
+    for (; i + 2 <= batch.size; i += 2) {
+        __m128d step = _mm_mul_pd(dt, _mm_loadu_pd(batch.speeds + i));
+        __m128d offset = _mm_add_pd(_mm_loadu_pd(batch.offsets + i), step);
+        _mm_storeu_pd(batch.offsets + i, offset);
+        __m128d eps = _mm_mul_pd(step, tolerance);
+        __m128d toDestination = _mm_sub_pd(_mm_loadu_pd(batch.destinations + i), offset);
+        __m128d toTail = _mm_andnot_pd(sign, _mm_sub_pd(tail, offset));
+        int shift = i % MASK_BITS;
+        batch.reachedDestination[i / MASK_BITS] |= (uint64_t) _mm_movemask_pd(_mm_cmple_pd(toDestination, eps)) << shift;
+        batch.reachedEnd[i / MASK_BITS] |= (uint64_t) _mm_movemask_pd(_mm_cmple_pd(_mm_sub_pd(length, offset), eps)) << shift;
+        batch.nearTail[i / MASK_BITS] |= (uint64_t) _mm_movemask_pd(_mm_cmple_pd(toTail, eps)) << shift;
+    }
+    advanceRemaining(batch, i);
+}
+
+/**
+ * Advances the cars in a batch four at a time with AVX instructions.
+ */
+__attribute__((target("avx")))
+void advanceCarsAVX(CarBatch &batch) {
+    clearMasks(batch);
+    __m256d dt = _mm256_set1_pd(batch.timeElapsed);
+    __m256d tolerance = _mm256_set1_pd(STEP_TOLERANCE);
+    __m256d length = _mm256_set1_pd(batch.length);
+    __m256d tail = _mm256_set1_pd(getTail(batch));
+    __m256d sign = _mm256_set1_pd(-0.0);
+    int i = 0;
+    for (; i + 4 <= batch.size; i += 4) {
+        __m256d step = _mm256_mul_pd(dt, _mm256_loadu_pd(batch.speeds + i));
+        __m256d offset = _mm256_add_pd(_mm256_loadu_pd(batch.offsets + i), step);
+        _mm256_storeu_pd(batch.offsets + i, offset);
+        __m256d eps = _mm256_mul_pd(step, tolerance);
+        __m256d toDestination = _mm256_sub_pd(_mm256_loadu_pd(batch.destinations + i), offset);
+        __m256d toTail = _mm256_andnot_pd(sign, _mm256_sub_pd(tail, offset));
+        int shift = i % MASK_BITS;
+        batch.reachedDestination[i / MASK_BITS] |= (uint64_t) _mm256_movemask_pd(_mm256_cmp_pd(toDestination, eps, _CMP_LE_OQ)) << shift;
+        batch.reachedEnd[i / MASK_BITS] |= (uint64_t) _mm256_movemask_pd(_mm256_cmp_pd(_mm256_sub_pd(length, offset), eps, _CMP_LE_OQ)) << shift;
+        batch.nearTail[i / MASK_BITS] |= (uint64_t) _mm256_movemask_pd(_mm256_cmp_pd(toTail, eps, _CMP_LE_OQ)) << shift;
+    }
+    _mm256_zeroupper();
+    advanceRemaining(batch, i);
+}
+#endif
+
+/**
+ * Returns the fastest kernel supported by the processor. All kernels produce exactly the same results.
+ */
+CarKernel getCarKernel() {
+#ifdef CAR_KERNEL_X86
+    static CarKernel kernel = __builtin_cpu_supports("avx") ? advanceCarsAVX
+            : __builtin_cpu_supports("sse2") ? advanceCarsSSE2 : advanceCarsScalar;
+    return kernel;
+#else
+    return advanceCarsScalar;
+#endif
+}
+
+/**
+ * Returns the name of the kernel returned by getCarKernel().
+ */
+const char *getCarKernelName() {
+    CarKernel kernel = getCarKernel();
+#ifdef CAR_KERNEL_X86
+    if (kernel == advanceCarsAVX) return "avx";
+    if (kernel == advanceCarsSSE2) return "sse2";
+#endif
+    return "scalar";
+}
+
+/**
+ * Advances the cars in a batch with the fastest kernel supported by the processor.
+ */
+void advanceCars(CarBatch &batch) { getCarKernel()(batch); }
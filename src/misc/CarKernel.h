@@ -0,0 +1,44 @@
+#ifndef CARKERNEL_H_
+#define CARKERNEL_H_
+
+#include <cstdint>
+
+// the vector kernels are only built for x86 compilers that can target instruction sets per function
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CAR_KERNEL_X86
+#endif
+
+#define MASK_BITS 64 // the number of cars in each word of a mask
+
+/**
+ * The cars on a road to be advanced by a kernel, and the masks the kernel fills in. Bit i % MASK_BITS of word
+ * i / MASK_BITS in a mask is set if the condition holds for car i after it has moved.
+ */
+struct CarBatch {
+    double *offsets; // the distance of each car from the source of the road, advanced by the kernel
+    const double *speeds; // the speed of each car
+    const double *destinations; // the offset of the destination of each car, infinity if it is not on this road
+    int size; // the number of cars
+    double timeElapsed; // the time elapsed since the last iteration
+    double length; // the length of the road
+    double tail; // the offset of the last car in the waiting queue
+    bool hasTail; // true if there are cars in the waiting queue
+    uint64_t *reachedDestination; // the cars within a step of their destination
+    uint64_t *reachedEnd; // the cars within a step of the end of the road
+    uint64_t *nearTail; // the cars within a step of the last car in the waiting queue, which may have to stop
+};
+
+typedef void (*CarKernel)(CarBatch &batch);
+
+int getMaskWords(int size);
+int getLowestBit(uint64_t word);
+void advanceCarsScalar(CarBatch &batch);
+#ifdef CAR_KERNEL_X86
+void advanceCarsSSE2(CarBatch &batch);
+void advanceCarsAVX(CarBatch &batch);
+#endif
+CarKernel getCarKernel();
+const char *getCarKernelName();
+void advanceCars(CarBatch &batch);
+
+#endif
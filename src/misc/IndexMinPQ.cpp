@@ -0,0 +1,169 @@
+#include <assert.h>
+#include "IndexMinPQ.h"
+
+using namespace std;
+
+/**
+ * Initializes an empty heap with no capacity.
+ */
+IndexMinPQ::IndexMinPQ() {}
+
+/**
+ * Deconstructs the heap.
+ */
+IndexMinPQ::~IndexMinPQ() {}
+
+/**
+ * Puts an item at a position in the heap.
+ */
+void IndexMinPQ::place(int i, int item) {
+    heap[i] = item;
+    position[item] = i;
+}
+
+/**
+ * Moves the item at a position up the heap until its parent has a smaller or equal key.
+ */
+void IndexMinPQ::swim(int i) {
+    int item = heap[i];
+    double key = keys[item];
+    while (i > 0) {
+        int parent = (i - 1) / HEAP_ARITY;
+        if (keys[heap[parent]] <= key) break;
+        place(i, heap[parent]);
+        i = parent;
+    }
+    place(i, item);
+}
+
+/**
+ * Moves the item at a position down the heap until all of its children have larger or equal keys.
+ */
+void IndexMinPQ::sink(int i) {
+    int item = heap[i];
+    double key = keys[item];
+    int n = heap.size();
+    while (true) {
+        int first = i * HEAP_ARITY + 1;
+        if (first >= n) break;
+        int last = first + HEAP_ARITY < n ? first + HEAP_ARITY : n;
+        int best = first;
+        for (int c = first + 1; c < last; c++) {
+            if (keys[heap[c]] < keys[heap[best]]) best = c;
+        }
+        if (keys[heap[best]] >= key) break;
+        place(i, heap[best]);
+        i = best;
+    }
+    place(i, item);
+}
+
+/**
+ * Makes sure the heap can hold the items in the range [0, capacity). The heap must be empty.
+ * @param capacity the number of items
+ */
+void IndexMinPQ::reserve(int capacity) {
+    assert(heap.empty() && "the heap must be empty to change its capacity");
+    if (capacity > (int) position.size()) {
+        position.resize(capacity, -1);
+        keys.resize(capacity);
+    }
+}
+
+/**
+ * Returns the number of items the heap can hold.
+ */
+int IndexMinPQ::capacity() const { return position.size(); }
+
+/**
+ * Returns the number of items in the heap.
+ */
+int IndexMinPQ::size() const { return heap.size(); }
+
+/**
+ * Returns true if the heap is empty, false otherwise.
+ */
+bool IndexMinPQ::isEmpty() const { return heap.empty(); }
+
+/**
+ * Returns true if an item is in the heap, false otherwise.
+ */
+bool IndexMinPQ::contains(int item) const { return position[item] != -1; }
+
+/**
+ * Adds an item to the heap.
+ * @param item the item (must not be in the heap)
+ * @param key the key of the item
+ */
+void IndexMinPQ::push(int item, double key) {
+    assert(item >= 0 && item < capacity() && "item is out of range");
+    assert(!contains(item) && "item is already in the heap");
+    keys[item] = key;
+    heap.push_back(item);
+    swim(heap.size() - 1);
+}
+
+/**
+ * Decreases the key of an item in the heap.
+ * @param item the item (must be in the heap)
+ * @param key the new key of the item (must not be larger than the current key)
+ */
+void IndexMinPQ::decreaseKey(int item, double key) {
+    assert(contains(item) && "item is not in the heap");
+    assert(key <= keys[item] && "key must not increase");
+    keys[item] = key;
+    swim(position[item]);
+}
+
+/**
+ * Changes the key of an item in the heap, which may increase or decrease it.
+ * @param item the item
+ * @param key the new key of the item
+ */
+void IndexMinPQ::changeKey(int item, double key) {
+    assert(contains(item) && "item is not in the heap");
+    bool increased = key > keys[item];
+    keys[item] = key;
+    if (increased) sink(position[item]);
+    else swim(position[item]);
+}
+
+/**
+ * Returns the item with the smallest key.
+ */
+int IndexMinPQ::top() const {
+    assert(!heap.empty() && "the heap is empty");
+    return heap[0];
+}
+
+/**
+ * Returns the smallest key in the heap.
+ */
+double IndexMinPQ::topKey() const {
+    assert(!heap.empty() && "the heap is empty");
+    return keys[heap[0]];
+}
+
+/**
+ * Removes and returns the item with the smallest key.
+ */
+int IndexMinPQ::pop() {
+    assert(!heap.empty() && "the heap is empty");
+    int item = heap[0];
+    position[item] = -1;
+    int last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        heap[0] = last;
+        sink(0);
+    }
+    return item;
+}
+
+/**
+ * Removes every item from the heap. Only the items still in the heap are touched.
+ */
+void IndexMinPQ::clear() {
+    for (int item : heap) position[item] = -1;
+    heap.clear();
+}
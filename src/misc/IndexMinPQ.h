@@ -0,0 +1,40 @@
+#ifndef INDEXMINPQ_H_
+#define INDEXMINPQ_H_
+
+#include <vector>
+
+#define HEAP_ARITY 4 // the number of children of each node in the heap
+
+/**
+ * A d-ary min heap of integer items in the range [0, capacity()) keyed by a double, supporting decrease-key.
+ * A 4-ary heap is shallower than a binary heap and its children share cache lines, which makes it faster for
+ * shortest path searches. The memory is kept between uses, and clearing only touches the items still in the heap.
+ */
+struct IndexMinPQ {
+private:
+    std::vector<int> heap; // the items in heap order
+    std::vector<int> position; // the position of each item in the heap, -1 if it is not in the heap
+    std::vector<double> keys; // the key of each item in the heap
+
+    void swim(int i);
+    void sink(int i);
+    void place(int i, int item);
+
+public:
+    IndexMinPQ();
+    ~IndexMinPQ();
+    void reserve(int capacity);
+    int capacity() const;
+    int size() const;
+    bool isEmpty() const;
+    bool contains(int item) const;
+    void push(int item, double key);
+    void decreaseKey(int item, double key);
+    void changeKey(int item, double key);
+    int top() const;
+    double topKey() const;
+    int pop();
+    void clear();
+};
+
+#endif
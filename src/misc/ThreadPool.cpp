@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <assert.h>
+#include "ThreadPool.h"
+
+using namespace std;
+
+/**
+ * Initializes a thread pool.
+ * @param threadCount the total number of threads that will run a job, including the calling thread (must be positive)
+ */
+ThreadPool::ThreadPool(int threadCount) : nextIndex(0) {
+    assert(threadCount > 0 && "threadCount must be a positive value");
+    job = nullptr;
+    jobSize = 0;
+    generation = 0;
+    busy = 0;
+    stopping = false;
+    for (int i = 1; i < threadCount; i++) {
+        workers.push_back(thread(&ThreadPool::work, this));
+    }
+}
+
+/**
+ * Deconstructs the thread pool and joins all the worker threads.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(mtx);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (thread &t : workers) t.join();
+}
+
+/**
+ * Returns the total number of threads that run a job, including the calling thread.
+ */
+int ThreadPool::size() const { return (int) workers.size() + 1; }
+
+/**
+ * Claims chunks of the current job and runs them until every index has been claimed.
+ */
+void ThreadPool::runChunks() {
+    while (true) {
+        int start = nextIndex.fetch_add(PARALLEL_CHUNK_SIZE);
+        if (start >= jobSize) return;
+        int end = min(jobSize, start + PARALLEL_CHUNK_SIZE);
+        for (int i = start; i < end; i++) (*job)(i);
+    }
+}
+
+/**
+ * The loop run by every worker thread.
+ */
+void ThreadPool::work() {
+    int seen = 0;
+    while (true) {
+        {
+            unique_lock<mutex> lock(mtx);
+            jobReady.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runChunks();
+        {
+            lock_guard<mutex> lock(mtx);
+            busy--;
+        }
+        jobDone.notify_one();
+    }
+}
+
+/**
+ * Calls f(i) for every 0 <= i < n and returns once all the calls have finished.
+ * The calls may run concurrently and in any order, so f must only write to state owned by index i.
+ * @param n the number of indices
+ * @param f the function to run for each index
+ */
+void ThreadPool::parallelFor(int n, const function<void(int)> &f) {
+    if (n <= 0) return;
+    if (workers.empty() || n <= PARALLEL_CHUNK_SIZE) {
+        for (int i = 0; i < n; i++) f(i);
+        return;
+    }
+    {
+        lock_guard<mutex> lock(mtx);
+        job = &f;
+        jobSize = n;
+        nextIndex = 0;
+        busy = (int) workers.size();
+        generation++;
+    }
+    jobReady.notify_all();
+    runChunks();
+    unique_lock<mutex> lock(mtx);
+    jobDone.wait(lock, [&] { return busy == 0; });
+    job = nullptr;
+}
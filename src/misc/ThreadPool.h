@@ -0,0 +1,40 @@
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define PARALLEL_CHUNK_SIZE 16
+
+/**
+ * A fixed size pool of worker threads that executes index ranges in parallel.
+ * The calling thread also takes part in the work, so a pool of size 1 runs everything serially.
+ */
+struct ThreadPool {
+private:
+    std::vector<std::thread> workers; // the worker threads (the calling thread is not included)
+    std::mutex mtx; // guards the job state below
+    std::condition_variable jobReady; // signalled when a new job is posted or the pool is stopping
+    std::condition_variable jobDone; // signalled when a worker finishes its part of a job
+    const std::function<void(int)> *job; // the function being executed for each index
+    int jobSize; // the number of indices in the current job
+    int generation; // incremented every time a new job is posted
+    int busy; // the number of workers still running the current job
+    bool stopping; // true when the pool is being destroyed
+    std::atomic<int> nextIndex; // the next index that has not yet been claimed by a thread
+
+    void work();
+    void runChunks();
+
+public:
+    ThreadPool(int threadCount);
+    ~ThreadPool();
+    int size() const;
+    void parallelFor(int n, const std::function<void(int)> &f);
+};
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef VECTOR_HASH_H
+#define VECTOR_HASH_H
+
+#include <cstddef> // for size_t
+#include <vector> // for vector
+#include <functional> // for hash
+
+template<typename T> struct vector_hash {
+    size_t operator ()(const std::vector<T> &v) const {
+        size_t h = v.size();
+        for (const T &x : v) h = 31 * h + std::hash<T> {}(x);
+        return h;
+    }
+};
+
+#endif
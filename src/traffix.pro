@@ -25,13 +25,38 @@ SOURCES += \
         ConsoleDriver.cpp \
         GUIDriver.cpp \
         Simulation.cpp \
+        EventSimulation.cpp \
         controller/Controller.cpp \
         controller/PretimedController.cpp \
         controller/BasicController.cpp \
         gui/gui.cpp \
+        misc/CarKernel.cpp \
+        misc/IndexMinPQ.cpp \
+        misc/ThreadPool.cpp \
         framework/Car.cpp \
+        framework/CarStore.cpp \
+        framework/CarPool.cpp \
+        framework/RouteTable.cpp \
         framework/DijkstraDirectedSP.cpp \
+        framework/AStarDirectedSP.cpp \
+        framework/Router.cpp \
+        framework/DijkstraRouter.cpp \
+        framework/AStarRouter.cpp \
+        framework/Landmarks.cpp \
+        framework/ALTRouter.cpp \
+        framework/ContractionHierarchy.cpp \
+        framework/ContractionHierarchySP.cpp \
+        framework/ContractionHierarchyRouter.cpp \
+        framework/CustomizableHierarchyRouter.cpp \
+        framework/CachedRouter.cpp \
+        framework/SpawnWave.cpp \
+        framework/RerouteService.cpp \
+        framework/TravelTimeMatrix.cpp \
+        framework/CityFile.cpp \
+        framework/OSMImporter.cpp \
         framework/Intersection.cpp \
+        framework/GraphView.cpp \
+        framework/SpatialIndex.cpp \
         framework/Point2D.cpp \
         framework/RoadSegment.cpp \
         framework/TrafficLight.cpp \
@@ -43,11 +68,16 @@ HEADERS += \
         ConsoleDriver.h \
         GUIDriver.h \
         Simulation.h \
+        EventSimulation.h \
         gui/gui.h \
         controller/Controller.h \
         controller/PretimedController.h \
         controller/BasicController.h \
         misc/pair_hash.h \
+        misc/vector_hash.h \
+        misc/CarKernel.h \
+        misc/IndexMinPQ.h \
+        misc/ThreadPool.h \
         framework/Framework.h
 
 FORMS += \